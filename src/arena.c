@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2020 trinity-tech
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <crystal.h>
+
+#include "arena.h"
+
+#define ARENA_ALIGN 16
+
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t cap;
+    size_t used;
+} ArenaBlock;
+
+struct Arena {
+    ArenaBlock *head;  // the block being filled, followed by the full ones
+    size_t block_len;
+};
+
+#define BLOCK_HDR_LEN     ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+#define block_data(block) ((char *)(block) + BLOCK_HDR_LEN)
+
+static
+void arena_dtor(void *obj)
+{
+    Arena *arena = (Arena *)obj;
+    ArenaBlock *block;
+
+    while ((block = arena->head)) {
+        arena->head = block->next;
+        free(block);
+    }
+}
+
+Arena *arena_create(size_t block_len)
+{
+    Arena *arena = rc_zalloc(sizeof(Arena), arena_dtor);
+    if (!arena)
+        return NULL;
+
+    arena->block_len = block_len ? block_len : ARENA_BLOCK_LEN;
+
+    return arena;
+}
+
+static
+ArenaBlock *block_create(size_t cap)
+{
+    ArenaBlock *block = calloc(1, BLOCK_HDR_LEN + cap);
+    if (!block)
+        return NULL;
+
+    block->cap = cap;
+
+    return block;
+}
+
+void *arena_alloc(Arena *arena, size_t sz)
+{
+    ArenaBlock *block = arena->head;
+    void *ptr;
+
+    sz = (sz + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+    if (block && block->cap - block->used >= sz) {
+        ptr = block_data(block) + block->used;
+        block->used += sz;
+        return ptr;
+    }
+
+    if (sz > arena->block_len / 4) {
+        // keep filling the current block, the large one goes behind it.
+        block = block_create(sz);
+        if (!block)
+            return NULL;
+
+        block->used = sz;
+        if (arena->head) {
+            block->next = arena->head->next;
+            arena->head->next = block;
+        } else
+            arena->head = block;
+
+        return block_data(block);
+    }
+
+    block = block_create(arena->block_len);
+    if (!block)
+        return NULL;
+
+    block->next = arena->head;
+    block->used = sz;
+    arena->head = block;
+
+    return block_data(block);
+}
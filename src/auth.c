@@ -59,6 +59,18 @@ extern Carrier *carrier;
 
 static linked_hashtable_t *pending_logins;
 
+/*
+ * Access token validated last in the token scope of the calling thread,
+ * so that the sub-requests of a batch verify their shared token once.
+ */
+typedef struct {
+    bool open;
+    char *token_marshal;
+    UserInfo *uinfo;
+} TokenScope;
+
+static _Thread_local TokenScope token_scope;
+
 static inline
 Login *pending_login_put(Login *login)
 {
@@ -501,13 +513,16 @@ void hdl_signin_conf_chal_req(Carrier *c, const char *from, Req *base)
             goto finally;
         }
 
-        if (!strcmp(uinfo->did, feeds_owner_info.did) && (oinfo_upd(uinfo) < 0)) {
-            ErrResp resp = {
-                .tsx_id = req->tsx_id,
-                .ec     = ERR_INTERNAL_ERROR
-            };
-            resp_marshal = rpc_marshal_err_resp(&resp);
-            goto finally;
+        if (!strcmp(uinfo->did, feeds_owner_info.did)) {
+            if (oinfo_upd(uinfo) < 0) {
+                ErrResp resp = {
+                    .tsx_id = req->tsx_id,
+                    .ec     = ERR_INTERNAL_ERROR
+                };
+                resp_marshal = rpc_marshal_err_resp(&resp);
+                goto finally;
+            }
+            feeds_owner_info_changed();
         }
 
         rc = db_upsert_user(uinfo, &uinfo->uid);
@@ -632,11 +647,55 @@ finally:
     return valid;
 }
 
+static
+void token_scope_reset()
+{
+    if (token_scope.token_marshal) {
+        free(token_scope.token_marshal);
+        token_scope.token_marshal = NULL;
+    }
+
+    if (token_scope.uinfo) {
+        deref(token_scope.uinfo);
+        token_scope.uinfo = NULL;
+    }
+}
+
+static
+void token_scope_put(const char *token_marshal, UserInfo *uinfo)
+{
+    char *dup;
+
+    dup = strdup(token_marshal);
+    if (!dup)
+        return;
+
+    token_scope_reset();
+    token_scope.token_marshal = dup;
+    token_scope.uinfo = ref(uinfo);
+}
+
+void auth_token_scope_begin()
+{
+    token_scope_reset();
+    token_scope.open = true;
+}
+
+void auth_token_scope_end()
+{
+    token_scope_reset();
+    token_scope.open = false;
+}
+
 UserInfo *create_uinfo_from_access_token(const char *token_marshal)
 {
     AccessTokenUserInfo *uinfo = NULL;
     JWT *token = NULL;
 
+    if (token_scope.open && token_scope.uinfo && token_marshal &&
+        !strcmp(token_scope.token_marshal, token_marshal))
+        return ref(token_scope.uinfo);
+
     token = DefaultJWSParser_Parse(token_marshal);
     if (!token) {
         vlogE(TAG_AUTH "Parsing access token failed: %s", DIDError_GetLastErrorMessage());
@@ -663,6 +722,9 @@ UserInfo *create_uinfo_from_access_token(const char *token_marshal)
 
     token = NULL;
 
+    if (token_scope.open)
+        token_scope_put(token_marshal, &uinfo->info);
+
 finally:
     if (token)
         JWT_Destroy(token);
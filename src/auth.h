@@ -34,6 +34,13 @@ void auth_deinit();
 void hdl_signin_req_chal_req(Carrier *c, const char *from, Req *base);
 void hdl_signin_conf_chal_req(Carrier *c, const char *from, Req *base);
 UserInfo *create_uinfo_from_access_token(const char *token_marshal);
+
+/*
+ * Between begin and end, create_uinfo_from_access_token() on the calling
+ * thread validates a token once and hands out the same UserInfo for it.
+ */
+void auth_token_scope_begin();
+void auth_token_scope_end();
 void auth_expire_login();
 
 #endif // __AUTH_H__
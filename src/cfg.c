@@ -99,6 +99,29 @@ static void qualified_path(const char *path, const char *ref, char *qualified)
     }
 }
 
+static void load_rate_limit(config_t *cfg, const char *path,
+                            RateLimitConfig *rl, int def_rate, int def_burst)
+{
+    config_setting_t *setting;
+    int intopt;
+
+    rl->rate  = def_rate;
+    rl->burst = def_burst;
+
+    setting = config_lookup(cfg, path);
+    if (!setting)
+        return;
+
+    if (config_setting_lookup_int(setting, "rate", &intopt) && intopt >= 0)
+        rl->rate = intopt;
+
+    if (config_setting_lookup_int(setting, "burst", &intopt) && intopt > 0)
+        rl->burst = intopt;
+
+    if (rl->burst < rl->rate)
+        rl->burst = rl->rate;
+}
+
 #define DEFAULT_LOG_LEVEL CarrierLogLevel_Info
 #define DEFAULT_DATA_DIR  "/var/lib/feedsd"
 FeedsConfig *load_cfg(const char *cfg_file, FeedsConfig *fc, const char *data_path)
@@ -290,6 +313,10 @@ FeedsConfig *load_cfg(const char *cfg_file, FeedsConfig *fc, const char *data_pa
     sprintf(number, "%d", intopt);
     fc->http_port = strdup(number);
 
+    load_rate_limit(&cfg, "rate-limit.auth", &fc->rate_limits[RATE_LIMIT_AUTH], 2, 10);
+    load_rate_limit(&cfg, "rate-limit.read", &fc->rate_limits[RATE_LIMIT_READ], 20, 60);
+    load_rate_limit(&cfg, "rate-limit.write", &fc->rate_limits[RATE_LIMIT_WRITE], 5, 20);
+
     config_destroy(&cfg);
     return fc;
 }
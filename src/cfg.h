@@ -26,6 +26,18 @@
 #include <carrier.h>
 #include <ela_did.h>
 
+typedef enum {
+    RATE_LIMIT_AUTH,
+    RATE_LIMIT_READ,
+    RATE_LIMIT_WRITE,
+    RATE_LIMIT_CLASSES
+} RateLimitClass;
+
+typedef struct {
+    int rate;   // requests per second refilled into the bucket, 0 means unlimited.
+    int burst;  // bucket capacity.
+} RateLimitConfig;
+
 typedef struct {
     CarrierOptions carrier_opts;
     char *data_dir;
@@ -36,6 +48,7 @@ typedef struct {
     char *didstore_passwd;
     char *http_ip;
     char *http_port;
+    RateLimitConfig rate_limits[RATE_LIMIT_CLASSES];
 } FeedsConfig;
 
 const char *get_cfg_file(const char *config_file, const char *default_config_files[]);
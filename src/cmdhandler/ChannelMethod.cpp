@@ -23,10 +23,10 @@ namespace trinity {
 ChannelMethod::ChannelMethod()
 {
     using namespace std::placeholders;
-    std::map<const char*, AdvancedHandler> advancedHandlerMap {
-        {Rpc::Factory::Method::GetMultiComments,  {std::bind(&ChannelMethod::onGetMultiComments, this, _1, _2), Accessible::Member}},
-        {Rpc::Factory::Method::GetMultiLikesAndCommentsCount,  {std::bind(&ChannelMethod::onGetMultiLikesAndCommentsCount, this, _1, _2), Accessible::Member}},
-        {Rpc::Factory::Method::GetMultiSubscribersCount,  {std::bind(&ChannelMethod::onGetMultiSubscribersCount, this, _1, _2), Accessible::Member}},
+    std::map<RpcMethod, AdvancedHandler> advancedHandlerMap {
+        {RPC_METHOD_GET_MULTI_CMTS,  {std::bind(&ChannelMethod::onGetMultiComments, this, _1, _2), Accessible::Member}},
+        {RPC_METHOD_GET_MULTI_LAC_COUNT,  {std::bind(&ChannelMethod::onGetMultiLikesAndCommentsCount, this, _1, _2), Accessible::Member}},
+        {RPC_METHOD_GET_MULTI_SUBS_COUNT,  {std::bind(&ChannelMethod::onGetMultiSubscribersCount, this, _1, _2), Accessible::Member}},
     };
 
     setHandleMap({}, advancedHandlerMap);
@@ -86,7 +86,7 @@ int ChannelMethod::onGetMultiComments(std::shared_ptr<Rpc::Request> request,
     sql << ";";
 
     auto makeResponse = [&]() -> std::shared_ptr<Rpc::GetMultiCommentsResponse> {
-        auto responsePtr = Rpc::Factory::MakeResponse(request->method);
+        auto responsePtr = Rpc::Factory::MakeResponse(request->methodId);
         auto response = std::dynamic_pointer_cast<Rpc::GetMultiCommentsResponse>(responsePtr);
         if(response != nullptr) {
             response->version = request->version;
@@ -96,7 +96,7 @@ int ChannelMethod::onGetMultiComments(std::shared_ptr<Rpc::Request> request,
     };
 
     std::shared_ptr<Rpc::GetMultiCommentsResponse> response;
-    auto commentsSize = sizeof(Rpc::GetMultiCommentsResponse);
+    Rpc::Chunker chunker(MSGQ_FRAME_LEN);
     DataBase::Step step = [&](SQLite::Statement& stmt) -> int {
         Rpc::GetMultiCommentsResponse::Result::Comment comment;
         comment.channel_id = stmt.getColumn(0).getInt64();
@@ -120,24 +120,15 @@ int ChannelMethod::onGetMultiComments(std::shared_ptr<Rpc::Request> request,
             (uint8_t*)stmt.getColumn(13).getBlob() + stmt.getColumn(13).getBytes()
         });
 
-        commentsSize += sizeof(comment)
-                     - sizeof(comment.user_did) + comment.user_did.length()
-                     - sizeof(comment.user_name) + comment.user_name.length()
-                     - sizeof(comment.content) + comment.content.size()
-                     - sizeof(comment.hash_id) + comment.hash_id.length()  //2.0
-                     - sizeof(comment.proof) + comment.proof.length()  //2.0
-                     - sizeof(comment.thumbnails) + comment.thumbnails.size();  //2.0
-
+        if(chunker.fits(comment) == false) {
+            responseArray.push_back(response);
+            response.reset();
+        }
         if(response == nullptr) {
             response = makeResponse();
             CHECK_ASSERT(response != nullptr, ErrCode::RpcUnimplementedError);
         }
         response->result.comments.push_back(std::move(comment));
-        if(commentsSize >= Rpc::Factory::MaxAvailableSize) {
-            responseArray.push_back(response);
-            response.reset();
-            commentsSize = sizeof(Rpc::GetMultiCommentsResponse);
-        }
 
         return 0;
     };
@@ -199,7 +190,7 @@ int ChannelMethod::onGetMultiLikesAndCommentsCount(std::shared_ptr<Rpc::Request>
     sql << ";";
 
     auto makeResponse = [&]() -> std::shared_ptr<Rpc::GetMultiLikesAndCommentsCountResponse> {
-        auto responsePtr = Rpc::Factory::MakeResponse(request->method);
+        auto responsePtr = Rpc::Factory::MakeResponse(request->methodId);
         auto response = std::dynamic_pointer_cast<Rpc::GetMultiLikesAndCommentsCountResponse>(responsePtr);
         if(response != nullptr) {
             response->version = request->version;
@@ -209,7 +200,7 @@ int ChannelMethod::onGetMultiLikesAndCommentsCount(std::shared_ptr<Rpc::Request>
     };
 
     std::shared_ptr<Rpc::GetMultiLikesAndCommentsCountResponse> response;
-    auto postsSize = sizeof(Rpc::GetMultiLikesAndCommentsCountResponse);
+    Rpc::Chunker chunker(MSGQ_FRAME_LEN);
     DataBase::Step step = [&](SQLite::Statement& stmt) -> int {
         Rpc::GetMultiLikesAndCommentsCountResponse::Result::Post post;
         post.channel_id = stmt.getColumn(0).getInt64();
@@ -217,18 +208,15 @@ int ChannelMethod::onGetMultiLikesAndCommentsCount(std::shared_ptr<Rpc::Request>
         post.comments_count = stmt.getColumn(2).getInt64();
         post.likes_count = stmt.getColumn(3).getInt64();
 
-        postsSize += sizeof(post);
-
+        if(chunker.fits(post) == false) {
+            responseArray.push_back(response);
+            response.reset();
+        }
         if(response == nullptr) {
             response = makeResponse();
             CHECK_ASSERT(response != nullptr, ErrCode::RpcUnimplementedError);
         }
         response->result.posts.push_back(std::move(post));
-        if(postsSize >= Rpc::Factory::MaxAvailableSize) {
-            responseArray.push_back(response);
-            response.reset();
-            postsSize = sizeof(Rpc::GetMultiLikesAndCommentsCountResponse);
-        }
 
         return 0;
     };
@@ -272,7 +260,7 @@ int ChannelMethod::onGetMultiSubscribersCount(std::shared_ptr<Rpc::Request> requ
     sql << ";";
 
     auto makeResponse = [&]() -> std::shared_ptr<Rpc::GetMultiSubscribersCountResponse> {
-        auto responsePtr = Rpc::Factory::MakeResponse(request->method);
+        auto responsePtr = Rpc::Factory::MakeResponse(request->methodId);
         auto response = std::dynamic_pointer_cast<Rpc::GetMultiSubscribersCountResponse>(responsePtr);
         if(response != nullptr) {
             response->version = request->version;
@@ -282,24 +270,21 @@ int ChannelMethod::onGetMultiSubscribersCount(std::shared_ptr<Rpc::Request> requ
     };
 
     std::shared_ptr<Rpc::GetMultiSubscribersCountResponse> response;
-    auto channelsSize = sizeof(Rpc::GetMultiSubscribersCountResponse);
+    Rpc::Chunker chunker(MSGQ_FRAME_LEN);
     DataBase::Step step = [&](SQLite::Statement& stmt) -> int {
         Rpc::GetMultiSubscribersCountResponse::Result::Channel channel;
         channel.channel_id = stmt.getColumn(0).getInt64();
         channel.subscribers_count = stmt.getColumn(1).getInt64();
 
-        channelsSize += sizeof(channel);
-
+        if(chunker.fits(channel) == false) {
+            responseArray.push_back(response);
+            response.reset();
+        }
         if(response == nullptr) {
             response = makeResponse();
             CHECK_ASSERT(response != nullptr, ErrCode::RpcUnimplementedError);
         }
         response->result.channels.push_back(std::move(channel));
-        if(channelsSize >= Rpc::Factory::MaxAvailableSize) {
-            responseArray.push_back(response);
-            response.reset();
-            channelsSize = sizeof(Rpc::GetMultiSubscribersCountResponse);
-        }
 
         return 0;
     };
@@ -13,6 +13,7 @@ extern "C" {
 #define new fix_cpp_keyword_new
 #include <auth.h>
 #include <did.h>
+#include <err.h>
 #undef new
 }
 
@@ -21,6 +22,7 @@ namespace trinity {
 /* =========================================== */
 /* === static variables initialize =========== */
 /* =========================================== */
+constexpr size_t CommandHandler::BatchMaxRequests;
 std::shared_ptr<CommandHandler> CommandHandler::CmdHandlerInstance;
 std::filesystem::path CommandHandler::Listener::DataDir;
 
@@ -53,16 +55,44 @@ void CommandHandler::PrintCarrierError(const std::string& errReason)
                      errReason.c_str(), errStr, errCode);
 }
 
+void CommandHandler::PeekRequest(const msgpack::object& mpRoot,
+                                 RpcMethod& method, uint64_t& tsxId, bool& hasTsxId)
+{
+    method = RPC_METHOD_UNKNOWN;
+    tsxId = 0;
+    hasTsxId = false;
+
+    if(mpRoot.type != msgpack::type::MAP) {
+        return;
+    }
+    for(uint32_t idx = 0; idx < mpRoot.via.map.size; idx++) {
+        const auto& kv = mpRoot.via.map.ptr[idx];
+        if(kv.key.type != msgpack::type::STR) {
+            continue;
+        }
+        std::string key(kv.key.via.str.ptr, kv.key.via.str.size);
+        if(key == "method" && kv.val.type == msgpack::type::STR) {
+            method = Rpc::MethodTable::Id(std::string_view(kv.val.via.str.ptr, kv.val.via.str.size));
+        } else if(key == "id" && kv.val.type == msgpack::type::POSITIVE_INTEGER) {
+            tsxId = kv.val.via.u64;
+            hasTsxId = true;
+        }
+    }
+}
+
 /* =========================================== */
 /* === class public function implement  ====== */
 /* =========================================== */
 int CommandHandler::config(const std::filesystem::path& dataDir,
-                           std::weak_ptr<Carrier> carrier)
+                           std::weak_ptr<Carrier> carrier,
+                           const RateLimitConfig rateLimits[RATE_LIMIT_CLASSES])
 {
     Log::D(Log::Tag::Cmd, "Config command handler.");
     int ret = Listener::SetDataDir(dataDir);
     CHECK_ERROR(ret);
 
+    rateLimiter.config(rateLimits);
+
     threadPool = ThreadPool::Create("command-handler");
     carrierHandler = carrier;
 
@@ -92,54 +122,101 @@ std::weak_ptr<Carrier> CommandHandler::getCarrierHandler()
     return carrierHandler;
 }
 
-int CommandHandler::received(const std::string& from, const std::vector<uint8_t>& data)
+uint64_t CommandHandler::getRejectedCount(RateLimiter::MethodClass methodClass)
+{
+    return rateLimiter.getRejectedCount(methodClass);
+}
+
+int CommandHandler::received(PeerId from, const std::vector<uint8_t>& data)
 {
     CHECK_ASSERT(threadPool != nullptr, ErrCode::PointerReleasedError);
 
-    threadPool->post([this, from = std::move(from), data = std::move(data)] {
-        int ret = processAdvance(from, data);
-        if(ret != ErrCode::UnimplementedError) {
+    RpcMethod method = RPC_METHOD_UNKNOWN;
+    if(admit(from, data, method) == false) {
+        return 0;
+    }
+
+    // reserve the pad of rpc_unmarshal_req() so that the request is never copied again.
+    std::vector<uint8_t> inbound;
+    inbound.reserve(data.size() + RPC_REQ_PAD_LEN);
+    inbound.assign(data.begin(), data.end());
+
+    // the queue is served by one thread, so an identical read still queued is in flight.
+    // a read queued after a write must not take a result computed before it.
+    std::string flightKey;
+    if(ReadCoalescer::Coalescible(method) == false) {
+        readCoalescer.seal();
+    } else {
+        ReadCoalescer::Follower follower = {from, 0, {}, {}};
+        if(ReadCoalescer::MakeKey(inbound, flightKey, follower.tsxId, follower.accessToken) == true) {
+            follower.data.swap(inbound);
+            if(readCoalescer.join(flightKey, follower) == false) {
+                return 0;
+            }
+            inbound.swap(follower.data);
+        }
+    }
+
+    threadPool->post([this, from, data = std::move(inbound), method,
+                      flightKey = std::move(flightKey)]() mutable {
+        if(method == RPC_METHOD_BATCH) {
+            processBatch(from, data);
+            return;
+        }
+        if(flightKey.empty() == false) {
+            processFlight(from, data, flightKey);
             return;
         }
 
-        process(from, data);
+        dispatch(from, data);
     });
 
     return 0;
 }
 
-int CommandHandler::send(const std::string &to, const std::vector<uint8_t> &data,
+int CommandHandler::send(PeerId to, const std::vector<uint8_t> &data,
                          CarrierFriendMessageReceiptCallback* receiptCallback, void* receiptContext)
 {
     CHECK_ASSERT(threadPool != nullptr, ErrCode::PointerReleasedError);
 
-    threadPool->post([this, to = std::move(to), data = std::move(data), receiptCallback, receiptContext] {
+    threadPool->post([this, to, data = std::move(data), receiptCallback, receiptContext] {
         SAFE_GET_PTR_NO_RETVAL(carrier, this->getCarrierHandler());
-        auto msgid = carrier_send_friend_message(carrier.get(), to.c_str(),
+        auto msgid = carrier_send_friend_message(carrier.get(), peer_name(to),
                                                 data.data(), data.size(),
                                                 nullptr,
                                                 receiptCallback, receiptContext);
         if(msgid < 0) {
-           PrintCarrierError("Failed to send message to: [" + to + "].");
+           PrintCarrierError(std::string("Failed to send message to: [") + peer_name(to) + "].");
            return;
        }
 
-       Log::D(Log::Tag::Cmd, "Success send message to [%s].", to.c_str());
+       Log::D(Log::Tag::Cmd, "Success send message to [%s].", peer_name(to));
     });
 
     return 0;
 }
 
-int CommandHandler::process(const std::string& from, const std::vector<uint8_t>& data)
+void CommandHandler::dispatch(PeerId from, std::vector<uint8_t>& data)
+{
+    int ret = processAdvance(from, data);
+    if(ret != ErrCode::UnimplementedError) {
+        return;
+    }
+
+    process(from, data);
+}
+
+int CommandHandler::process(PeerId from, std::vector<uint8_t>& data)
 {
     std::shared_ptr<Req> req;
     std::shared_ptr<Resp> resp;
     int ret = unpackRequest(data, req);
     if(ret >= 0) {
-        Log::D(Log::Tag::Cmd, "Command handler dispose method:%s, tsx_id:%llu, from:%s", req->method, req->tsx_id, from.c_str());
+        Log::D(Log::Tag::Cmd, "Command handler dispose method:%s, tsx_id:%llu, from:%s", req->method, req->tsx_id, peer_name(from));
+        auto method = Rpc::MethodTable::Id(req->method);
         ret = ErrCode::UnimplementedError;
         for (const auto& it : cmdListener) {
-            ret = it->onDispose(from, req, resp);
+            ret = it->onDispose(from, method, req, resp);
             if (ret != ErrCode::UnimplementedError) {
                 break;
             }
@@ -161,13 +238,48 @@ int CommandHandler::process(const std::string& from, const std::vector<uint8_t>&
     marshalledResp->sz = respData.size();
     memcpy(marshalledResp->data, respData.data(), respData.size());
 
-    msgq_enq(from.c_str(), marshalledResp);
+    msgq_enq_peer(from, marshalledResp);
     deref(marshalledResp);
 
     return 0;
 }
 
-int CommandHandler::processAdvance(const std::string& from, const std::vector<uint8_t>& data)
+bool CommandHandler::admit(PeerId from, const std::vector<uint8_t>& data, RpcMethod& method)
+{
+    uint64_t tsxId = 0;
+    bool hasTsxId = false;
+
+    method = RPC_METHOD_UNKNOWN;
+
+    // only peek method and id, the payload is referenced and not decoded.
+    try {
+        msgpack::unpack_reference_func refAll = [](msgpack::type::object_type, std::size_t, void*) { return true; };
+        auto mpUnpackHandle = msgpack::unpack(reinterpret_cast<const char*>(data.data()), data.size(), refAll);
+        const msgpack::object& mpRoot = mpUnpackHandle.get();
+        if(mpRoot.type != msgpack::type::MAP) {
+            return true;
+        }
+        PeekRequest(mpRoot, method, tsxId, hasTsxId);
+    } catch(const std::exception& ex) {
+        return true; // malformed request is reported by the normal path.
+    }
+
+    if(rateLimiter.acquire(from, RateLimiter::Classify(method)) == true) {
+        return true;
+    }
+
+    if(hasTsxId == true) {
+        Marshalled* marshalledResp = rpc_marshal_err(tsxId, ERR_RATE_LIMITED, err_strerror(ERR_RATE_LIMITED));
+        if(marshalledResp != nullptr) {
+            msgq_enq_peer(from, marshalledResp);
+            deref(marshalledResp);
+        }
+    }
+
+    return false;
+}
+
+int CommandHandler::processAdvance(PeerId from, const std::vector<uint8_t>& data)
 {
     std::shared_ptr<Rpc::Request> request;
     std::vector<std::shared_ptr<Rpc::Response>> responseArray;
@@ -196,18 +308,260 @@ int CommandHandler::processAdvance(const std::string& from, const std::vector<ui
         marshalledResp->sz = respData.size();
         memcpy(marshalledResp->data, respData.data(), respData.size());
 
-        msgq_enq(from.c_str(), marshalledResp);
+        msgq_enq_peer(from, marshalledResp);
         deref(marshalledResp);
     }
 
     return 0;
 }
 
-int CommandHandler::unpackRequest(const std::vector<uint8_t>& data,
+/*
+ * A batch is a request whose params hold complete requests:
+ *   {"version": "1.0", "method": "batch", "id": uint,
+ *    "params": {"requests": [request, ...]}}
+ * Only read methods may be batched. The sub-requests run one after the
+ * other with a shared token validation and their replies are returned
+ * in as few messages as fit a carrier frame:
+ *   {"version": "1.0", "id": uint,
+ *    "result": {"is_last": bool, "responses": [response, ...]}}
+ */
+int CommandHandler::processBatch(PeerId from, const std::vector<uint8_t>& data)
+{
+    uint64_t tsxId = 0;
+    bool hasTsxId = false;
+    std::vector<BatchEntry> entries;
+    int ret = unpackBatch(data, tsxId, hasTsxId, entries);
+    if(ret < 0) {
+        if(hasTsxId == true) {
+            Marshalled* marshalledResp = rpc_marshal_err(tsxId, ERR_INVALID_PARAMS, err_strerror(ERR_INVALID_PARAMS));
+            if(marshalledResp != nullptr) {
+                msgq_enq_peer(from, marshalledResp);
+                deref(marshalledResp);
+            }
+        }
+        CHECK_ERROR(ret);
+    }
+    Log::D(Log::Tag::Cmd, "Command handler dispose batch of %d requests, tsx_id:%llu, from:%s",
+                          entries.size(), tsxId, peer_name(from));
+
+    auto deleter = [](Marshalled* ptr) -> void {
+        deref(ptr);
+    };
+    std::vector<std::shared_ptr<Marshalled>> replies;
+    auto onReply = [](Marshalled* msg, void* context) -> void {
+        auto replies = reinterpret_cast<std::vector<std::shared_ptr<Marshalled>>*>(context);
+        replies->emplace_back(reinterpret_cast<Marshalled*>(ref(msg)), [](Marshalled* ptr) { deref(ptr); });
+    };
+
+    msgq_capture_begin(from, onReply, &replies);
+    auth_token_scope_begin();
+    for(auto& entry: entries) {
+        int errCode = 0;
+        if(entry.method == RPC_METHOD_BATCH
+        || RateLimiter::Classify(entry.method) != RateLimiter::Read) {
+            errCode = ERR_INVALID_PARAMS;
+        } else if(rateLimiter.acquire(from, RateLimiter::Read) == false) {
+            errCode = ERR_RATE_LIMITED;
+        }
+
+        if(errCode == 0) {
+            dispatch(from, entry.data);
+        } else if(entry.hasTsxId == true) {
+            auto marshalledResp = std::shared_ptr<Marshalled>(rpc_marshal_err(entry.tsxId, errCode, err_strerror(errCode)), deleter);
+            if(marshalledResp != nullptr) {
+                replies.push_back(marshalledResp);
+            }
+        }
+    }
+    auth_token_scope_end();
+    msgq_capture_end();
+
+    ret = sendBatchReplies(from, tsxId, replies);
+    CHECK_ERROR(ret);
+
+    return 0;
+}
+
+/*
+ * The leader of a flight runs as usual with its replies held back, then
+ * the replies are sent to the leader and, with their tsx_id replaced, to
+ * every follower whose access token is valid. If the leader did not
+ * succeed, the followers run one by one.
+ */
+void CommandHandler::processFlight(PeerId from, std::vector<uint8_t>& data, const std::string& flightKey)
+{
+    std::vector<std::shared_ptr<Marshalled>> replies;
+    auto onReply = [](Marshalled* msg, void* context) -> void {
+        auto replies = reinterpret_cast<std::vector<std::shared_ptr<Marshalled>>*>(context);
+        replies->emplace_back(reinterpret_cast<Marshalled*>(ref(msg)), [](Marshalled* ptr) { deref(ptr); });
+    };
+
+    msgq_capture_begin(from, onReply, &replies);
+    dispatch(from, data);
+    msgq_capture_end();
+    auto followers = readCoalescer.leave(flightKey);
+
+    for(const auto& reply: replies) {
+        msgq_enq_peer(from, reply.get());
+    }
+    if(followers.empty() == true) {
+        return;
+    }
+    Log::D(Log::Tag::Cmd, "Command handler coalesced %d requests with the one from:%s",
+                          followers.size(), peer_name(from));
+
+    auth_token_scope_begin();
+    for(auto& follower: followers) {
+        int ret = replyFollower(follower, replies);
+        if(ret < 0) {
+            dispatch(follower.peer, follower.data);
+        }
+    }
+    auth_token_scope_end();
+}
+
+int CommandHandler::replyFollower(const ReadCoalescer::Follower& follower,
+                                  const std::vector<std::shared_ptr<Marshalled>>& replies)
+{
+    CHECK_ASSERT(replies.empty() == false, ErrCode::CmdUnknownRespFailed);
+
+    UserInfo* uinfo = create_uinfo_from_access_token(follower.accessToken.c_str());
+    if(uinfo == nullptr) {
+        Marshalled* marshalledResp = rpc_marshal_err(follower.tsxId, ERR_ACCESS_TOKEN_EXP,
+                                                     err_strerror(ERR_ACCESS_TOKEN_EXP));
+        if(marshalledResp != nullptr) {
+            msgq_enq_peer(follower.peer, marshalledResp);
+            deref(marshalledResp);
+        }
+        return 0;
+    }
+    deref(uinfo);
+
+    auto deleter = [](Marshalled* ptr) -> void {
+        deref(ptr);
+    };
+    std::vector<std::shared_ptr<Marshalled>> retagged;
+    retagged.reserve(replies.size());
+    for(const auto& reply: replies) {
+        auto marshalledResp = std::shared_ptr<Marshalled>(ReadCoalescer::Retag(reply.get(), follower.tsxId), deleter);
+        CHECK_ASSERT(marshalledResp != nullptr, ErrCode::CmdMarshalRespFailed);
+        retagged.push_back(marshalledResp);
+    }
+
+    for(const auto& marshalledResp: retagged) {
+        msgq_enq_peer(follower.peer, marshalledResp.get());
+    }
+
+    return 0;
+}
+
+int CommandHandler::unpackBatch(const std::vector<uint8_t>& data, uint64_t& tsxId, bool& hasTsxId,
+                                std::vector<BatchEntry>& entries) const
+{
+    try {
+        msgpack::unpack_reference_func refAll = [](msgpack::type::object_type, std::size_t, void*) { return true; };
+        auto mpUnpackHandle = msgpack::unpack(reinterpret_cast<const char*>(data.data()), data.size(), refAll);
+        const msgpack::object& mpRoot = mpUnpackHandle.get();
+        RpcMethod method;
+        PeekRequest(mpRoot, method, tsxId, hasTsxId);
+        CHECK_ASSERT(mpRoot.type == msgpack::type::MAP, ErrCode::InvalidArgument);
+
+        const msgpack::object* mpRequests = nullptr;
+        for(uint32_t idx = 0; idx < mpRoot.via.map.size; idx++) {
+            const auto& kv = mpRoot.via.map.ptr[idx];
+            if(kv.key.type != msgpack::type::STR || kv.val.type != msgpack::type::MAP
+            || std::string_view(kv.key.via.str.ptr, kv.key.via.str.size) != "params") {
+                continue;
+            }
+            for(uint32_t paramIdx = 0; paramIdx < kv.val.via.map.size; paramIdx++) {
+                const auto& param = kv.val.via.map.ptr[paramIdx];
+                if(param.key.type == msgpack::type::STR
+                && std::string_view(param.key.via.str.ptr, param.key.via.str.size) == "requests") {
+                    mpRequests = &param.val;
+                }
+            }
+        }
+        CHECK_ASSERT(mpRequests != nullptr && mpRequests->type == msgpack::type::ARRAY, ErrCode::InvalidArgument);
+        CHECK_ASSERT(mpRequests->via.array.size > 0 && mpRequests->via.array.size <= BatchMaxRequests,
+                     ErrCode::InvalidArgument);
+
+        entries.reserve(mpRequests->via.array.size);
+        for(uint32_t idx = 0; idx < mpRequests->via.array.size; idx++) {
+            const auto& mpRequest = mpRequests->via.array.ptr[idx];
+            CHECK_ASSERT(mpRequest.type == msgpack::type::MAP, ErrCode::InvalidArgument);
+
+            BatchEntry entry;
+            PeekRequest(mpRequest, entry.method, entry.tsxId, entry.hasTsxId);
+
+            msgpack::sbuffer sbuf;
+            msgpack::pack(sbuf, mpRequest);
+            entry.data.reserve(sbuf.size() + RPC_REQ_PAD_LEN);
+            entry.data.assign(sbuf.data(), sbuf.data() + sbuf.size());
+            entries.push_back(std::move(entry));
+        }
+    } catch(const std::exception& ex) {
+        Log::W(Log::Tag::Cmd, "Failed to unpack batch request: %s", ex.what());
+        CHECK_ERROR(ErrCode::InvalidArgument);
+    }
+
+    return 0;
+}
+
+int CommandHandler::sendBatchReplies(PeerId from, uint64_t tsxId,
+                                     const std::vector<std::shared_ptr<Marshalled>>& replies)
+{
+    constexpr size_t limit = MSGQ_FRAME_LEN - RPC_RESP_ENVELOPE_LEN;
+
+    size_t begin = 0;
+    do {
+        // a reply larger than a frame goes alone and is fragmented by msgq.
+        size_t end = begin;
+        size_t size = 0;
+        while(end < replies.size() && (end == begin || size + replies[end]->sz <= limit)) {
+            size += replies[end]->sz;
+            end++;
+        }
+        bool isLast = (end == replies.size());
+
+        msgpack::sbuffer sbuf(size + RPC_RESP_ENVELOPE_LEN);
+        msgpack::packer<msgpack::sbuffer> packer(sbuf);
+        packer.pack_map(3);
+        packer.pack("version");
+        packer.pack("1.0");
+        packer.pack("id");
+        packer.pack(tsxId);
+        packer.pack("result");
+        packer.pack_map(2);
+        packer.pack("is_last");
+        packer.pack(isLast);
+        packer.pack("responses");
+        packer.pack_array(end - begin);
+        for(size_t idx = begin; idx < end; idx++) { // replies are packed already, copy them as they are.
+            sbuf.write(reinterpret_cast<const char*>(replies[idx]->data), replies[idx]->sz);
+        }
+
+        Marshalled* marshalledResp = (Marshalled*)rc_zalloc(sizeof(Marshalled) + sbuf.size(), NULL);
+        CHECK_ASSERT(marshalledResp != nullptr, ErrCode::OutOfMemoryError);
+        marshalledResp->data = marshalledResp + 1;
+        marshalledResp->sz = sbuf.size();
+        memcpy(marshalledResp->data, sbuf.data(), sbuf.size());
+
+        msgq_enq_peer(from, marshalledResp);
+        deref(marshalledResp);
+
+        begin = end;
+    } while(begin < replies.size());
+
+    return 0;
+}
+
+int CommandHandler::unpackRequest(std::vector<uint8_t>& data,
                                   std::shared_ptr<Req>& req) const
 {
     Req *reqBuf = nullptr;
-    int ret = rpc_unmarshal_req(data.data(), data.size(),& reqBuf);
+    auto len = data.size();
+    data.resize(len + RPC_REQ_PAD_LEN);
+    int ret = rpc_unmarshal_req(data.data(), len, &reqBuf);
     auto deleter = [](void* ptr) -> void {
         deref(ptr);
     };
@@ -278,8 +632,8 @@ int CommandHandler::Listener::SetDataDir(const std::filesystem::path& dataDir)
     return 0;
 }
 
-void CommandHandler::Listener::setHandleMap(const std::map<const char*, NormalHandler>& normalHandlerMap,
-                                            const std::map<const char*, AdvancedHandler>& advancedHandlerMap)
+void CommandHandler::Listener::setHandleMap(const std::map<RpcMethod, NormalHandler>& normalHandlerMap,
+                                            const std::map<RpcMethod, AdvancedHandler>& advancedHandlerMap)
 {
     this->normalHandlerMap = std::move(normalHandlerMap);
     this->advancedHandlerMap = std::move(advancedHandlerMap);
@@ -306,37 +660,32 @@ int CommandHandler::Listener::checkAccessible(Accessible accessible, const std::
     return 0;
 }
 
-int CommandHandler::Listener::onDispose(const std::string& from,
+int CommandHandler::Listener::onDispose(PeerId from,
+                                        RpcMethod method,
                                         std::shared_ptr<Req> req,
                                         std::shared_ptr<Resp>& resp)
 {
     std::ignore = from;
 
-    for (const auto& it : normalHandlerMap) {
-        if (std::strcmp(it.first, req->method) != 0) {
-            continue;
-        }
-
-        int ret = checkAccessible(it.second.accessible, reinterpret_cast<TkReq*>(req.get())->params.tk);
-        CHECK_ERROR(ret);
+    auto it = normalHandlerMap.find(method);
+    if (it == normalHandlerMap.end()) {
+        return ErrCode::UnimplementedError;
+    }
 
-        ret = it.second.callback(req, resp);
-        CHECK_ERROR(ret);
+    int ret = checkAccessible(it->second.accessible, reinterpret_cast<TkReq*>(req.get())->params.tk);
+    CHECK_ERROR(ret);
 
-        return ret;
-    }
+    ret = it->second.callback(req, resp);
+    CHECK_ERROR(ret);
 
-    return ErrCode::UnimplementedError;
+    return ret;
 }
 
 int CommandHandler::Listener::onDispose(std::shared_ptr<Rpc::Request> request,
                                         std::vector<std::shared_ptr<Rpc::Response>>& responseArray)
 {
-    for (const auto& it : advancedHandlerMap) {
-        if (it.first != request->method) {
-            continue;
-        }
-
+    auto it = advancedHandlerMap.find(request->methodId);
+    if (it != advancedHandlerMap.end()) {
         Log::D(Log::Tag::Cmd, "Request:");
         Log::D(Log::Tag::Cmd, "  ->  %s", request->str().c_str());
 
@@ -345,10 +694,10 @@ int CommandHandler::Listener::onDispose(std::shared_ptr<Rpc::Request> request,
         if(requestTokenPtr != nullptr) {
             accessToken = requestTokenPtr->accessToken();
         }
-        int ret = checkAccessible(it.second.accessible, accessToken);
+        int ret = checkAccessible(it->second.accessible, accessToken);
         CHECK_ERROR(ret);
 
-        ret = it.second.callback(request, responseArray);
+        ret = it->second.callback(request, responseArray);
         CHECK_ERROR(ret);
 
         Log::D(Log::Tag::Cmd, "Response(%d):", responseArray.size());
@@ -7,6 +7,8 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <RateLimiter.hpp>
+#include <ReadCoalescer.hpp>
 #include <RpcFactory.hpp>
 #include <StdFileSystem.hpp>
 
@@ -50,11 +52,12 @@ public:
         explicit Listener() = default;
         virtual ~Listener() = default;
 
-        void setHandleMap(const std::map<const char*, NormalHandler>& normalHandlerMap,
-                          const std::map<const char*, AdvancedHandler>& advancedHandlerMap);
+        void setHandleMap(const std::map<RpcMethod, NormalHandler>& normalHandlerMap,
+                          const std::map<RpcMethod, AdvancedHandler>& advancedHandlerMap);
 
         virtual int checkAccessible(Accessible accessible, const std::string& accessToken);
-        virtual int onDispose(const std::string& from,
+        virtual int onDispose(PeerId from,
+                              RpcMethod method,
                               std::shared_ptr<Req> req,
                               std::shared_ptr<Resp>& resp);
         virtual int onDispose(std::shared_ptr<Rpc::Request> request,
@@ -67,8 +70,8 @@ public:
         int isMember(const std::string& accessToken);
         int getUserInfo(const std::string& accessToken, std::shared_ptr<UserInfo>& userInfo);
 
-        std::map<const char *, NormalHandler> normalHandlerMap;
-        std::map<const char *, AdvancedHandler> advancedHandlerMap;
+        std::map<RpcMethod, NormalHandler> normalHandlerMap;
+        std::map<RpcMethod, AdvancedHandler> advancedHandlerMap;
 
         friend CommandHandler;
     };
@@ -79,16 +82,19 @@ public:
 
     /*** class function and variable ***/
     int config(const std::filesystem::path &dataDir,
-                std::weak_ptr<Carrier> carrier);
+                std::weak_ptr<Carrier> carrier,
+                const RateLimitConfig rateLimits[RATE_LIMIT_CLASSES]);
     void cleanup();
 
     std::weak_ptr<Carrier> getCarrierHandler();
+    uint64_t getRejectedCount(RateLimiter::MethodClass methodClass);
 
-    int received(const std::string& from, const std::vector<uint8_t>& data);
-    int send(const std::string &to, const std::vector<uint8_t>& data,
+    int received(PeerId from, const std::vector<uint8_t>& data);
+    int send(PeerId to, const std::vector<uint8_t>& data,
              CarrierFriendMessageReceiptCallback* receiptCallback = nullptr, void* receiptContext = nullptr);
 
-    int unpackRequest(const std::vector<uint8_t>& data,
+    // req borrows its strings from data, keep data alive and untouched while using req.
+    int unpackRequest(std::vector<uint8_t>& data,
                       std::shared_ptr<Req>& req) const;
     int packResponse(const std::shared_ptr<Req>& req,
                      const std::shared_ptr<Resp>& resp,
@@ -104,17 +110,39 @@ protected:
 
 private:
     /*** type define ***/
+    struct BatchEntry {
+        RpcMethod method;
+        uint64_t tsxId;
+        bool hasTsxId;
+        std::vector<uint8_t> data;
+    };
 
     /*** static function and variable ***/
+    static constexpr size_t BatchMaxRequests = 32;
     static std::shared_ptr<CommandHandler> CmdHandlerInstance;
 
+    static void PeekRequest(const msgpack::object& mpRoot,
+                            RpcMethod& method, uint64_t& tsxId, bool& hasTsxId);
+
     /*** class function and variable ***/
     explicit CommandHandler() = default;
     virtual ~CommandHandler() = default;
-    int process(const std::string& from, const std::vector<uint8_t>& data);
-    int processAdvance(const std::string& from, const std::vector<uint8_t>& data);
+    void dispatch(PeerId from, std::vector<uint8_t>& data);
+    int process(PeerId from, std::vector<uint8_t>& data);
+    int processAdvance(PeerId from, const std::vector<uint8_t>& data);
+    int processBatch(PeerId from, const std::vector<uint8_t>& data);
+    void processFlight(PeerId from, std::vector<uint8_t>& data, const std::string& flightKey);
+    int replyFollower(const ReadCoalescer::Follower& follower,
+                      const std::vector<std::shared_ptr<Marshalled>>& replies);
+    int unpackBatch(const std::vector<uint8_t>& data, uint64_t& tsxId, bool& hasTsxId,
+                    std::vector<BatchEntry>& entries) const;
+    int sendBatchReplies(PeerId from, uint64_t tsxId,
+                         const std::vector<std::shared_ptr<Marshalled>>& replies);
+    bool admit(PeerId from, const std::vector<uint8_t>& data, RpcMethod& method);
 
     std::shared_ptr<ThreadPool> threadPool;
+    RateLimiter rateLimiter;
+    ReadCoalescer readCoalescer;
     std::weak_ptr<Carrier> carrierHandler;
     std::vector<std::shared_ptr<Listener>> cmdListener;
 };
@@ -1,5 +1,6 @@
 #include "LegacyMethod.hpp"
 
+#include <array>
 #include <crystal.h>
 #include <CommandHandler.hpp>
 #include <ErrCode.hpp>
@@ -19,53 +20,69 @@ namespace trinity {
 /* === static variables initialize =========== */
 /* =========================================== */
 static struct {
-    const char *method;
+    RpcMethod method;
     void (*hdlr)(Carrier *c, const char *from, Req *base);
 } method_hdlrs[] = {
-    {"declare_owner"               , hdl_decl_owner_req         },
-    {"import_did"                  , hdl_imp_did_req            },
-    {"issue_credential"            , hdl_iss_vc_req             },
-    {"update_credential"           , hdl_update_vc_req          },
-    {"signin_request_challenge"    , hdl_signin_req_chal_req    },
-    {"signin_confirm_challenge"    , hdl_signin_conf_chal_req   },
-    {"create_channel"              , hdl_create_chan_req        },
-    {"update_feedinfo"             , hdl_upd_chan_req           },
-    {"update_user_info"            , hdl_upd_user_info_req      },  //2.0
-    {"publish_post"                , hdl_pub_post_req           },
-    {"declare_post"                , hdl_declare_post_req       },
-    {"notify_post"                 , hdl_notify_post_req        },
-    {"edit_post"                   , hdl_edit_post_req          },
-    {"delete_post"                 , hdl_del_post_req           },
-    {"post_comment"                , hdl_post_cmt_req           },
-    {"edit_comment"                , hdl_edit_cmt_req           },
-    {"delete_comment"              , hdl_del_cmt_req            },
-    {"block_comment"               , hdl_block_cmt_req          },
-    {"unblock_comment"             , hdl_unblock_cmt_req        },
-    {"post_like"                   , hdl_post_like_req          },
-    {"post_unlike"                 , hdl_post_unlike_req        },
-    {"get_my_channels"             , hdl_get_my_chans_req       },
-    {"get_my_channels_metadata"    , hdl_get_my_chans_meta_req  },
-    {"get_channels"                , hdl_get_chans_req          },
-    {"get_channel_detail"          , hdl_get_chan_dtl_req       },
-    {"get_subscribed_channels"     , hdl_get_sub_chans_req      },
-    {"get_posts"                   , hdl_get_posts_req          },
-    {"get_posts_likes_and_comments", hdl_get_posts_lac_req      },
-    {"get_liked_posts"             , hdl_get_liked_posts_req    },
-    {"get_liked_data"              , hdl_get_liked_data_req     },  //2.0
-    {"get_comments"                , hdl_get_cmts_req           },
-    {"get_comments_likes"          , hdl_get_cmts_likes_req     },
-    {"get_statistics"              , hdl_get_stats_req          },
-    {"subscribe_channel"           , hdl_sub_chan_req           },
-    {"unsubscribe_channel"         , hdl_unsub_chan_req         },
-    {"enable_notification"         , hdl_enbl_notif_req         },
-    {"get_service_version"         , hdl_get_srv_ver_req        },
-    {"report_illegal_comment"      , hdl_report_illegal_cmt_req },
-    {"get_reported_comments"       , hdl_get_reported_cmts_req  },
+    {RPC_METHOD_DECL_OWNER        , hdl_decl_owner_req         },
+    {RPC_METHOD_IMP_DID           , hdl_imp_did_req            },
+    {RPC_METHOD_ISS_VC            , hdl_iss_vc_req             },
+    {RPC_METHOD_UPDATE_VC         , hdl_update_vc_req          },
+    {RPC_METHOD_SIGNIN_REQ_CHAL   , hdl_signin_req_chal_req    },
+    {RPC_METHOD_SIGNIN_CONF_CHAL  , hdl_signin_conf_chal_req   },
+    {RPC_METHOD_CREATE_CHAN       , hdl_create_chan_req        },
+    {RPC_METHOD_UPD_CHAN          , hdl_upd_chan_req           },
+    {RPC_METHOD_UPD_USER_INFO     , hdl_upd_user_info_req      },  //2.0
+    {RPC_METHOD_PUB_POST          , hdl_pub_post_req           },
+    {RPC_METHOD_DECLARE_POST      , hdl_declare_post_req       },
+    {RPC_METHOD_NOTIFY_POST       , hdl_notify_post_req        },
+    {RPC_METHOD_EDIT_POST         , hdl_edit_post_req          },
+    {RPC_METHOD_DEL_POST          , hdl_del_post_req           },
+    {RPC_METHOD_POST_CMT          , hdl_post_cmt_req           },
+    {RPC_METHOD_EDIT_CMT          , hdl_edit_cmt_req           },
+    {RPC_METHOD_DEL_CMT           , hdl_del_cmt_req            },
+    {RPC_METHOD_BLOCK_CMT         , hdl_block_cmt_req          },
+    {RPC_METHOD_UNBLOCK_CMT       , hdl_unblock_cmt_req        },
+    {RPC_METHOD_POST_LIKE         , hdl_post_like_req          },
+    {RPC_METHOD_POST_UNLIKE       , hdl_post_unlike_req        },
+    {RPC_METHOD_GET_MY_CHANS      , hdl_get_my_chans_req       },
+    {RPC_METHOD_GET_MY_CHANS_META , hdl_get_my_chans_meta_req  },
+    {RPC_METHOD_GET_CHANS         , hdl_get_chans_req          },
+    {RPC_METHOD_GET_CHAN_DTL      , hdl_get_chan_dtl_req       },
+    {RPC_METHOD_GET_SUB_CHANS     , hdl_get_sub_chans_req      },
+    {RPC_METHOD_GET_POSTS         , hdl_get_posts_req          },
+    {RPC_METHOD_SYNC_CHANGES      , hdl_sync_changes_req       },
+    {RPC_METHOD_GET_TIMELINE      , hdl_get_timeline_req       },
+    {RPC_METHOD_GET_CMT_THREAD    , hdl_get_cmt_thread_req     },
+    {RPC_METHOD_GET_POSTS_LAC     , hdl_get_posts_lac_req      },
+    {RPC_METHOD_GET_LIKED_POSTS   , hdl_get_liked_posts_req    },
+    {RPC_METHOD_GET_LIKED_DATA    , hdl_get_liked_data_req     },  //2.0
+    {RPC_METHOD_GET_CMTS          , hdl_get_cmts_req           },
+    {RPC_METHOD_GET_CMTS_LIKES    , hdl_get_cmts_likes_req     },
+    {RPC_METHOD_GET_STATS         , hdl_get_stats_req          },
+    {RPC_METHOD_SUB_CHAN          , hdl_sub_chan_req           },
+    {RPC_METHOD_UNSUB_CHAN        , hdl_unsub_chan_req         },
+    {RPC_METHOD_ENBL_NOTIF        , hdl_enbl_notif_req         },
+    {RPC_METHOD_GET_SRV_VER       , hdl_get_srv_ver_req        },
+    {RPC_METHOD_REPORT_ILLEGAL_CMT, hdl_report_illegal_cmt_req },
+    {RPC_METHOD_GET_REPORTED_CMTS , hdl_get_reported_cmts_req  },
 };
 
 /* =========================================== */
 /* === static function implement ============= */
 /* =========================================== */
+static auto method_hdlr(RpcMethod method)
+{
+    using Hdlr = decltype(method_hdlrs[0].hdlr);
+    static const auto hdlrs = [] {
+        std::array<Hdlr, RPC_METHOD_COUNT> hdlrs {};
+        for (const auto& it : method_hdlrs) {
+            hdlrs[it.method] = it.hdlr;
+        }
+        return hdlrs;
+    }();
+
+    return hdlrs[method];
+}
 
 /* =========================================== */
 /* === class public function implement  ====== */
@@ -74,21 +91,21 @@ static struct {
 /* =========================================== */
 /* === class protected function implement  === */
 /* =========================================== */
-int LegacyMethod::onDispose(const std::string& from,
+int LegacyMethod::onDispose(PeerId from,
+                            RpcMethod method,
                             std::shared_ptr<Req> req,
                             std::shared_ptr<Resp>& resp)
 {
+    auto hdlr = method_hdlr(method);
+    if (hdlr == nullptr) {
+        return ErrCode::UnimplementedError;
+    }
+
     auto carrierHandler = CommandHandler::GetInstance()->getCarrierHandler();
     SAFE_GET_PTR(carrier, carrierHandler);
 
-    for (int i = 0; i < sizeof(method_hdlrs) / sizeof(method_hdlrs[0]); ++i) {
-        if (!strcmp(req->method, method_hdlrs[i].method)) {
-            method_hdlrs[i].hdlr(carrier.get(), from.c_str(), req.get());
-            return ErrCode::CompletelyFinishedNotify;
-        }
-    }
-
-    return ErrCode::UnimplementedError;
+    hdlr(carrier.get(), peer_name(from), req.get());
+    return ErrCode::CompletelyFinishedNotify;
 }
 
 /* =========================================== */
@@ -25,7 +25,8 @@ protected:
     /*** static function and variable ***/
 
     /*** class function and variable ***/
-    virtual int onDispose(const std::string& from,
+    virtual int onDispose(PeerId from,
+                          RpcMethod method,
                           std::shared_ptr<Req> req,
                           std::shared_ptr<Resp>& resp) override final;
 
@@ -25,9 +25,9 @@ MassData::MassData(const std::filesystem::path& massDataDir)
     : massDataDir(massDataDir)
 {
     using namespace std::placeholders;
-    std::map<const char*, NormalHandler> normalHandlerMap {
-        {Method::SetBinary, {std::bind(&MassData::onSetBinary, this, _1, _2), Accessible::Owner}},
-        {Method::GetBinary, {std::bind(&MassData::onGetBinary, this, _1, _2), Accessible::Member}},
+    std::map<RpcMethod, NormalHandler> normalHandlerMap {
+        {RPC_METHOD_SET_BINARY, {std::bind(&MassData::onSetBinary, this, _1, _2), Accessible::Owner}},
+        {RPC_METHOD_GET_BINARY, {std::bind(&MassData::onGetBinary, this, _1, _2), Accessible::Member}},
     };
 
     setHandleMap(normalHandlerMap, {});
@@ -12,10 +12,6 @@ namespace trinity {
 class MassData : public CommandHandler::Listener {
 public:
     /*** type define ***/
-    struct Method {
-        static constexpr const char* SetBinary = "set_binary";
-        static constexpr const char* GetBinary = "get_binary";
-    };
 
     /*** static function and variable ***/
     static constexpr const char* MassDataDirName = "massdata";
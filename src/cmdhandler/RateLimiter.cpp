@@ -0,0 +1,116 @@
+#include "RateLimiter.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <Log.hpp>
+
+namespace trinity {
+
+/* =========================================== */
+/* === static variables initialize =========== */
+/* =========================================== */
+constexpr uint64_t RateLimiter::RejectLogInterval;
+
+/* =========================================== */
+/* === static function implement ============= */
+/* =========================================== */
+RateLimiter::MethodClass RateLimiter::Classify(RpcMethod method)
+{
+    switch(method) {
+    case RPC_METHOD_SIGNIN_REQ_CHAL:
+    case RPC_METHOD_SIGNIN_CONF_CHAL:
+    case RPC_METHOD_STANDARD_SIGN_IN:
+    case RPC_METHOD_STANDARD_DID_AUTH:
+    case RPC_METHOD_DECL_OWNER:
+    case RPC_METHOD_IMP_DID:
+    case RPC_METHOD_ISS_VC:
+    case RPC_METHOD_UPDATE_VC:
+        return Auth;
+    case RPC_METHOD_BATCH: // its sub-requests are charged one by one.
+    case RPC_METHOD_SYNC_CHANGES:
+        return Read;
+    default:
+        break;
+    }
+
+    auto name = Rpc::MethodTable::Name(method);
+    if(name != nullptr && std::strncmp(name, "get_", 4) == 0) {
+        return Read;
+    }
+
+    return Write;
+}
+
+/* =========================================== */
+/* === class public function implement  ====== */
+/* =========================================== */
+void RateLimiter::config(const RateLimitConfig limits[RATE_LIMIT_CLASSES])
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::copy(limits, limits + RATE_LIMIT_CLASSES, this->limits);
+    peerStates.clear();
+}
+
+bool RateLimiter::acquire(PeerId peer, MethodClass methodClass)
+{
+    const auto& limit = limits[methodClass];
+    if(limit.rate <= 0) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto now = Clock::now();
+    auto it = peerStates.find(peer);
+    if(it == peerStates.end()) {
+        PeerState state {};
+        for(int idx = 0; idx < RATE_LIMIT_CLASSES; idx++) {
+            state.buckets[idx].tokens = limits[idx].burst;
+            state.buckets[idx].lastRefill = now;
+        }
+        it = peerStates.emplace(peer, state).first;
+    }
+
+    auto& bucket = it->second.buckets[methodClass];
+    std::chrono::duration<double> elapsed = now - bucket.lastRefill;
+    bucket.tokens = std::min<double>(limit.burst, bucket.tokens + elapsed.count() * limit.rate);
+    bucket.lastRefill = now;
+
+    if(bucket.tokens >= 1.0) {
+        bucket.tokens -= 1.0;
+        return true;
+    }
+
+    auto rejected = ++it->second.rejected[methodClass];
+    if(rejected % RejectLogInterval == 1) {
+        Log::W(Log::Tag::Cmd, "Rate limited peer %s on method class %d, rejected %" PRIu64 " times.",
+                              peer_name(peer), methodClass, rejected);
+    }
+
+    return false;
+}
+
+uint64_t RateLimiter::getRejectedCount(MethodClass methodClass)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint64_t rejected = 0;
+    for(const auto& [peer, state]: peerStates) {
+        rejected += state.rejected[methodClass];
+    }
+
+    return rejected;
+}
+
+/* =========================================== */
+/* === class protected function implement  === */
+/* =========================================== */
+
+
+/* =========================================== */
+/* === class private function implement  ===== */
+/* =========================================== */
+
+} // namespace trinity
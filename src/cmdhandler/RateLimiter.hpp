@@ -0,0 +1,81 @@
+#ifndef _FEEDS_RATE_LIMITER_HPP_
+#define _FEEDS_RATE_LIMITER_HPP_
+
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <RpcMethod.hpp>
+
+extern "C" {
+#define new fix_cpp_keyword_new
+#include <cfg.h>
+#undef new
+#include <peers.h>
+}
+
+namespace trinity {
+
+class RateLimiter {
+public:
+    /*** type define ***/
+    enum MethodClass {
+        Auth = RATE_LIMIT_AUTH,
+        Read = RATE_LIMIT_READ,
+        Write = RATE_LIMIT_WRITE,
+    };
+
+    /*** static function and variable ***/
+    static MethodClass Classify(RpcMethod method);
+
+    /*** class function and variable ***/
+    explicit RateLimiter() = default;
+    virtual ~RateLimiter() = default;
+
+    void config(const RateLimitConfig limits[RATE_LIMIT_CLASSES]);
+
+    // take one token from the bucket of peer, return false if the bucket is empty.
+    bool acquire(PeerId peer, MethodClass methodClass);
+    // requests of methodClass rejected from all the peers.
+    uint64_t getRejectedCount(MethodClass methodClass);
+
+protected:
+    /*** type define ***/
+
+    /*** static function and variable ***/
+
+    /*** class function and variable ***/
+
+private:
+    /*** type define ***/
+    using Clock = std::chrono::steady_clock;
+
+    struct Bucket {
+        double tokens;
+        Clock::time_point lastRefill;
+    };
+    struct PeerState {
+        Bucket buckets[RATE_LIMIT_CLASSES];
+        uint64_t rejected[RATE_LIMIT_CLASSES];
+    };
+
+    /*** static function and variable ***/
+    static constexpr uint64_t RejectLogInterval = 100;
+
+    /*** class function and variable ***/
+    // buckets survive reconnecting, the state is bounded by the friend list.
+    std::mutex mutex;
+    RateLimitConfig limits[RATE_LIMIT_CLASSES] = {};
+    std::unordered_map<PeerId, PeerState> peerStates;
+};
+
+/***********************************************/
+/***** class template function implement *******/
+/***********************************************/
+
+/***********************************************/
+/***** macro definition ************************/
+/***********************************************/
+
+} // namespace trinity
+
+#endif /* _FEEDS_RATE_LIMITER_HPP_ */
@@ -0,0 +1,233 @@
+#include "ReadCoalescer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <msgpack.hpp>
+
+#include <crystal.h>
+
+namespace trinity {
+
+/* =========================================== */
+/* === static variables initialize =========== */
+/* =========================================== */
+
+/* =========================================== */
+/* === static function implement ============= */
+/* =========================================== */
+bool ReadCoalescer::Coalescible(RpcMethod method)
+{
+    switch(method) {
+    case RPC_METHOD_GET_CHANS:
+    case RPC_METHOD_GET_POSTS:
+    case RPC_METHOD_GET_CMTS:
+        return true;
+    default:
+        break;
+    }
+
+    return false;
+}
+
+bool ReadCoalescer::MakeKey(const std::vector<uint8_t>& data, std::string& key,
+                            uint64_t& tsxId, std::string& accessToken)
+{
+    using Entry = std::pair<std::string_view, const msgpack::object*>;
+    auto sortMap = [](const msgpack::object& mpMap, const char* skip, std::vector<Entry>& entries) -> bool {
+        for(uint32_t idx = 0; idx < mpMap.via.map.size; idx++) {
+            const auto& kv = mpMap.via.map.ptr[idx];
+            if(kv.key.type != msgpack::type::STR) {
+                return false;
+            }
+            std::string_view name(kv.key.via.str.ptr, kv.key.via.str.size);
+            if(name != skip) {
+                entries.emplace_back(name, &kv.val);
+            }
+        }
+        std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+            return lhs.first < rhs.first;
+        });
+        return std::adjacent_find(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+            return lhs.first == rhs.first;
+        }) == entries.end();
+    };
+
+    try {
+        msgpack::unpack_reference_func refAll = [](msgpack::type::object_type, std::size_t, void*) { return true; };
+        auto mpUnpackHandle = msgpack::unpack(reinterpret_cast<const char*>(data.data()), data.size(), refAll);
+        const msgpack::object& mpRoot = mpUnpackHandle.get();
+        if(mpRoot.type != msgpack::type::MAP) {
+            return false;
+        }
+
+        std::vector<Entry> rootEntries;
+        if(sortMap(mpRoot, "id", rootEntries) == false) {
+            return false;
+        }
+
+        bool hasTsxId = false;
+        for(uint32_t idx = 0; idx < mpRoot.via.map.size; idx++) {
+            const auto& kv = mpRoot.via.map.ptr[idx];
+            if(std::string_view(kv.key.via.str.ptr, kv.key.via.str.size) == "id"
+            && kv.val.type == msgpack::type::POSITIVE_INTEGER) {
+                tsxId = kv.val.via.u64;
+                hasTsxId = true;
+            }
+        }
+        if(hasTsxId == false) { // nothing to reply to a follower without id.
+            return false;
+        }
+
+        msgpack::sbuffer sbuf;
+        msgpack::packer<msgpack::sbuffer> packer(sbuf);
+        bool hasToken = false;
+        packer.pack_map(rootEntries.size());
+        for(const auto& [name, val]: rootEntries) {
+            packer.pack(name);
+            if(name != "params" || val->type != msgpack::type::MAP) {
+                packer.pack(*val);
+                continue;
+            }
+
+            std::vector<Entry> paramEntries;
+            if(sortMap(*val, "access_token", paramEntries) == false) {
+                return false;
+            }
+            for(uint32_t idx = 0; idx < val->via.map.size; idx++) {
+                const auto& kv = val->via.map.ptr[idx];
+                if(std::string_view(kv.key.via.str.ptr, kv.key.via.str.size) == "access_token"
+                && kv.val.type == msgpack::type::STR) {
+                    accessToken.assign(kv.val.via.str.ptr, kv.val.via.str.size);
+                    hasToken = true;
+                }
+            }
+            packer.pack_map(paramEntries.size());
+            for(const auto& [paramName, paramVal]: paramEntries) {
+                packer.pack(paramName);
+                packer.pack(*paramVal);
+            }
+        }
+        if(hasToken == false) { // the token of each follower is checked on its own.
+            return false;
+        }
+
+        key.assign(sbuf.data(), sbuf.size());
+    } catch(const std::exception& ex) {
+        return false; // malformed request is reported by the normal path.
+    }
+
+    return true;
+}
+
+Marshalled* ReadCoalescer::Retag(const Marshalled* reply, uint64_t tsxId)
+{
+    auto data = reinterpret_cast<const char*>(reply->data);
+    size_t idBegin = 0;
+    size_t idEnd = 0;
+    size_t off = 0;
+
+    // responses are packed as {"version", "id", "result"}, stop at the result and copy it as it is.
+    try {
+        msgpack::unpack_reference_func refAll = [](msgpack::type::object_type, std::size_t, void*) { return true; };
+        auto header = static_cast<uint8_t>(data[off++]);
+        if((header & 0xf0) != 0x80) {
+            return nullptr;
+        }
+        for(size_t idx = 0; idx < (header & 0x0f); idx++) {
+            auto mpKey = msgpack::unpack(data, reply->sz, off, refAll);
+            if(mpKey.get().type != msgpack::type::STR) {
+                return nullptr;
+            }
+            std::string_view name(mpKey.get().via.str.ptr, mpKey.get().via.str.size);
+            if(name == "result") {
+                break;
+            } else if(name == "error") {
+                return nullptr;
+            }
+
+            size_t valBegin = off;
+            msgpack::unpack(data, reply->sz, off, refAll);
+            if(name == "id") {
+                idBegin = valBegin;
+                idEnd = off;
+            }
+        }
+    } catch(const std::exception& ex) {
+        return nullptr;
+    }
+    if(idEnd == 0 || off >= reply->sz) {
+        return nullptr;
+    }
+
+    msgpack::sbuffer idBuf;
+    msgpack::pack(idBuf, tsxId);
+
+    size_t sz = reply->sz - (idEnd - idBegin) + idBuf.size();
+    Marshalled* retagged = (Marshalled*)rc_zalloc(sizeof(Marshalled) + sz, NULL);
+    if(retagged == nullptr) {
+        return nullptr;
+    }
+    retagged->data = retagged + 1;
+    retagged->sz = sz;
+
+    auto ptr = reinterpret_cast<char*>(retagged->data);
+    memcpy(ptr, data, idBegin);
+    memcpy(ptr + idBegin, idBuf.data(), idBuf.size());
+    memcpy(ptr + idBegin + idBuf.size(), data + idEnd, reply->sz - idEnd);
+
+    return retagged;
+}
+
+/* =========================================== */
+/* === class public function implement  ====== */
+/* =========================================== */
+bool ReadCoalescer::join(const std::string& key, Follower& follower)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto& pending = flights[key];
+    if(pending.empty() == true || pending.back().generation != generation) {
+        pending.push_back({generation, {}});
+        return true;
+    }
+
+    pending.back().followers.push_back(std::move(follower));
+
+    return false;
+}
+
+std::vector<ReadCoalescer::Follower> ReadCoalescer::leave(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<Follower> followers;
+    auto it = flights.find(key);
+    if(it != flights.end()) {
+        followers = std::move(it->second.front().followers);
+        it->second.pop_front();
+        if(it->second.empty() == true) {
+            flights.erase(it);
+        }
+    }
+
+    return followers;
+}
+
+void ReadCoalescer::seal()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    generation++;
+}
+
+/* =========================================== */
+/* === class protected function implement  === */
+/* =========================================== */
+
+
+/* =========================================== */
+/* === class private function implement  ===== */
+/* =========================================== */
+
+} // namespace trinity
@@ -0,0 +1,86 @@
+#ifndef _FEEDS_READ_COALESCER_HPP_
+#define _FEEDS_READ_COALESCER_HPP_
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <RpcMethod.hpp>
+
+extern "C" {
+#include <peers.h>
+#include <rpc.h>
+}
+
+namespace trinity {
+
+/*
+ * Identical reads that wait in the command queue at the same time share one
+ * execution. The first one leads the flight, the others follow it and get
+ * the replies of the leader with their own tsx_id.
+ */
+class ReadCoalescer {
+public:
+    /*** type define ***/
+    struct Follower {
+        PeerId peer;
+        uint64_t tsxId;
+        std::string accessToken;
+        std::vector<uint8_t> data; // kept to run the follower alone if the leader failed.
+    };
+
+    /*** static function and variable ***/
+    // only reads whose replies do not depend on the caller may be coalesced.
+    static bool Coalescible(RpcMethod method);
+    // the key is the request without its id and access token, with maps sorted by key.
+    static bool MakeKey(const std::vector<uint8_t>& data, std::string& key,
+                        uint64_t& tsxId, std::string& accessToken);
+    // copy of a packed result with another tsx_id, return nullptr for an error reply.
+    static Marshalled* Retag(const Marshalled* reply, uint64_t tsxId);
+
+    /*** class function and variable ***/
+    explicit ReadCoalescer() = default;
+    virtual ~ReadCoalescer() = default;
+
+    // return true if a flight is started, otherwise follower is taken by the pending flight.
+    bool join(const std::string& key, Follower& follower);
+    // finish the oldest flight of key and return its followers.
+    std::vector<Follower> leave(const std::string& key);
+    // pending flights take no more followers, called when a request that may write is queued.
+    void seal();
+
+protected:
+    /*** type define ***/
+
+    /*** static function and variable ***/
+
+    /*** class function and variable ***/
+
+private:
+    /*** type define ***/
+    struct Flight {
+        uint64_t generation;
+        std::vector<Follower> followers;
+    };
+
+    /*** static function and variable ***/
+
+    /*** class function and variable ***/
+    // a sealed flight of a key may still be queued ahead of a newer one, in queue order.
+    std::mutex mutex;
+    uint64_t generation = 0;
+    std::unordered_map<std::string, std::deque<Flight>> flights;
+};
+
+/***********************************************/
+/***** class template function implement *******/
+/***********************************************/
+
+/***********************************************/
+/***** macro definition ************************/
+/***********************************************/
+
+} // namespace trinity
+
+#endif /* _FEEDS_READ_COALESCER_HPP_ */
@@ -1,6 +1,8 @@
 #include "StandardAuth.hpp"
 
+#include <algorithm>
 #include <fstream>
+#include <iterator>
 #include <map>
 
 #include <DateTime.hpp>
@@ -35,6 +37,8 @@ namespace trinity {
 /* =========================================== */
 /* === static variables initialize =========== */
 /* =========================================== */
+std::mutex StandardAuth::LocalDocMutex;
+std::map<std::string, StandardAuth::LocalDoc> StandardAuth::LocalDocCache;
 
 /* =========================================== */
 /* === static function implement ============= */
@@ -81,6 +85,8 @@ int StandardAuth::SaveLocalDIDDocument(DID* did, DIDDocument* doc)
     docStream.flush();
     docStream.close();
 
+    CacheLocalDocJson(DID_GetMethodSpecificId(did), std::make_shared<const std::string>(docStr.get()));
+
     return 0;
 }
 
@@ -97,29 +103,67 @@ DIDDocument* StandardAuth::LoadLocalDIDDocument(DID* did)
         }
     }
 
+    auto json = GetLocalDocJson(DID_GetMethodSpecificId(did));
+    if(json == nullptr) {
+        return nullptr;
+    }
+
+    return DIDDocument_FromJson(json->c_str());
+}
+
+std::shared_ptr<const std::string> StandardAuth::GetLocalDocJson(const std::string& docId)
+{
+    {
+        std::lock_guard<std::mutex> lock(LocalDocMutex);
+        auto it = LocalDocCache.find(docId);
+        if(it != LocalDocCache.end() && it->second.expiration > DateTime::Current()) {
+            return it->second.json;
+        }
+    }
+
     auto localDocDir = GetLocalDocDir();
     if(localDocDir.empty() == true) {
         Log::E(Log::Tag::Cmd, "Local did document directory is not set.");
         return nullptr;
     };
 
-    auto docFilePath = localDocDir / DID_GetMethodSpecificId(did);
+    std::shared_ptr<std::string> json;
+    auto docFilePath = localDocDir / docId;
     auto fileExists = std::filesystem::exists(docFilePath);
-    if(fileExists == false) {
-        return nullptr;
+    if(fileExists == true) {
+        // Log::D(Log::Tag::Cmd, "Load did document from local: %s", docFilePath.c_str());
+        std::ifstream docStream(docFilePath, std::ios::binary);
+        json = std::make_shared<std::string>(std::istreambuf_iterator<char>(docStream),
+                                             std::istreambuf_iterator<char>());
+        json->erase(json->find_last_not_of('\0') + 1); // the file is saved with its terminator.
     }
-    // Log::D(Log::Tag::Cmd, "Load did document from local: %s", docFilePath.c_str());
 
-    auto docSize = std::filesystem::file_size(docFilePath);
-    char *docStr = (char *)alloca(docSize);
+    CacheLocalDocJson(docId, json);
 
-    std::fstream docStream;
-    docStream.open(docFilePath, std::ios::binary | std::ios::in);
-    docStream.seekg(0);
-    docStream.read(docStr, docSize);
-    docStream.close();
+    return json;
+}
+
+void StandardAuth::CacheLocalDocJson(const std::string& docId, std::shared_ptr<const std::string> json)
+{
+    auto now = DateTime::Current();
+
+    std::lock_guard<std::mutex> lock(LocalDocMutex);
+    if(LocalDocCache.size() >= LOCAL_DOC_CACHE_SIZE) {
+        for(auto it = LocalDocCache.begin(); it != LocalDocCache.end();) {
+            it = (it->second.expiration <= now ? LocalDocCache.erase(it) : std::next(it));
+        }
+    }
+    if(LocalDocCache.size() >= LOCAL_DOC_CACHE_SIZE && LocalDocCache.count(docId) == 0) {
+        // all the entries are live, drop the one expiring first.
+        auto oldest = std::min_element(LocalDocCache.begin(), LocalDocCache.end(),
+                                       [](const auto& lhs, const auto& rhs) {
+            return lhs.second.expiration < rhs.second.expiration;
+        });
+        LocalDocCache.erase(oldest);
+    }
 
-    return DIDDocument_FromJson(docStr);
+    auto expiration = now + (json != nullptr ? LOCAL_DOC_EXPIRATION : LOCAL_DOC_MISS_EXPIRATION);
+    LocalDocCache[docId] = {json, expiration};
 }
 
 /* =========================================== */
@@ -128,9 +172,9 @@ DIDDocument* StandardAuth::LoadLocalDIDDocument(DID* did)
 StandardAuth::StandardAuth()
 {
     using namespace std::placeholders;
-    std::map<const char*, AdvancedHandler> advancedHandlerMap {
-        {Rpc::Factory::Method::StandardSignIn,  {std::bind(&StandardAuth::onStandardSignIn, this, _1, _2), Accessible::Anyone}},
-        {Rpc::Factory::Method::StandardDidAuth, {std::bind(&StandardAuth::onStandardDidAuth, this, _1, _2), Accessible::Anyone}},
+    std::map<RpcMethod, AdvancedHandler> advancedHandlerMap {
+        {RPC_METHOD_STANDARD_SIGN_IN, {std::bind(&StandardAuth::onStandardSignIn, this, _1, _2), Accessible::Anyone}},
+        {RPC_METHOD_STANDARD_DID_AUTH, {std::bind(&StandardAuth::onStandardDidAuth, this, _1, _2), Accessible::Anyone}},
     };
 
     setHandleMap({}, advancedHandlerMap);
@@ -213,7 +257,7 @@ int StandardAuth::onStandardSignIn(std::shared_ptr<Rpc::Request> request,
 
     authSecretMap[nonceStr] = std::move(AuthSecret{didStr, expiration});
 
-    auto responsePtr = Rpc::Factory::MakeResponse(request->method);
+    auto responsePtr = Rpc::Factory::MakeResponse(request->methodId);
     auto response = std::dynamic_pointer_cast<Rpc::StandardSignInResponse>(responsePtr);
     CHECK_ASSERT(response != nullptr, ErrCode::RpcUnimplementedError);
     response->version = request->version;
@@ -246,7 +290,7 @@ int StandardAuth::onStandardDidAuth(std::shared_ptr<Rpc::Request> request,
     ret = createAccessToken(credentialInfo, userIndex, accessToken);
     CHECK_ERROR(ret);
 
-    auto responsePtr = Rpc::Factory::MakeResponse(request->method);
+    auto responsePtr = Rpc::Factory::MakeResponse(request->methodId);
     auto response = std::dynamic_pointer_cast<Rpc::StandardDidAuthResponse>(responsePtr);
     CHECK_ASSERT(response != nullptr, ErrCode::RpcUnimplementedError);
     response->version = request->version;
@@ -464,6 +508,7 @@ int StandardAuth::adaptOldLogin(const CredentialInfo& credentialInfo)
             ret = ErrCode::AuthUpdateOwnerError;
         }
         CHECK_ERROR(ret);
+        feeds_owner_info_changed();
     }
 
     int ret = db_upsert_user(&uinfo, &(uinfo.uid));
@@ -3,6 +3,8 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 #include <CommandHandler.hpp>
@@ -50,13 +52,27 @@ private:
         std::string email;
     };
 
+    struct LocalDoc {
+        std::shared_ptr<const std::string> json; // nullptr if there is no local document.
+        int64_t expiration;
+    };
+
     /*** static function and variable ***/
     static std::filesystem::path GetLocalDocDir();
     static int SaveLocalDIDDocument(DID* did, DIDDocument* doc);
     static DIDDocument* LoadLocalDIDDocument(DID* did);
+    static std::shared_ptr<const std::string> GetLocalDocJson(const std::string& docId);
+    static void CacheLocalDocJson(const std::string& docId, std::shared_ptr<const std::string> json);
 
     constexpr static const int64_t JWT_EXPIRATION = (static_cast<int64_t>(5) * 60); // 5 minute
     constexpr static const int64_t ACCESS_EXPIRATION = (static_cast<int64_t>(30) * 24 * 60 * 60); //1 month
+    constexpr static const int64_t LOCAL_DOC_EXPIRATION = (static_cast<int64_t>(10) * 60); // 10 minute
+    constexpr static const int64_t LOCAL_DOC_MISS_EXPIRATION = 60; // 1 minute
+    constexpr static const size_t LOCAL_DOC_CACHE_SIZE = 1024;
+
+    // json of the local documents by their method specific id, the sdk owns the documents it resolves.
+    static std::mutex LocalDocMutex;
+    static std::map<std::string, LocalDoc> LocalDocCache;
 
     /*** class function and variable ***/
     int onStandardSignIn(std::shared_ptr<Rpc::Request> request,
@@ -27,6 +27,11 @@
 #include <time.h>
 #endif
 
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <set>
+#include <unordered_map>
 #include <vector>
 #include <crystal.h>
 #include <sqlite3.h>
@@ -34,6 +39,7 @@
 #include "did.h"
 #include "ver.h"
 #include "db.h"
+#include "postcache.h"
 
 #define TAG_DB "[Feedsd.Db  ]: "
 
@@ -43,9 +49,20 @@ typedef struct {
 } DBUserInfo;
 
 typedef void *(*Row2Raw)(sqlite3_stmt *);
+typedef void *(*Row2Proj)(sqlite3_stmt *, uint64_t fields);
 typedef struct DBObjIt {
     sqlite3_stmt *stmt;
     Row2Raw cb;
+    Row2Proj proj_cb;
+    uint64_t fields;
+    sqlite3_stmt **srcs;  // merged sources, the first nsrcs of them a heap
+    size_t nsrcs;
+    size_t cap;
+    uint64_t left;
+    sqlite3_stmt *replies;  // the first replies to each row
+    sqlite3_stmt *replies_cnt;
+    size_t max_replies;
+    Arena *arena;  // rows are allocated from it if set
 } DBObjIt;
 
 typedef struct DBInitOperator {
@@ -210,6 +227,114 @@ int create_new_index(const char *table_name, const char *para)
     return 0;
 }
 
+/*
+ * Every insert or update of a post or a comment moves its row of the
+ * change log to the tail, so the log holds the latest change of each
+ * object in the order they happened.
+ */
+static
+int create_change_log(const char *table_name, const char *para)
+{
+    const char *sqls[] = {
+        "CREATE INDEX changes_channel_seq_index ON changes (channel_id, seq)",
+        // log what existed before the change log.
+        "INSERT INTO changes(channel_id, post_id, comment_id)"
+        "  SELECT channel_id, post_id, comment_id FROM ("
+        "    SELECT channel_id, post_id, 0 AS comment_id, updated_at FROM posts"
+        "    UNION ALL"
+        "    SELECT channel_id, post_id, comment_id, updated_at FROM comments)"
+        "  ORDER BY updated_at",
+    };
+    size_t i;
+
+    (void)para;
+
+    for (i = 0; i < sizeof(sqls) / sizeof(sqls[0]); i++) {
+        if (-1 == sql_execution(sqls[i])) {
+            vlogE(TAG_DB "Creating %s log failed", table_name);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Triggers feeding the change log, recreated on every start: renaming
+ * posts or comments to their backup on an upgrade takes the triggers
+ * along with it.
+ */
+static
+int create_change_triggers()
+{
+    const char *sqls[] = {
+        "DROP TRIGGER IF EXISTS posts_insert_change",
+        "DROP TRIGGER IF EXISTS posts_update_change",
+        "DROP TRIGGER IF EXISTS comments_insert_change",
+        "DROP TRIGGER IF EXISTS comments_update_change",
+        "CREATE TRIGGER posts_insert_change AFTER INSERT ON posts BEGIN"
+        "  INSERT OR REPLACE INTO changes(channel_id, post_id, comment_id)"
+        "    VALUES (NEW.channel_id, NEW.post_id, 0);"
+        " END",
+        "CREATE TRIGGER posts_update_change AFTER UPDATE ON posts BEGIN"
+        "  INSERT OR REPLACE INTO changes(channel_id, post_id, comment_id)"
+        "    VALUES (NEW.channel_id, NEW.post_id, 0);"
+        " END",
+        "CREATE TRIGGER comments_insert_change AFTER INSERT ON comments BEGIN"
+        "  INSERT OR REPLACE INTO changes(channel_id, post_id, comment_id)"
+        "    VALUES (NEW.channel_id, NEW.post_id, NEW.comment_id);"
+        " END",
+        "CREATE TRIGGER comments_update_change AFTER UPDATE ON comments BEGIN"
+        "  INSERT OR REPLACE INTO changes(channel_id, post_id, comment_id)"
+        "    VALUES (NEW.channel_id, NEW.post_id, NEW.comment_id);"
+        " END",
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(sqls) / sizeof(sqls[0]); i++) {
+        if (-1 == sql_execution(sqls[i])) {
+            vlogE(TAG_DB "Creating change log triggers failed");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Indexes serving the keyset queries, created on every start so that
+ * existing databases get them too.
+ */
+static
+int create_query_indexes()
+{
+    const char *sqls[] = {
+        "CREATE INDEX IF NOT EXISTS posts_timeline_index"
+        "  ON posts (channel_id, created_at, post_id)",
+        "CREATE INDEX IF NOT EXISTS posts_updated_at_keyset_index"
+        "  ON posts (channel_id, updated_at, post_id)",
+        "CREATE INDEX IF NOT EXISTS comments_created_at_keyset_index"
+        "  ON comments (channel_id, post_id, created_at, comment_id)",
+        "CREATE INDEX IF NOT EXISTS comments_updated_at_keyset_index"
+        "  ON comments (channel_id, post_id, updated_at, comment_id)",
+        "CREATE INDEX IF NOT EXISTS comments_thread_index"
+        "  ON comments (channel_id, post_id, refcomment_id, comment_id)",
+        // channel_id is the rowid, which every index of channels ends with.
+        "CREATE INDEX IF NOT EXISTS channels_created_at_index ON channels (created_at)",
+        "CREATE INDEX IF NOT EXISTS channels_updated_at_index ON channels (updated_at)",
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(sqls) / sizeof(sqls[0]); i++) {
+        if (-1 == sql_execution(sqls[i])) {
+            vlogE(TAG_DB "Creating query indexes failed");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
 int db_init(sqlite3 *handle)
 {
     db = handle;
@@ -451,6 +576,24 @@ int db_init(sqlite3 *handle)
     notification_op.p_add_idx = NULL;
     operator_vec.push_back(&notification_op);
 
+    DBInitOperator changes_op;
+    changes_op.item_num = 4;
+    changes_op.table_name = "changes";
+    changes_op.idx_param = "";
+    changes_op.backup_sql = NULL;
+    changes_op.create_sql = "CREATE TABLE IF NOT EXISTS changes ("
+        "  seq        INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "  channel_id INTEGER NOT NULL,"
+        "  post_id    INTEGER NOT NULL,"
+        "  comment_id INTEGER NOT NULL,"
+        "  UNIQUE(channel_id, post_id, comment_id)"
+        ")";
+    memset(changes_op.retrive_sql, 0, sizeof(changes_op.retrive_sql));
+    changes_op.p_check = check_table_valid;
+    changes_op.p_del_idx = NULL;
+    changes_op.p_add_idx = create_change_log;
+    operator_vec.push_back(&changes_op);
+
     /* ================== stmt-sep BEGIN ================== */
     if (-1 == sql_execution("BEGIN")) {
         vlogE(TAG_DB "BEGIN sql failed");
@@ -521,6 +664,12 @@ int db_init(sqlite3 *handle)
         }
     }
 
+    if (-1 == create_change_triggers())
+        goto rollback;
+
+    if (-1 == create_query_indexes())
+        goto rollback;
+
     /* ================== stmt-sep END ================== */
     if (-1 == sql_execution("END")) {
         vlogE(TAG_DB "END sql failed");
@@ -931,6 +1080,7 @@ int db_upd_post(PostInfo *pi)
             break;
         }
 
+        postcache_invalidate(pi->chan_id, pi->post_id);
         return 0;
     } while(0);
 
@@ -1048,6 +1198,7 @@ int db_set_post_status(PostInfo *pi)
             break;
         }
 
+        postcache_invalidate(pi->chan_id, pi->post_id);
         return 0;
     } while(0);
 
@@ -1356,6 +1507,7 @@ int db_add_cmt(CmtInfo *ci, uint64_t *id)
             break;
         }
 
+        postcache_invalidate(ci->chan_id, ci->post_id);
         return 0;
     } while(0);
 
@@ -1839,12 +1991,112 @@ int db_set_cmt_status(CmtInfo *ci)
     return -1;
 }
 
+/*
+ * Likes of the users who checked a like lately, loaded on their first
+ * check and kept current by db_add_like() and db_rm_like(), so that
+ * liking and unliking do not query the likes table to find out whether
+ * the like is there. A user's likes are kept per channel as
+ * (post_id, comment_id) pairs, the least recently checked users are
+ * dropped first.
+ */
+#define LIKE_SETS_MAX_USERS 1024
+
+typedef std::set<std::pair<uint64_t, uint64_t>> ChanLikes;
+
+typedef struct {
+    std::unordered_map<uint64_t, ChanLikes> chans;
+    std::list<uint64_t>::iterator lru;
+} UserLikes;
+
+static std::mutex like_sets_mutex;
+static std::unordered_map<uint64_t, UserLikes> like_sets;
+static std::list<uint64_t> like_sets_lru;  // most recently checked first
+
+// like_sets_mutex must be held.
+static
+UserLikes *like_set_load(uint64_t uid)
+{
+    sqlite3_stmt *stmt;
+    const char *sql;
+    UserLikes likes;
+    int rc;
+
+    auto it = like_sets.find(uid);
+    if (it != like_sets.end()) {
+        like_sets_lru.splice(like_sets_lru.begin(), like_sets_lru, it->second.lru);
+        return &it->second;
+    }
+
+    sql = "SELECT channel_id, post_id, comment_id FROM likes WHERE user_id = :uid";
+
+    if (SQLITE_OK != sqlite3_prepare_v2(db, sql, -1, &stmt, NULL)) {
+        vlogE(TAG_DB "sqlite3_prepare_v2() failed");
+        return NULL;
+    }
+
+    rc = sqlite3_bind_int64(stmt,
+            sqlite3_bind_parameter_index(stmt, ":uid"),
+            uid);
+    if (SQLITE_OK != rc) {
+        vlogE(TAG_DB "Binding parameter failed");
+        sqlite3_finalize(stmt);
+        return NULL;
+    }
+
+    while (SQLITE_ROW == (rc = sqlite3_step(stmt)))
+        likes.chans[sqlite3_column_int64(stmt, 0)].emplace(sqlite3_column_int64(stmt, 1),
+                                                           sqlite3_column_int64(stmt, 2));
+    sqlite3_finalize(stmt);
+    if (SQLITE_DONE != rc) {
+        vlogE(TAG_DB "Executing SELECT failed");
+        return NULL;
+    }
+
+    if (like_sets.size() >= LIKE_SETS_MAX_USERS) {
+        like_sets.erase(like_sets_lru.back());
+        like_sets_lru.pop_back();
+    }
+
+    like_sets_lru.push_front(uid);
+    likes.lru = like_sets_lru.begin();
+    return &like_sets.emplace(uid, std::move(likes)).first->second;
+}
+
+// updates the likes of uid if they are loaded.
+static
+void like_set_update(uint64_t uid, uint64_t channel_id, uint64_t post_id,
+                     uint64_t comment_id, bool liked)
+{
+    std::lock_guard<std::mutex> lock(like_sets_mutex);
+
+    auto it = like_sets.find(uid);
+    if (it == like_sets.end())
+        return;
+
+    ChanLikes &chan = it->second.chans[channel_id];
+    if (liked)
+        chan.emplace(post_id, comment_id);
+    else
+        chan.erase(std::make_pair(post_id, comment_id));
+}
+
 int db_like_exists(uint64_t uid, uint64_t channel_id, uint64_t post_id, uint64_t comment_id)
 {
     sqlite3_stmt *stmt;
     const char *sql;
     int rc;
 
+    {
+        std::lock_guard<std::mutex> lock(like_sets_mutex);
+        UserLikes *likes = like_set_load(uid);
+
+        if (likes) {
+            auto chan = likes->chans.find(channel_id);
+            return chan != likes->chans.end() &&
+                   chan->second.count(std::make_pair(post_id, comment_id)) ? 1 : 0;
+        }
+    }
+
     sql = "SELECT EXISTS(SELECT * "
           "                FROM likes "
           "                WHERE user_id = :uid AND "
@@ -2046,6 +2298,9 @@ int db_add_like(uint64_t uid, uint64_t channel_id, uint64_t post_id,
             break;
         }
 
+        if (!comment_id)
+            postcache_invalidate(channel_id, post_id);
+        like_set_update(uid, channel_id, post_id, comment_id, true);
         return 0;
     } while(0);
 
@@ -2174,6 +2429,9 @@ int db_rm_like(uint64_t uid, uint64_t channel_id, uint64_t post_id, uint64_t com
             break;
         }
 
+        if (!comment_id)
+            postcache_invalidate(channel_id, post_id);
+        like_set_update(uid, channel_id, post_id, comment_id, false);
         return 0;
     } while(0);
 
@@ -2581,13 +2839,118 @@ const char *query_column(QueryObject qo, QryFld qf)
     }
 }
 
+/*
+ * Keyset of a query sorted by a column and then by the primary key: the
+ * columns in sort order and, when resuming from a cursor, the values of
+ * the last item seen. A column of the key equal to the sort column is
+ * left out.
+ */
+typedef struct {
+    size_t      n;
+    const char *cols[3];
+    uint64_t    vals[3];
+    bool        after;
+    bool        asc;
+} Keyset;
+
+static
+int keyset_init(Keyset *ks, const QryCriteria *qc, const char *qcol,
+                const char *pk0, const char *pk1)
+{
+    QryCursor cur = {0};
+
+    if (qc->cursor_len && (!qry_cursor_unpack(qc->cursor, qc->cursor_len, &cur) ||
+                           cur.by != qc->by)) {
+        vlogE(TAG_DB "Invalid query cursor");
+        return -1;
+    }
+
+    ks->n       = 0;
+    ks->after   = qc->cursor_len > 0;
+    ks->asc     = qc->by == ID;
+    ks->cols[0] = qcol;
+    ks->vals[ks->n++] = cur.val;
+    if (strcmp(pk0, qcol)) {
+        ks->cols[ks->n] = pk0;
+        ks->vals[ks->n++] = cur.id[0];
+    }
+    if (pk1 && strcmp(pk1, qcol)) {
+        ks->cols[ks->n] = pk1;
+        ks->vals[ks->n++] = cur.id[1];
+    }
+
+    return 0;
+}
+
+// appends the condition resuming after the cursor, if any, joined by conj.
+static
+int keyset_cond(char *sql, const Keyset *ks, const char *conj)
+{
+    int rc = 0;
+    size_t i;
+
+    if (!ks->after)
+        return 0;
+
+    rc += sprintf(sql + rc, "%s (", conj);
+    for (i = 0; i < ks->n; i++)
+        rc += sprintf(sql + rc, "%s%s", i ? ", " : "", ks->cols[i]);
+    rc += sprintf(sql + rc, ") %s (", ks->asc ? ">" : "<");
+    for (i = 0; i < ks->n; i++)
+        rc += sprintf(sql + rc, "%s:ks%zu", i ? ", " : "", i);
+    rc += sprintf(sql + rc, ")");
+
+    return rc;
+}
+
+static
+int keyset_order(char *sql, const Keyset *ks)
+{
+    int rc = 0;
+    size_t i;
+
+    rc += sprintf(sql + rc, " ORDER BY");
+    for (i = 0; i < ks->n; i++)
+        rc += sprintf(sql + rc, "%s %s %s", i ? "," : "", ks->cols[i], ks->asc ? "ASC" : "DESC");
+
+    return rc;
+}
+
+static
+int keyset_bind(sqlite3_stmt *stmt, const Keyset *ks)
+{
+    char param[8];
+    int rc = SQLITE_OK;
+    size_t i;
+
+    for (i = 0; ks->after && i < ks->n; i++) {
+        sprintf(param, ":ks%zu", i);
+        rc |= sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, param),
+                                 ks->vals[i]);
+    }
+
+    return rc;
+}
+
 static
 void it_dtor(void *obj)
 {
     DBObjIt *it = (DBObjIt *)obj;
+    size_t i;
 
     if (it->stmt)
         sqlite3_finalize(it->stmt);
+
+    for (i = 0; i < it->cap; i++)
+        sqlite3_finalize(it->srcs[i]);
+    free(it->srcs);
+
+    if (it->replies)
+        sqlite3_finalize(it->replies);
+    if (it->replies_cnt)
+        sqlite3_finalize(it->replies_cnt);
+
+    deref(it->arena);
 }
 
 static
@@ -2603,8 +2966,40 @@ DBObjIt *it_create(sqlite3_stmt *stmt, Row2Raw cb)
     return it;
 }
 
+// iterator whose rows carry only the optional fields in fields.
+static
+DBObjIt *it_create_proj(sqlite3_stmt *stmt, Row2Proj cb, uint64_t fields)
+{
+    DBObjIt *it = (DBObjIt *)rc_zalloc(sizeof(DBObjIt), it_dtor);
+    if (!it)
+        return NULL;
+
+    it->stmt    = stmt;
+    it->proj_cb = cb;
+    it->fields  = fields;
+
+    return it;
+}
+
+/*
+ * Selects the columns of an optional field, or placeholders of the same
+ * arity when it is projected out so the row readers keep their indices.
+ */
+#define proj_cols(fields, fld, cols, none) (proj_has(fields, fld) ? (cols) : (none))
+#define PROJ_NO_BLOB "NULL, 0"
+#define PROJ_NO_TEXT "''"
+
+// arena of the iterator building the current row, see db_iter_set_arena().
+static thread_local Arena *row_arena;
+
+static
+void *row_zalloc(size_t sz)
+{
+    return row_arena ? arena_alloc(row_arena, sz) : rc_zalloc(sz, NULL);
+}
+
 static
-void *row2chan(sqlite3_stmt *stmt)
+void *row2chan(sqlite3_stmt *stmt, uint64_t fields)
 {
     const char *name = (const char *)sqlite3_column_text(stmt, 1);
     const char *intro = (const char *)sqlite3_column_text(stmt, 2);
@@ -2639,6 +3034,7 @@ void *row2chan(sqlite3_stmt *stmt)
     buf = (char *)buf + strlen(tipm) + 1;
     ci->proof        = strcpy((char *)buf, proof);
     ci->status       = sqlite3_column_int64(stmt, 11);
+    ci->fields       = fields;
 
     return ci;
 }
@@ -2648,23 +3044,31 @@ DBObjIt *db_iter_chans(const QryCriteria *qc)
     sqlite3_stmt *stmt;
     const char *qcol;
     char sql[1024] = {0};
+    Keyset ks = {};
     DBObjIt *it;
     int rc;
 
     rc = sprintf(sql,
-            "SELECT channel_id, name, intro, subscribers,"
-            " next_post_id, updated_at, created_at, avatar,"
-            " length(avatar), tip_methods, proof, status"
-            " FROM channels");
+            "SELECT channel_id, name, %s, subscribers,"
+            " next_post_id, updated_at, created_at, %s,"
+            " %s, %s, status"
+            " FROM channels",
+            proj_cols(qc->fields, PROJ_INTRO, "intro", PROJ_NO_TEXT),
+            proj_cols(qc->fields, PROJ_AVATAR, "avatar, length(avatar)", PROJ_NO_BLOB),
+            proj_cols(qc->fields, PROJ_TIP_METHODS, "tip_methods", PROJ_NO_TEXT),
+            proj_cols(qc->fields, PROJ_PROOF, "proof", PROJ_NO_TEXT));
     if (qc->by) {
         qcol = query_column(CHANNEL, (QryFld)qc->by);
+        if (keyset_init(&ks, qc, qcol, "channel_id", NULL) < 0)
+            return NULL;
         if (qc->lower || qc->upper)
             rc += sprintf(sql + rc, " WHERE ");
         if (qc->lower)
             rc += sprintf(sql + rc, "%s >= :lower", qcol);
         if (qc->upper)
             rc += sprintf(sql + rc, "%s %s <= :upper", qc->lower ? " AND" : "", qcol);
-        rc += sprintf(sql + rc, " ORDER BY %s %s", qcol, qc->by == ID ? "ASC" : "DESC");
+        rc += keyset_cond(sql + rc, &ks, qc->lower || qc->upper ? " AND" : " WHERE");
+        rc += keyset_order(sql + rc, &ks);
     }
     if (qc->maxcnt)
         rc += sprintf(sql + rc, " LIMIT :maxcnt");
@@ -2707,7 +3111,13 @@ DBObjIt *db_iter_chans(const QryCriteria *qc)
         }
     }
 
-    it = it_create(stmt, row2chan);
+    if (SQLITE_OK != keyset_bind(stmt, &ks)) {
+        vlogE(TAG_DB "Binding parameter cursor failed");
+        sqlite3_finalize(stmt);
+        return NULL;
+    }
+
+    it = it_create_proj(stmt, row2chan, qc->fields);
     if (!it) {
         sqlite3_finalize(stmt);
         return NULL;
@@ -2816,31 +3226,32 @@ DBObjIt *db_iter_sub_chans(uint64_t uid, const QryCriteria *qc)
     return it;
 }
 
+// reads a post from the columns of db_iter_posts() starting at col.
 static
-void *row2post(sqlite3_stmt *stmt)
-{
-    PostStat stat = (PostStat)sqlite3_column_int64(stmt, 2);
-    size_t con_len = (stat != POST_AVAILABLE ? 0 : sqlite3_column_int64(stmt, 4));
-    size_t thu_len = (stat != POST_AVAILABLE ? 0 : sqlite3_column_int64(stmt, 13));  //2.0
-    const char *hash_id = (const char *)sqlite3_column_text(stmt, 9);  //2.0
-    const char *proof = (const char *)sqlite3_column_text(stmt, 10);  //2.0
-    const char *origin_post_url = (const char *)sqlite3_column_text(stmt, 11);  //2.0
+PostInfo *post_from_row(sqlite3_stmt *stmt, int col, uint64_t fields)
+{
+    PostStat stat = (PostStat)sqlite3_column_int64(stmt, col + 2);
+    size_t con_len = (stat != POST_AVAILABLE ? 0 : sqlite3_column_int64(stmt, col + 4));
+    size_t thu_len = (stat != POST_AVAILABLE ? 0 : sqlite3_column_int64(stmt, col + 13));  //2.0
+    const char *hash_id = (const char *)sqlite3_column_text(stmt, col + 9);  //2.0
+    const char *proof = (const char *)sqlite3_column_text(stmt, col + 10);  //2.0
+    const char *origin_post_url = (const char *)sqlite3_column_text(stmt, col + 11);  //2.0
     void *buf;
 
-    PostInfo *pi = (PostInfo *)rc_zalloc(sizeof(PostInfo) + con_len + thu_len +
-            strlen(hash_id) + strlen(proof) + strlen(origin_post_url) + 5, NULL);  //2.0
+    PostInfo *pi = (PostInfo *)row_zalloc(sizeof(PostInfo) + con_len + thu_len +
+            strlen(hash_id) + strlen(proof) + strlen(origin_post_url) + 5);  //2.0
     if (!pi) {
         vlogE(TAG_DB "OOM");
         return NULL;
     }
 
-    pi->chan_id     = sqlite3_column_int64(stmt, 0);
-    pi->post_id     = sqlite3_column_int64(stmt, 1);
+    pi->chan_id     = sqlite3_column_int64(stmt, col);
+    pi->post_id     = sqlite3_column_int64(stmt, col + 1);
     pi->stat        = stat;
-    pi->cmts        = sqlite3_column_int64(stmt, 5);
-    pi->likes       = sqlite3_column_int64(stmt, 6);
-    pi->created_at  = sqlite3_column_int64(stmt, 7);
-    pi->upd_at      = sqlite3_column_int64(stmt, 8);
+    pi->cmts        = sqlite3_column_int64(stmt, col + 5);
+    pi->likes       = sqlite3_column_int64(stmt, col + 6);
+    pi->created_at  = sqlite3_column_int64(stmt, col + 7);
+    pi->upd_at      = sqlite3_column_int64(stmt, col + 8);
     buf = pi + 1;  //2.0
     pi->hash_id     = strcpy((char *)buf, hash_id);  //2.0
     buf = (char *)buf + strlen(hash_id) + 1;  //2.0
@@ -2849,39 +3260,54 @@ void *row2post(sqlite3_stmt *stmt)
     pi->origin_post_url = strcpy((char *)buf, origin_post_url);  //2.0
     if (stat == POST_AVAILABLE) {
         buf = (char *)buf + strlen(origin_post_url) + 1;
-        pi->content = memcpy(buf, sqlite3_column_blob(stmt, 3), con_len);
+        pi->content = memcpy(buf, sqlite3_column_blob(stmt, col + 3), con_len);
         pi->con_len = con_len;
         buf = (char *)buf + con_len + 1;   //2.0
-        pi->thumbnails = memcpy(buf, sqlite3_column_blob(stmt, 12), thu_len);  //2.0
+        pi->thumbnails = memcpy(buf, sqlite3_column_blob(stmt, col + 12), thu_len);  //2.0
         pi->thu_len = thu_len;  //2.0
     }
+    pi->fields      = fields;
 
     return pi;
 }
 
+static
+void *row2post(sqlite3_stmt *stmt, uint64_t fields)
+{
+    return post_from_row(stmt, 0, fields);
+}
+
 DBObjIt *db_iter_posts(uint64_t chan_id, const QryCriteria *qc)
 {
     sqlite3_stmt *stmt;
     const char *qcol;
     char sql[1024] = {0};
+    Keyset ks = {};
     DBObjIt *it;
     int rc;
 
     rc = sprintf(sql,
-                 "SELECT channel_id, post_id, status, content, length(content),"
+                 "SELECT channel_id, post_id, status, %s,"
                  "       next_comment_id - 1 AS comments, likes, created_at,"
-                 "       updated_at, hash_id, proof, origin_post_url, thumbnails,"
-                 "       length(thumbnails)"
+                 "       updated_at, %s, %s, %s, %s"
                  "  FROM posts "
-                 "  WHERE channel_id = :channel_id");  //2.0
+                 "  WHERE channel_id = :channel_id",  //2.0
+                 proj_cols(qc->fields, PROJ_CONTENT, "content, length(content)", PROJ_NO_BLOB),
+                 proj_cols(qc->fields, PROJ_HASH_ID, "hash_id", PROJ_NO_TEXT),
+                 proj_cols(qc->fields, PROJ_PROOF, "proof", PROJ_NO_TEXT),
+                 proj_cols(qc->fields, PROJ_ORIGIN_URL, "origin_post_url", PROJ_NO_TEXT),
+                 proj_cols(qc->fields, PROJ_THUMBNAILS, "thumbnails, length(thumbnails)", PROJ_NO_BLOB));
     rc += sprintf(sql + rc, " AND (status=%d OR status=%d)", POST_AVAILABLE, POST_DELETED);
     if (qc->by) {
         qcol = query_column(POST, (QryFld)qc->by);
+        if (keyset_init(&ks, qc, qcol, "post_id", NULL) < 0)
+            return NULL;
         if (qc->lower)
             rc += sprintf(sql + rc, " AND %s >= :lower", qcol);
         if (qc->upper)
             rc += sprintf(sql + rc, " AND %s <= :upper", qcol);
-        rc += sprintf(sql + rc, " ORDER BY %s %s", qcol, qc->by == ID ? "ASC" : "DESC");
+        rc += keyset_cond(sql + rc, &ks, " AND");
+        rc += keyset_order(sql + rc, &ks);
     }
     if (qc->maxcnt)
         rc += sprintf(sql + rc, " LIMIT :maxcnt");
@@ -2905,13 +3331,14 @@ DBObjIt *db_iter_posts(uint64_t chan_id, const QryCriteria *qc)
         rc |= sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, ":maxcnt"),
                                 qc->maxcnt);
     }
+    rc |= keyset_bind(stmt, &ks);
     if (SQLITE_OK != rc) {
         vlogE(TAG_DB "Binding parameter channel_id failed");
         sqlite3_finalize(stmt);
         return NULL;
     }
 
-    it = it_create(stmt, row2post);
+    it = it_create_proj(stmt, row2post, qc->fields);
     if (!it) {
         sqlite3_finalize(stmt);
         return NULL;
@@ -3018,6 +3445,7 @@ void *row2likedpost(sqlite3_stmt *stmt)
     pi->cmts       = sqlite3_column_int64(stmt, 4);
     pi->likes      = sqlite3_column_int64(stmt, 5);
     pi->created_at = sqlite3_column_int64(stmt, 6);
+    pi->upd_at     = sqlite3_column_int64(stmt, 7);
 
     return pi;
 }
@@ -3027,12 +3455,13 @@ DBObjIt *db_iter_liked_posts(uint64_t uid, const QryCriteria *qc)
     sqlite3_stmt *stmt;
     const char *qcol;
     char sql[1024] = {0};
+    Keyset ks = {};
     DBObjIt *it;
     int rc;
 
     rc = sprintf(sql,
                  "SELECT channel_id, post_id, content, length(content), "
-                 "       next_comment_id - 1 AS comments, likes, created_at "
+                 "       next_comment_id - 1 AS comments, likes, created_at, updated_at "
                  "  FROM (SELECT channel_id, post_id "
                  "          FROM likes "
                  "          WHERE user_id = :uid AND comment_id = 0) JOIN "
@@ -3040,11 +3469,14 @@ DBObjIt *db_iter_liked_posts(uint64_t uid, const QryCriteria *qc)
                  "  WHERE status = :avail");
     if (qc->by) {
         qcol = query_column(POST, (QryFld)qc->by);
+        if (keyset_init(&ks, qc, qcol, "channel_id", "post_id") < 0)
+            return NULL;
         if (qc->lower)
             rc += sprintf(sql + rc, " AND %s >= :lower", qcol);
         if (qc->upper)
             rc += sprintf(sql + rc, " AND %s <= :upper", qcol);
-        rc += sprintf(sql + rc, " ORDER BY %s %s", qcol, qc->by == ID ? "ASC" : "DESC");
+        rc += keyset_cond(sql + rc, &ks, " AND");
+        rc += keyset_order(sql + rc, &ks);
     }
     if (qc->maxcnt)
         rc += sprintf(sql + rc, " LIMIT :maxcnt");
@@ -3070,6 +3502,7 @@ DBObjIt *db_iter_liked_posts(uint64_t uid, const QryCriteria *qc)
         rc |= sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, ":maxcnt"),
                                 qc->maxcnt);
     }
+    rc |= keyset_bind(stmt, &ks);
     if (SQLITE_OK != rc) {
         vlogE(TAG_DB "Binding parameter avail failed");
         sqlite3_finalize(stmt);
@@ -3176,19 +3609,20 @@ DBObjIt *db_iter_liked_data(uint64_t uid, const QryCriteria *qc)
     return it;
 }
 
+// reads a comment from the columns of db_iter_cmts() starting at col.
 static
-void *row2cmt(sqlite3_stmt *stmt)
+CmtInfo *cmt_from_row(sqlite3_stmt *stmt, int col, uint64_t fields)
 {
-    CmtStat stat = (CmtStat)sqlite3_column_int64(stmt, 3);
-    size_t content_len = stat == CMT_AVAILABLE ? sqlite3_column_int64(stmt, 8) : 0;
-    size_t thu_len = stat == CMT_AVAILABLE ? sqlite3_column_int64(stmt, 15) : 0;
-    const char *hash_id = (const char *)sqlite3_column_text(stmt, 12);  //2.0
-    const char *proof = (const char *)sqlite3_column_text(stmt, 13);  //2.0
-    const char *name = (const char *)sqlite3_column_text(stmt, 5);
-    const char *did = (const char *)sqlite3_column_text(stmt, 6);
-    CmtInfo *ci = (CmtInfo *)rc_zalloc(sizeof(CmtInfo) + content_len + thu_len +
+    CmtStat stat = (CmtStat)sqlite3_column_int64(stmt, col + 3);
+    size_t content_len = stat == CMT_AVAILABLE ? sqlite3_column_int64(stmt, col + 8) : 0;
+    size_t thu_len = stat == CMT_AVAILABLE ? sqlite3_column_int64(stmt, col + 15) : 0;
+    const char *hash_id = (const char *)sqlite3_column_text(stmt, col + 12);  //2.0
+    const char *proof = (const char *)sqlite3_column_text(stmt, col + 13);  //2.0
+    const char *name = (const char *)sqlite3_column_text(stmt, col + 5);
+    const char *did = (const char *)sqlite3_column_text(stmt, col + 6);
+    CmtInfo *ci = (CmtInfo *)row_zalloc(sizeof(CmtInfo) + content_len + thu_len +
                             strlen(hash_id) + strlen(proof) + strlen(name) +
-                            strlen(did) + 6, NULL);
+                            strlen(did) + 6);
     void *buf;
 
     if (!ci) {
@@ -3196,11 +3630,11 @@ void *row2cmt(sqlite3_stmt *stmt)
         return NULL;
     }
 
-    ci->chan_id      = sqlite3_column_int64(stmt, 0);
-    ci->post_id      = sqlite3_column_int64(stmt, 1);
-    ci->cmt_id       = sqlite3_column_int64(stmt, 2);
+    ci->chan_id      = sqlite3_column_int64(stmt, col);
+    ci->post_id      = sqlite3_column_int64(stmt, col + 1);
+    ci->cmt_id       = sqlite3_column_int64(stmt, col + 2);
     ci->stat         = stat;
-    ci->reply_to_cmt = sqlite3_column_int64(stmt, 4);
+    ci->reply_to_cmt = sqlite3_column_int64(stmt, col + 4);
     buf = ci + 1;
     ci->user.name    = strcpy((char *)buf, name);
     buf = (char *)buf + strlen(name) + 1;
@@ -3211,19 +3645,41 @@ void *row2cmt(sqlite3_stmt *stmt)
     ci->proof        = strcpy((char *)buf, proof);  //2.0
     if (stat == CMT_AVAILABLE) {
         buf = (char *)buf + strlen(proof) + 1;  //2.0
-        ci->content  = memcpy(buf, sqlite3_column_blob(stmt, 7), content_len);
+        ci->content  = memcpy(buf, sqlite3_column_blob(stmt, col + 7), content_len);
         ci->con_len  = content_len;
         buf = (char *)buf + content_len + 1;   //2.0
-        ci->thumbnails = memcpy(buf, sqlite3_column_blob(stmt, 14), thu_len);  //2.0
+        ci->thumbnails = memcpy(buf, sqlite3_column_blob(stmt, col + 14), thu_len);  //2.0
         ci->thu_len = thu_len;  //2.0
     }
-    ci->likes        = sqlite3_column_int64(stmt, 9);
-    ci->created_at   = sqlite3_column_int64(stmt, 10);
-    ci->upd_at       = sqlite3_column_int64(stmt, 11);
+    ci->likes        = sqlite3_column_int64(stmt, col + 9);
+    ci->created_at   = sqlite3_column_int64(stmt, col + 10);
+    ci->upd_at       = sqlite3_column_int64(stmt, col + 11);
+    ci->fields       = fields;
 
     return ci;
 }
 
+// the columns read by cmt_from_row(), with the projection of fields.
+static
+int sprintf_cmts_select(char *sql, uint64_t fields)
+{
+    return sprintf(sql,
+                   "SELECT channel_id, post_id, comment_id, status, refcomment_id, "
+                   "       name, did, %s, likes, created_at, "
+                   "       updated_at, %s, %s, %s "
+                   "  FROM comments JOIN users USING (user_id) ",
+                   proj_cols(fields, PROJ_CONTENT, "content, length(content)", PROJ_NO_BLOB),
+                   proj_cols(fields, PROJ_HASH_ID, "hash_id", PROJ_NO_TEXT),
+                   proj_cols(fields, PROJ_PROOF, "proof", PROJ_NO_TEXT),
+                   proj_cols(fields, PROJ_THUMBNAILS, "thumbnails, length(thumbnails)", PROJ_NO_BLOB));
+}
+
+static
+void *row2cmt(sqlite3_stmt *stmt, uint64_t fields)
+{
+    return cmt_from_row(stmt, 0, fields);
+}
+
 static
 void *row2reportedcmt(sqlite3_stmt *stmt)
 {
@@ -3259,22 +3715,22 @@ DBObjIt *db_iter_cmts(uint64_t chan_id, uint64_t post_id, const QryCriteria *qc)
     sqlite3_stmt *stmt;
     const char *qcol;
     char sql[1024] = {0};
+    Keyset ks = {};
     DBObjIt *it;
     int rc;
 
-    rc = sprintf(sql,
-                 "SELECT channel_id, post_id, comment_id, status, refcomment_id, "
-                 "       name, did, content, length(content), likes, created_at, "
-                 "       updated_at, hash_id, proof, thumbnails, length(thumbnails) "
-                 "  FROM comments JOIN users USING (user_id) "
-                 "  WHERE channel_id = :channel_id AND post_id = :post_id");
+    rc = sprintf_cmts_select(sql, qc->fields);
+    rc += sprintf(sql + rc, "  WHERE channel_id = :channel_id AND post_id = :post_id");
     if (qc->by) {
         qcol = query_column(COMMENT, (QryFld)qc->by);
+        if (keyset_init(&ks, qc, qcol, "comment_id", NULL) < 0)
+            return NULL;
         if (qc->lower)
             rc += sprintf(sql + rc, " AND %s >= :lower", qcol);
         if (qc->upper)
             rc += sprintf(sql + rc, " AND %s <= :upper", qcol);
-        rc += sprintf(sql + rc, " ORDER BY %s %s", qcol, qc->by == ID ? "ASC" : "DESC");
+        rc += keyset_cond(sql + rc, &ks, " AND");
+        rc += keyset_order(sql + rc, &ks);
     }
     if (qc->maxcnt)
         rc += sprintf(sql + rc, " LIMIT :maxcnt");
@@ -3300,13 +3756,14 @@ DBObjIt *db_iter_cmts(uint64_t chan_id, uint64_t post_id, const QryCriteria *qc)
         rc |= sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, ":maxcnt"),
                                 qc->maxcnt);
     }
+    rc |= keyset_bind(stmt, &ks);
     if (SQLITE_OK != rc) {
         vlogE(TAG_DB "Binding parameter post_id failed");
         sqlite3_finalize(stmt);
         return NULL;
     }
 
-    it = it_create(stmt, row2cmt);
+    it = it_create_proj(stmt, row2cmt, qc->fields);
     if (!it) {
         sqlite3_finalize(stmt);
         return NULL;
@@ -3392,10 +3849,418 @@ DBObjIt *db_iter_cmts_likes(uint64_t chan_id, uint64_t post_id, const QryCriteri
     return it;
 }
 
+static
+void chinfo_dtor(void *obj)
+{
+    ChangeInfo *chi = (ChangeInfo *)obj;
+
+    deref(chi->pinfo);
+    deref(chi->cinfo);
+}
+
+static
+void *row2change(sqlite3_stmt *stmt)
+{
+    ChangeInfo *chi = (ChangeInfo *)rc_zalloc(sizeof(ChangeInfo), chinfo_dtor);
+    if (!chi) {
+        vlogE(TAG_DB "OOM");
+        return NULL;
+    }
+
+    chi->seq = sqlite3_column_int64(stmt, 0);
+    if (sqlite3_column_int64(stmt, 1) == 0)
+        chi->pinfo = post_from_row(stmt, 2, 0);
+    else
+        chi->cinfo = cmt_from_row(stmt, 16, 0);
+
+    if (!chi->pinfo && !chi->cinfo) {
+        deref(chi);
+        return NULL;
+    }
+
+    return chi;
+}
+
+DBObjIt *db_iter_changes(uint64_t chan_id, uint64_t cursor, uint64_t maxcnt)
+{
+    sqlite3_stmt *stmt;
+    char sql[2048] = {0};
+    DBObjIt *it;
+    int rc;
+
+    rc = sprintf(sql,
+                 "SELECT ch.seq, ch.comment_id,"
+                 "       p.channel_id, p.post_id, p.status, p.content, length(p.content),"
+                 "       p.next_comment_id - 1 AS comments, p.likes, p.created_at,"
+                 "       p.updated_at, p.hash_id, p.proof, p.origin_post_url, p.thumbnails,"
+                 "       length(p.thumbnails),"
+                 "       c.channel_id, c.post_id, c.comment_id, c.status, c.refcomment_id,"
+                 "       u.name, u.did, c.content, length(c.content), c.likes, c.created_at,"
+                 "       c.updated_at, c.hash_id, c.proof, c.thumbnails, length(c.thumbnails)"
+                 "  FROM changes ch"
+                 "  LEFT JOIN posts p ON ch.comment_id = 0 AND"
+                 "                       p.channel_id = ch.channel_id AND p.post_id = ch.post_id"
+                 "  LEFT JOIN comments c ON c.channel_id = ch.channel_id AND"
+                 "                          c.post_id = ch.post_id AND c.comment_id = ch.comment_id"
+                 "  LEFT JOIN users u ON u.user_id = c.user_id"
+                 "  WHERE ch.channel_id = :channel_id AND ch.seq > :cursor");
+    rc += sprintf(sql + rc, " AND (p.status=%d OR p.status=%d OR u.user_id IS NOT NULL)",
+                  POST_AVAILABLE, POST_DELETED);
+    rc += sprintf(sql + rc, " ORDER BY ch.seq ASC");
+    if (maxcnt)
+        rc += sprintf(sql + rc, " LIMIT :maxcnt");
+
+    if (SQLITE_OK != sqlite3_prepare_v2(db, sql, -1, &stmt, NULL)) {
+        vlogE(TAG_DB "sqlite3_prepare_v2() failed");
+        return NULL;
+    }
+
+    rc = sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, ":channel_id"),
+                            chan_id);
+    rc |= sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, ":cursor"),
+                            cursor);
+    if (maxcnt) {
+        rc |= sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, ":maxcnt"),
+                                maxcnt);
+    }
+    if (SQLITE_OK != rc) {
+        vlogE(TAG_DB "Binding parameter failed");
+        sqlite3_finalize(stmt);
+        return NULL;
+    }
+
+    it = it_create(stmt, row2change);
+    if (!it) {
+        sqlite3_finalize(stmt);
+        return NULL;
+    }
+
+    return it;
+}
+
+static
+void cmt_thread_dtor(void *obj)
+{
+    CmtThreadInfo *ti = (CmtThreadInfo *)obj;
+    size_t i;
+
+    deref(ti->cinfo);
+    for (i = 0; i < ti->nreplies; i++)
+        deref(ti->replies[i]);
+}
+
+static
+CmtThreadInfo *cmt_thread_from_row(DBObjIt *it)
+{
+    CmtThreadInfo *ti;
+    CmtInfo *ci;
+    int rc;
+
+    ti = (CmtThreadInfo *)rc_zalloc(sizeof(CmtThreadInfo) +
+                                    it->max_replies * sizeof(CmtInfo *), cmt_thread_dtor);
+    if (!ti) {
+        vlogE(TAG_DB "OOM");
+        return NULL;
+    }
+
+    ti->replies = (CmtInfo **)(ti + 1);
+    ti->cinfo = cmt_from_row(it->stmt, 0, it->fields);
+    if (!ti->cinfo)
+        goto failure;
+
+    sqlite3_reset(it->replies_cnt);
+    rc = sqlite3_bind_int64(it->replies_cnt,
+                            sqlite3_bind_parameter_index(it->replies_cnt, ":parent"),
+                            ti->cinfo->cmt_id);
+    if (SQLITE_OK != rc || SQLITE_ROW != sqlite3_step(it->replies_cnt)) {
+        vlogE(TAG_DB "Counting replies failed");
+        goto failure;
+    }
+    ti->replies_cnt = sqlite3_column_int64(it->replies_cnt, 0);
+
+    if (!ti->replies_cnt || !it->max_replies)
+        return ti;
+
+    sqlite3_reset(it->replies);
+    rc = sqlite3_bind_int64(it->replies,
+                            sqlite3_bind_parameter_index(it->replies, ":parent"),
+                            ti->cinfo->cmt_id);
+    if (SQLITE_OK != rc) {
+        vlogE(TAG_DB "Binding parameter parent failed");
+        goto failure;
+    }
+
+    while (ti->nreplies < it->max_replies && SQLITE_ROW == (rc = sqlite3_step(it->replies))) {
+        ci = cmt_from_row(it->replies, 0, it->fields);
+        if (!ci)
+            goto failure;
+        ti->replies[ti->nreplies++] = ci;
+    }
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+        vlogE(TAG_DB "sqlite3_step() failed");
+        goto failure;
+    }
+
+    return ti;
+
+failure:
+    deref(ti);
+    return NULL;
+}
+
+/*
+ * Comments replying to parent (0 for the top level) after the comment
+ * after, oldest first. Each comes with its first max_replies replies and
+ * the number of all of them, all three looked up by seeks on
+ * (channel_id, post_id, refcomment_id, comment_id).
+ */
+DBObjIt *db_iter_cmt_thread(uint64_t chan_id, uint64_t post_id, uint64_t parent,
+                            uint64_t after, uint64_t maxcnt, uint64_t max_replies,
+                            uint64_t fields)
+{
+    sqlite3_stmt *stmts[3] = {NULL, NULL, NULL};
+    char sql[1024] = {0};
+    DBObjIt *it;
+    size_t i;
+    int rc;
+
+    // the page of comments
+    rc = sprintf_cmts_select(sql, fields);
+    rc += sprintf(sql + rc, "  WHERE channel_id = :channel_id AND post_id = :post_id"
+                            "    AND refcomment_id = :parent AND comment_id > :after"
+                            "  ORDER BY comment_id ASC");
+    if (maxcnt)
+        rc += sprintf(sql + rc, " LIMIT :maxcnt");
+    if (SQLITE_OK != sqlite3_prepare_v2(db, sql, -1, &stmts[0], NULL))
+        goto prepare_failed;
+
+    // the first replies to one of them
+    rc = sprintf_cmts_select(sql, fields);
+    rc += sprintf(sql + rc, "  WHERE channel_id = :channel_id AND post_id = :post_id"
+                            "    AND refcomment_id = :parent"
+                            "  ORDER BY comment_id ASC LIMIT :max_replies");
+    if (SQLITE_OK != sqlite3_prepare_v2(db, sql, -1, &stmts[1], NULL))
+        goto prepare_failed;
+
+    // and the number of all its replies
+    if (SQLITE_OK != sqlite3_prepare_v2(db,
+                                        "SELECT count(*) FROM comments"
+                                        "  WHERE channel_id = :channel_id AND post_id = :post_id"
+                                        "    AND refcomment_id = :parent",
+                                        -1, &stmts[2], NULL))
+        goto prepare_failed;
+
+    rc = SQLITE_OK;
+    for (i = 0; i < 3; i++) {
+        rc |= sqlite3_bind_int64(stmts[i], sqlite3_bind_parameter_index(stmts[i], ":channel_id"),
+                                 chan_id);
+        rc |= sqlite3_bind_int64(stmts[i], sqlite3_bind_parameter_index(stmts[i], ":post_id"),
+                                 post_id);
+    }
+    rc |= sqlite3_bind_int64(stmts[0], sqlite3_bind_parameter_index(stmts[0], ":parent"),
+                             parent);
+    rc |= sqlite3_bind_int64(stmts[0], sqlite3_bind_parameter_index(stmts[0], ":after"),
+                             after);
+    if (maxcnt) {
+        rc |= sqlite3_bind_int64(stmts[0], sqlite3_bind_parameter_index(stmts[0], ":maxcnt"),
+                                 maxcnt);
+    }
+    rc |= sqlite3_bind_int64(stmts[1], sqlite3_bind_parameter_index(stmts[1], ":max_replies"),
+                             max_replies);
+    if (SQLITE_OK != rc) {
+        vlogE(TAG_DB "Binding parameter post_id failed");
+        goto failure;
+    }
+
+    it = it_create(stmts[0], NULL);
+    if (!it)
+        goto failure;
+
+    it->replies     = stmts[1];
+    it->replies_cnt = stmts[2];
+    it->max_replies = max_replies;
+    it->fields      = fields;
+
+    return it;
+
+prepare_failed:
+    vlogE(TAG_DB "sqlite3_prepare_v2() failed");
+failure:
+    for (i = 0; i < 3; i++)
+        sqlite3_finalize(stmts[i]);
+    return NULL;
+}
+
+/*
+ * Heap order of the merged timeline sources, the source holding the
+ * newest post by (created_at, channel_id, post_id) comes out first.
+ */
+static
+bool timeline_older(sqlite3_stmt *a, sqlite3_stmt *b)
+{
+    uint64_t at_a = sqlite3_column_int64(a, 7);
+    uint64_t at_b = sqlite3_column_int64(b, 7);
+    uint64_t chan_a = sqlite3_column_int64(a, 0);
+    uint64_t chan_b = sqlite3_column_int64(b, 0);
+
+    if (at_a != at_b)
+        return at_a < at_b;
+    if (chan_a != chan_b)
+        return chan_a < chan_b;
+    return sqlite3_column_int64(a, 1) < sqlite3_column_int64(b, 1);
+}
+
+/*
+ * Home timeline of a user: one index range scan per subscribed channel,
+ * newest first, merged on the fly so no more than maxcnt posts are ever
+ * read from each channel and nothing is sorted.
+ */
+DBObjIt *db_iter_timeline(uint64_t uid, const TimelineKey *before,
+                          uint64_t maxcnt, uint64_t fields)
+{
+    std::vector<uint64_t> chan_ids;
+    sqlite3_stmt *stmt;
+    char sql[1024] = {0};
+    DBObjIt *it;
+    int rc;
+
+    rc = sqlite3_prepare_v2(db, "SELECT channel_id FROM subscriptions WHERE user_id = :uid",
+                            -1, &stmt, NULL);
+    if (SQLITE_OK != rc) {
+        vlogE(TAG_DB "sqlite3_prepare_v2() failed");
+        return NULL;
+    }
+
+    rc = sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, ":uid"), uid);
+    if (SQLITE_OK != rc) {
+        vlogE(TAG_DB "Binding parameter uid failed");
+        sqlite3_finalize(stmt);
+        return NULL;
+    }
+
+    while (SQLITE_ROW == (rc = sqlite3_step(stmt)))
+        chan_ids.push_back(sqlite3_column_int64(stmt, 0));
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        vlogE(TAG_DB "sqlite3_step() failed");
+        return NULL;
+    }
+
+    it = (DBObjIt *)rc_zalloc(sizeof(DBObjIt), it_dtor);
+    if (!it)
+        return NULL;
+
+    it->fields = fields;
+    it->left   = maxcnt ? maxcnt : UINT64_MAX;
+    it->srcs   = (sqlite3_stmt **)calloc(chan_ids.size() + 1, sizeof(sqlite3_stmt *));
+    if (!it->srcs) {
+        deref(it);
+        return NULL;
+    }
+
+    rc = sprintf(sql,
+                 "SELECT channel_id, post_id, status, %s,"
+                 "       next_comment_id - 1 AS comments, likes, created_at,"
+                 "       updated_at, %s, %s, %s, %s"
+                 "  FROM posts "
+                 "  WHERE channel_id = :channel_id",
+                 proj_cols(fields, PROJ_CONTENT, "content, length(content)", PROJ_NO_BLOB),
+                 proj_cols(fields, PROJ_HASH_ID, "hash_id", PROJ_NO_TEXT),
+                 proj_cols(fields, PROJ_PROOF, "proof", PROJ_NO_TEXT),
+                 proj_cols(fields, PROJ_ORIGIN_URL, "origin_post_url", PROJ_NO_TEXT),
+                 proj_cols(fields, PROJ_THUMBNAILS, "thumbnails, length(thumbnails)", PROJ_NO_BLOB));
+    rc += sprintf(sql + rc, " AND (status=%d OR status=%d)", POST_AVAILABLE, POST_DELETED);
+    if (before->created_at)
+        rc += sprintf(sql + rc, " AND created_at <= :at AND (created_at < :at"
+                                " OR channel_id < :chan OR (channel_id = :chan AND post_id < :post))");
+    rc += sprintf(sql + rc, " ORDER BY created_at DESC, post_id DESC");
+    if (maxcnt)
+        rc += sprintf(sql + rc, " LIMIT :maxcnt");
+
+    for (uint64_t chan_id : chan_ids) {
+        if (SQLITE_OK != sqlite3_prepare_v2(db, sql, -1, &stmt, NULL)) {
+            vlogE(TAG_DB "sqlite3_prepare_v2() failed");
+            deref(it);
+            return NULL;
+        }
+
+        rc = sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, ":channel_id"),
+                                chan_id);
+        if (before->created_at) {
+            rc |= sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, ":at"),
+                                     before->created_at);
+            rc |= sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, ":chan"),
+                                     before->chan_id);
+            rc |= sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, ":post"),
+                                     before->post_id);
+        }
+        if (maxcnt) {
+            rc |= sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, ":maxcnt"),
+                                     maxcnt);
+        }
+        if (SQLITE_OK != rc) {
+            vlogE(TAG_DB "Binding parameter channel_id failed");
+            sqlite3_finalize(stmt);
+            deref(it);
+            return NULL;
+        }
+
+        it->srcs[it->cap++] = stmt;
+        rc = sqlite3_step(stmt);
+        if (rc == SQLITE_ROW) {
+            std::swap(it->srcs[it->nsrcs++], it->srcs[it->cap - 1]);
+        } else if (rc != SQLITE_DONE) {
+            vlogE(TAG_DB "sqlite3_step() failed");
+            deref(it);
+            return NULL;
+        }
+    }
+
+    std::make_heap(it->srcs, it->srcs + it->nsrcs, timeline_older);
+
+    return it;
+}
+
+static
+int timeline_nxt(DBObjIt *it, void **obj)
+{
+    sqlite3_stmt *top;
+    int rc;
+
+    *obj = NULL;
+    if (!it->nsrcs || !it->left)
+        return 1;
+
+    std::pop_heap(it->srcs, it->srcs + it->nsrcs, timeline_older);
+    top = it->srcs[it->nsrcs - 1];
+
+    *obj = post_from_row(top, 0, it->fields);
+    if (!*obj)
+        return -1;
+    it->left--;
+
+    rc = sqlite3_step(top);
+    if (rc == SQLITE_ROW) {
+        std::push_heap(it->srcs, it->srcs + it->nsrcs, timeline_older);
+    } else if (rc == SQLITE_DONE) {
+        it->nsrcs--;
+    } else {
+        vlogE(TAG_DB "sqlite3_step() failed");
+        deref(*obj);
+        *obj = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
 int db_iter_nxt(DBObjIt *it, void **obj)
 {
     int rc;
 
+    if (it->srcs)
+        return timeline_nxt(it, obj);
+
     rc = sqlite3_step(it->stmt);
     if (rc != SQLITE_ROW) {
         if (rc != SQLITE_DONE)
@@ -3404,10 +4269,23 @@ int db_iter_nxt(DBObjIt *it, void **obj)
         return rc == SQLITE_DONE ? 1 : -1;
     }
 
-    *obj = it->cb(it->stmt);
+    if (it->replies)
+        *obj = cmt_thread_from_row(it);
+    else if (it->proj_cb) {
+        row_arena = it->arena;
+        *obj = it->proj_cb(it->stmt, it->fields);
+        row_arena = NULL;
+    } else
+        *obj = it->cb(it->stmt);
     return *obj ? 0 : -1;
 }
 
+void db_iter_set_arena(DBObjIt *it, Arena *arena)
+{
+    deref(it->arena);
+    it->arena = arena ? (Arena *)ref(arena) : NULL;
+}
+
 int db_is_suber(uint64_t uid, uint64_t chan_id)
 {
     sqlite3_stmt *stmt;
@@ -3451,6 +4329,11 @@ int db_is_suber(uint64_t uid, uint64_t chan_id)
 
 void db_deinit()
 {
+    std::lock_guard<std::mutex> lock(like_sets_mutex);
+
+    like_sets.clear();
+    like_sets_lru.clear();
+    postcache_clear();
     // sqlite3_close(db);
     // sqlite3_shutdown();
 }
@@ -28,6 +28,7 @@
 
 #include <sqlite3.h>
 
+#include "arena.h"
 #include "obj.h"
 
 #ifdef __cplusplus
@@ -60,6 +61,12 @@ int db_unsub(uint64_t uid, uint64_t channel_id);
 int db_update_user_info(const UserInfo *ui);
 int db_upsert_user(const UserInfo *ui, uint64_t *uid);
 int db_iter_nxt(DBObjIt *it, void **obj);
+/*
+ * Rows of db_iter_posts() and db_iter_cmts() are taken from arena once it is
+ * set. They are borrowed then, never ref() or deref() them, and they live as
+ * long as the arena.
+ */
+void db_iter_set_arena(DBObjIt *it, Arena *arena);
 DBObjIt *db_iter_chans(const QryCriteria *qc);
 DBObjIt *db_iter_sub_chans(uint64_t uid, const QryCriteria *qc);
 DBObjIt *db_iter_posts(uint64_t chan_id, const QryCriteria *qc);
@@ -68,6 +75,13 @@ DBObjIt *db_iter_liked_posts(uint64_t uid, const QryCriteria *qc);
 DBObjIt *db_iter_liked_data(uint64_t uid, const QryCriteria *qc);
 DBObjIt *db_iter_cmts(uint64_t chan_id, uint64_t post_id, const QryCriteria *qc);
 DBObjIt *db_iter_cmts_likes(uint64_t chan_id, uint64_t post_id, const QryCriteria *qc);
+// changes of a channel after cursor, oldest first.
+DBObjIt *db_iter_changes(uint64_t chan_id, uint64_t cursor, uint64_t maxcnt);
+DBObjIt *db_iter_timeline(uint64_t uid, const TimelineKey *before,
+                          uint64_t maxcnt, uint64_t fields);
+DBObjIt *db_iter_cmt_thread(uint64_t chan_id, uint64_t post_id, uint64_t parent,
+                            uint64_t after, uint64_t maxcnt, uint64_t max_replies,
+                            uint64_t fields);
 int db_is_suber(uint64_t uid, uint64_t chan_id);
 int db_get_owner(UserInfo **ui);
 int db_need_upsert_user(const char *did);
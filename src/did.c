@@ -54,7 +54,6 @@ DIDDocument *feeds_doc;
 char *feeds_storepass;
 Credential *feeds_vc;
 
-static char qrcode_path[PATH_MAX];
 static DIDStore *feeds_didstore;
 static DID *feeds_did;
 static char nonce_str[NONCE_BYTES << 1];
@@ -70,6 +69,19 @@ static pthread_mutex_t http_mutex = PTHREAD_MUTEX_INITIALIZER;
 static bool http_is_running;
 static pthread_t http_tid;
 
+typedef struct {
+    unsigned char *data;
+    size_t sz;
+    size_t cap;
+} PngBuf;
+
+// rendered once per feeds_url, guarded by qrcode_mutex along with feeds_url.
+static pthread_mutex_t qrcode_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char qrcode_url[sizeof(feeds_url)];
+static char qrcode_json[sizeof(feeds_url) + 16];
+static size_t qrcode_json_len;
+static PngBuf qrcode_png;
+
 typedef struct {
     UserInfo info;
     char did_buf[ELA_MAX_DID_LEN];
@@ -112,6 +124,8 @@ void gen_feeds_url()
 {
     int rc;
 
+    pthread_mutex_lock(&qrcode_mutex);
+
     rc = sprintf(feeds_url, "%s://", state >= VC_ISSED ? "feeds" : "feeds_raw");
 
     if (state >= DID_IMPED)
@@ -124,14 +138,39 @@ void gen_feeds_url()
         sprintf(feeds_url + strlen(feeds_url), "/%s", nonce_str);
 
     vlogI(TAG_AUTH "Generate feeds URL: %s", feeds_url);
+
+    pthread_mutex_unlock(&qrcode_mutex);
+}
+
+static
+void png_buf_write(png_structp png_ptr, png_bytep data, png_size_t len)
+{
+    PngBuf *buf = (PngBuf *)png_get_io_ptr(png_ptr);
+
+    if (buf->sz + len > buf->cap) {
+        size_t cap = buf->cap ? buf->cap : 4096;
+        unsigned char *tmp;
+
+        while (cap < buf->sz + len)
+            cap <<= 1;
+
+        tmp = realloc(buf->data, cap);
+        if (!tmp)
+            png_error(png_ptr, "OOM");
+
+        buf->data = tmp;
+        buf->cap = cap;
+    }
+
+    memcpy(buf->data + buf->sz, data, len);
+    buf->sz += len;
 }
 
 #define INCHES_PER_METER (100.0/2.54)
 static
-int qrencode(const char *intext, const char *outfile)
+int qrencode(const char *intext, PngBuf *out)
 {
     QRcode *qrcode;
-    static FILE *fp; // avoid clobbering by setjmp.
     png_structp png_ptr;
     png_infop info_ptr;
     png_colorp palette = NULL;
@@ -157,18 +196,9 @@ int qrencode(const char *intext, const char *outfile)
         return -1;
     }
 
-    fp = fopen(outfile, "wb");
-    if (fp == NULL) {
-        vlogE(TAG_AUTH "Failed to create file: %s", outfile);
-        free(row);
-        QRcode_free(qrcode);
-        return -1;
-    }
-
     png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
     if (png_ptr == NULL) {
         vlogE(TAG_AUTH "Failed to initialize PNG writer.");
-        fclose(fp);
         free(row);
         QRcode_free(qrcode);
         return -1;
@@ -178,7 +208,6 @@ int qrencode(const char *intext, const char *outfile)
     if (info_ptr == NULL) {
         vlogE(TAG_AUTH "Failed to initialize PNG write.");
         png_destroy_write_struct(&png_ptr, NULL);
-        fclose(fp);
         free(row);
         QRcode_free(qrcode);
         return -1;
@@ -187,7 +216,8 @@ int qrencode(const char *intext, const char *outfile)
     if (setjmp(png_jmpbuf(png_ptr))) {
         vlogE(TAG_AUTH "Failed to write PNG image.");
         png_destroy_write_struct(&png_ptr, &info_ptr);
-        fclose(fp);
+        free(out->data);
+        out->data = NULL;
         free(row);
         QRcode_free(qrcode);
         return -1;
@@ -197,7 +227,6 @@ int qrencode(const char *intext, const char *outfile)
     if (palette == NULL) {
         vlogE(TAG_AUTH "Failed to allocate memory.");
         png_destroy_write_struct(&png_ptr, &info_ptr);
-        fclose(fp);
         free(row);
         QRcode_free(qrcode);
         return -1;
@@ -213,7 +242,7 @@ int qrencode(const char *intext, const char *outfile)
     png_set_PLTE(png_ptr, info_ptr, palette, 2);
     png_set_tRNS(png_ptr, info_ptr, alpha_values, 2, NULL);
 
-    png_init_io(png_ptr, fp);
+    png_set_write_fn(png_ptr, out, png_buf_write, NULL);
     png_set_IHDR(png_ptr, info_ptr,
                  realwidth, realwidth,
                  1,
@@ -265,13 +294,35 @@ int qrencode(const char *intext, const char *outfile)
 
     free(palette);
     png_destroy_write_struct(&png_ptr, &info_ptr);
-    fclose(fp);
     free(row);
     QRcode_free(qrcode);
 
     return 0;
 }
 
+// called with qrcode_mutex held.
+static
+int qrcode_refresh()
+{
+    PngBuf png = {NULL, 0, 0};
+    int rc;
+
+    if (strcmp(qrcode_url, feeds_url) == 0)
+        return 0;
+
+    qrcode_json_len = sprintf(qrcode_json, "{\"feedsURL\":\"%s\"}", feeds_url);
+
+    rc = qrencode(feeds_url, &png);
+    if (rc < 0)
+        return -1;
+
+    free(qrcode_png.data);
+    qrcode_png = png;
+    strcpy(qrcode_url, feeds_url);
+
+    return 0;
+}
+
 static
 int hdl_http_req(sb_Event *ev)
 {
@@ -281,9 +332,13 @@ int hdl_http_req(sb_Event *ev)
     if (ev->type != SB_EV_REQUEST)
         return SB_RES_OK;
 
+    pthread_mutex_lock(&qrcode_mutex);
+
     vlogI(TAG_AUTH "Received HTTP request to path[%s]", ev->path);
     vlogI(TAG_AUTH "Return HTTP response: %s", feeds_url);
 
+    rc = qrcode_refresh();
+
     if (strcmp(ev->path, "/qrcode") == 0) {
         rc = sb_send_header(ev->stream, "Content-Type", "text/json");
         if (rc < 0) {
@@ -291,20 +346,17 @@ int hdl_http_req(sb_Event *ev)
             goto finally;
         }
 
-        char buf[2496];
-        memset(buf, 0, sizeof(buf));
-        sprintf(buf, "{\"feedsURL\":\"%s\"}", feeds_url);
-        vlogD(TAG_AUTH "feedsURL: %s, len:%d\n", buf, strlen(buf));
+        vlogD(TAG_AUTH "feedsURL: %s, len:%zu\n", qrcode_json, qrcode_json_len);
 
-        rc = sb_write(ev->stream, buf, strlen(buf));
+        rc = sb_write(ev->stream, qrcode_json, qrcode_json_len);
         if (rc < 0) {
             vlogE(TAG_AUTH "Sending QRcode failed");
             goto finally;
         }
+        pthread_mutex_unlock(&qrcode_mutex);
         return SB_RES_OK;
     }
 
-    rc = qrencode(feeds_url, qrcode_path);
     if (rc < 0)
         goto finally;
 
@@ -314,7 +366,7 @@ int hdl_http_req(sb_Event *ev)
         goto finally;
     }
 
-    rc = sb_send_file(ev->stream, qrcode_path);
+    rc = sb_write(ev->stream, qrcode_png.data, qrcode_png.sz);
     if (rc < 0) {
         vlogE(TAG_AUTH "Sending HTTP body failed.");
         goto finally;
@@ -323,9 +375,9 @@ int hdl_http_req(sb_Event *ev)
     status = 200;
 
 finally:
-    sb_send_status(ev->stream, status, status == 200 ? "OK" : "Internal Server Error");
+    pthread_mutex_unlock(&qrcode_mutex);
 
-    remove(qrcode_path);
+    sb_send_status(ev->stream, status, status == 200 ? "OK" : "Internal Server Error");
 
     return SB_RES_OK;
 }
@@ -432,6 +484,10 @@ void did_deinit()
         DIDStore_Close(feeds_didstore);
 
     oinfo_clear();
+
+    free(qrcode_png.data);
+    memset(&qrcode_png, 0, sizeof(qrcode_png));
+    qrcode_url[0] = '\0';
 }
 
 static
@@ -503,8 +559,6 @@ int did_init(FeedsConfig *cfg)
     UserInfo *ui = NULL;
     int rc;
 
-    sprintf(qrcode_path, "%s/qrcode.png", cfg->data_dir);
-
     crypto_random_nonce(nonce);
     crypto_nonce_to_str(nonce, nonce_str, sizeof(nonce_str));
 
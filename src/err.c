@@ -37,7 +37,8 @@ static struct {
     {ERR_INVALID_VC       , "Invalid Verifiable Credential"   },
     {ERR_UNKNOWN_METHOD   , "Unsupported Method"              },
     {ERR_DB_ERROR         , "Database error"                  },
-    {ERR_MAX_FEEDS_LIMIT  , "Exceeded the max number of feeds"}
+    {ERR_MAX_FEEDS_LIMIT  , "Exceeded the max number of feeds"},
+    {ERR_RATE_LIMITED     , "Too Many Requests"               }
 };
 
 const char *err_strerror(int rc)
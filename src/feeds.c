@@ -23,7 +23,9 @@
 #include <crystal.h>
 #include <inttypes.h>
 
+#include "arena.h"
 #include "feeds.h"
+#include "flatmap.h"
 #include "msgq.h"
 #include "auth.h"
 #include "did.h"
@@ -39,48 +41,40 @@ extern size_t connecting_clients;
 
 typedef struct {
     linked_hash_entry_t he_name_key;
-    linked_hash_entry_t he_id_key;
     linked_list_t *aspcs;
+    Marshalled *packed;  // info as a get_channels item, repacked on each change
+    uint64_t tag;  // chan_tag() of info
     ChanInfo info;
 } Chan;
 
 typedef struct {
-    linked_hash_entry_t he;
-    linked_hashtable_t *aspcs;
-    linked_hashtable_t *ndpass;
+    FlatMap aspcs;   // by channel id
+    FlatMap ndpass;  // by peer
     uint64_t uid;
 } ActiveSuber;
 
 typedef struct {
     linked_list_entry_t le;
-    linked_hash_entry_t he;
     const Chan *chan;
-    const ActiveSuber *as;
+    ActiveSuber *as;
 } ActiveSuberPerChan;
 
 typedef struct {
-    linked_hash_entry_t he;
-    char node_id[ELA_MAX_ID_LEN + 1];
+    PeerId peer;
     linked_list_t *ndpass;
 } NotifDest;
 
 typedef struct {
-    linked_hash_entry_t he;
     linked_list_entry_t le;
     ActiveSuber *as;
     NotifDest *nd;
 } NotifDestPerActiveSuber;
 
 static uint64_t nxt_chan_id = CHAN_ID_START;
-static linked_hashtable_t *ass;
-static linked_hashtable_t *nds;
+static FlatMap ass;
+static FlatMap nds;
 static linked_hashtable_t *chans_by_name;
-static linked_hashtable_t *chans_by_id;
-
-#define hashtable_foreach(htab, entry)                                \
-    for (linked_hashtable_iterate((htab), &it);                              \
-         linked_hashtable_iterator_next(&it, NULL, NULL, (void **)&(entry)); \
-         deref((entry)))
+static FlatMap chans_by_id;
 
 #define list_foreach(list, entry)                    \
     for (linked_list_iterate((list), &it);                  \
@@ -90,18 +84,33 @@ static linked_hashtable_t *chans_by_id;
 #define foreach_db_obj(entry) \
     for (;!(rc = db_iter_nxt(it, (void **)&entry)); deref(entry))
 
+// rows of an iterator bound to an arena are borrowed.
+#define foreach_arena_obj(entry) \
+    for (;!(rc = db_iter_nxt(it, (void **)&entry));)
+
+static
+void chan_pack(Chan *chan)
+{
+    deref(chan->packed);
+    chan->tag    = chan_tag(&chan->info);
+    chan->packed = rpc_pack_chan(&chan->info);
+    if (!chan->packed)
+        vlogE(TAG_CMD "Packing channel [%" PRIu64 "] failed.", chan->info.chan_id);
+}
+
 static inline
 Chan *chan_put(Chan *chan)
 {
+    chan_pack(chan);
     linked_hashtable_put(chans_by_name, &chan->he_name_key);
-    return linked_hashtable_put(chans_by_id, &chan->he_id_key);
+    return flatmap_put(&chans_by_id, chan->info.chan_id, chan);
 }
 
 static inline
 Chan *chan_rm(Chan *chan)
 {
     deref(linked_hashtable_remove(chans_by_name, chan->info.name, strlen(chan->info.name)));
-    return linked_hashtable_remove(chans_by_id, &chan->info.chan_id, sizeof(chan->info.chan_id));
+    return flatmap_remove(&chans_by_id, chan->info.chan_id);
 }
 
 static inline
@@ -114,17 +123,9 @@ Chan *chan_sub(Chan *upd, Chan *old)
 
     list_foreach(upd->aspcs, aspc)
         aspc->chan = upd;
+    chan_pack(upd);
     linked_hashtable_put(chans_by_name, &upd->he_name_key);
-    return linked_hashtable_put(chans_by_id, &upd->he_id_key);
-}
-
-static
-int u64_cmp(const void *key1, size_t len1, const void *key2, size_t len2)
-{
-    assert(key1 && sizeof(uint64_t) == len1);
-    assert(key2 && sizeof(uint64_t) == len2);
-
-    return memcmp(key1, key2, sizeof(uint64_t));
+    return flatmap_put(&chans_by_id, upd->info.chan_id, upd);
 }
 
 static
@@ -133,6 +134,7 @@ void chan_dtor(void *obj)
     Chan *chan = obj;
 
     deref(chan->aspcs);
+    deref(chan->packed);
 }
 
 static
@@ -169,10 +171,6 @@ Chan *chan_create(const ChanInfo *ci)
     chan->he_name_key.key    = chan->info.name;
     chan->he_name_key.keylen = strlen(chan->info.name);
 
-    chan->he_id_key.data   = chan;
-    chan->he_id_key.key    = &chan->info.chan_id;
-    chan->he_id_key.keylen = sizeof(chan->info.chan_id);
-
     return chan;
 }
 
@@ -206,10 +204,6 @@ Chan *chan_create_upd(const Chan *from, const ChanInfo *ci)
     chan->he_name_key.key    = chan->info.name;
     chan->he_name_key.keylen = strlen(chan->info.name);
 
-    chan->he_id_key.data   = chan;
-    chan->he_id_key.key    = &chan->info.chan_id;
-    chan->he_id_key.keylen = sizeof(chan->info.chan_id);
-
     return chan;
 }
 
@@ -260,20 +254,20 @@ int feeds_init(FeedsConfig *cfg)
         goto failure;
     }
 
-    chans_by_id = linked_hashtable_create(8, 0, NULL, u64_cmp);
-    if (!chans_by_id) {
+    rc = flatmap_init(&chans_by_id, 0);
+    if (rc < 0) {
         vlogE(TAG_CMD"Creating channels by id failed");
         goto failure;
     }
 
-    ass = linked_hashtable_create(8, 0, NULL, u64_cmp);
-    if (!ass) {
+    rc = flatmap_init(&ass, 0);
+    if (rc < 0) {
         vlogE(TAG_CMD "Creating active subscribers failed");
         goto failure;
     }
 
-    nds = linked_hashtable_create(8, 0, NULL, NULL);
-    if (!nds) {
+    rc = flatmap_init(&nds, 0);
+    if (rc < 0) {
         vlogE(TAG_CMD "Creating notification destinations failed");
         goto failure;
     }
@@ -293,13 +287,13 @@ failure:
 void feeds_deinit()
 {
     deref(chans_by_name);
-    deref(chans_by_id);
-    deref(ass);
-    deref(nds);
+    flatmap_deinit(&chans_by_id);
+    flatmap_deinit(&ass);
+    flatmap_deinit(&nds);
 }
 
 static
-void notify_of_chan_upd(const char *peer, const ChanInfo *ci)
+void notify_of_chan_upd(PeerId peer, const ChanInfo *ci)
 {
     ChanUpdNotif notif = {
         .method = "feedinfo_update",
@@ -313,13 +307,13 @@ void notify_of_chan_upd(const char *peer, const ChanInfo *ci)
     if (!notif_marshal)
         return;
 
-    vlogD(TAG_CMD "Sending channel update notification to [%s]: {channel_id: %" PRIu64 "}", peer, ci->chan_id);
-    msgq_enq(peer, notif_marshal);
+    vlogD(TAG_CMD "Sending channel update notification to [%s]: {channel_id: %" PRIu64 "}", peer_name(peer), ci->chan_id);
+    msgq_enq_peer(peer, notif_marshal);
     deref(notif_marshal);
 }
 
 static
-void notify_of_new_post(const char *peer, const PostInfo *pi)
+void notify_of_new_post(PeerId peer, const PostInfo *pi)
 {
     NewPostNotif notif = {
         .method = "new_post",
@@ -334,13 +328,13 @@ void notify_of_new_post(const char *peer, const PostInfo *pi)
         return;
 
     vlogD(TAG_CMD "Sending new post notification to [%s]: " "{channel_id: %" PRIu64 ", post_id: %" PRIu64 "}",
-          peer, pi->chan_id, pi->post_id);
-    msgq_enq(peer, notif_marshal);
+          peer_name(peer), pi->chan_id, pi->post_id);
+    msgq_enq_peer(peer, notif_marshal);
     deref(notif_marshal);
 }
 
 static
-void notify_of_post_upd(const char *peer, const PostInfo *pi)
+void notify_of_post_upd(PeerId peer, const PostInfo *pi)
 {
     PostUpdNotif notif = {
         .method = "post_update",
@@ -358,14 +352,14 @@ void notify_of_post_upd(const char *peer, const PostInfo *pi)
           "{channel_id: %" PRIu64 ", post_id: %" PRIu64 ", status: %s, content_len: %zu"
           ", comments: %" PRIu64 ", likes: %" PRIu64 ", created_at: %" PRIu64
           ", updated_at: %" PRIu64 "}",
-          peer, pi->chan_id, pi->post_id, post_stat_str(pi->stat), pi->con_len, pi->cmts,
+          peer_name(peer), pi->chan_id, pi->post_id, post_stat_str(pi->stat), pi->con_len, pi->cmts,
           pi->likes, pi->created_at, pi->upd_at);
-    msgq_enq(peer, notif_marshal);
+    msgq_enq_peer(peer, notif_marshal);
     deref(notif_marshal);
 }
 
 static
-void notify_of_new_cmt(const char *peer, const CmtInfo *ci)
+void notify_of_new_cmt(PeerId peer, const CmtInfo *ci)
 {
     NewCmtNotif notif = {
         .method = "new_comment",
@@ -382,13 +376,13 @@ void notify_of_new_cmt(const char *peer, const CmtInfo *ci)
     vlogD(TAG_CMD "Sending new comment notification to [%s]: "
           "{channel_id: %" PRIu64 ", post_id: %" PRIu64
           ", comment_id: %" PRIu64 ", refcomment_id: %" PRIu64 "}",
-          peer, ci->chan_id, ci->post_id, ci->cmt_id, ci->reply_to_cmt);
-    msgq_enq(peer, notif_marshal);
+          peer_name(peer), ci->chan_id, ci->post_id, ci->cmt_id, ci->reply_to_cmt);
+    msgq_enq_peer(peer, notif_marshal);
     deref(notif_marshal);
 }
 
 static
-void notify_of_cmt_upd(const char *peer, const CmtInfo *ci)
+void notify_of_cmt_upd(PeerId peer, const CmtInfo *ci)
 {
     CmtUpdNotif notif = {
         .method = "comment_update",
@@ -405,13 +399,13 @@ void notify_of_cmt_upd(const char *peer, const CmtInfo *ci)
     vlogD(TAG_CMD "Sending comment_update notification to [%s]: "
           "{channel_id: %" PRIu64 ", post_id: %" PRIu64
           ", comment_id: %" PRIu64 ", refcomment_id: %" PRIu64 ", status: %s}",
-          peer, ci->chan_id, ci->post_id, ci->cmt_id, ci->reply_to_cmt, cmt_stat_str(ci->stat));
-    msgq_enq(peer, notif_marshal);
+          peer_name(peer), ci->chan_id, ci->post_id, ci->cmt_id, ci->reply_to_cmt, cmt_stat_str(ci->stat));
+    msgq_enq_peer(peer, notif_marshal);
     deref(notif_marshal);
 }
 
 static
-void notify_of_new_like(const char *peer, const LikeInfo *li)
+void notify_of_new_like(PeerId peer, const LikeInfo *li)
 {
     NewLikeNotif notif = {
         .method = "new_like",
@@ -428,13 +422,13 @@ void notify_of_new_like(const char *peer, const LikeInfo *li)
     vlogD(TAG_CMD "Sending new like notification to [%s]: "
           "{channel_id: %" PRIu64 ", post_id: %" PRIu64
           ", comment_id: %" PRIu64 ", user_name: %s, user_did: %s, total_count: %" PRIu64 "}",
-          peer, li->chan_id, li->post_id, li->cmt_id, li->user.name, li->user.did, li->total_cnt);
-    msgq_enq(peer, notif_marshal);
+          peer_name(peer), li->chan_id, li->post_id, li->cmt_id, li->user.name, li->user.did, li->total_cnt);
+    msgq_enq_peer(peer, notif_marshal);
     deref(notif_marshal);
 }
 
 static
-void notify_of_new_sub(const char *peer, const uint64_t chan_id, const UserInfo *uinfo)
+void notify_of_new_sub(PeerId peer, const uint64_t chan_id, const UserInfo *uinfo)
 {
     NewSubNotif notif = {
         .method = "new_subscription",
@@ -451,13 +445,13 @@ void notify_of_new_sub(const char *peer, const uint64_t chan_id, const UserInfo
 
     vlogD(TAG_CMD "Sending new subscription notification to [%s]: "
           "{channel_id: %" PRIu64 ", user_name: %s, user_did: %s}",
-          peer, chan_id, uinfo->name, uinfo->did);
-    msgq_enq(peer, notif_marshal);
+          peer_name(peer), chan_id, uinfo->name, uinfo->did);
+    msgq_enq_peer(peer, notif_marshal);
     deref(notif_marshal);
 }
 
 static
-void notify_of_stats_changed(const char *peer, uint64_t total_clients)
+void notify_of_stats_changed(PeerId peer, uint64_t total_clients)
 {
     StatsChangedNotif notif = {
         .method = "statistics_changed",
@@ -472,13 +466,13 @@ void notify_of_stats_changed(const char *peer, uint64_t total_clients)
         return;
 
     vlogD(TAG_CMD "Sending statistics changed notification to [%s]: " "{total_clients: %" PRIu64 "}",
-          peer, total_clients);
-    msgq_enq(peer, notif_marshal);
+          peer_name(peer), total_clients);
+    msgq_enq_peer(peer, notif_marshal);
     deref(notif_marshal);
 }
 
 static
-void notify_of_report_cmt(const char *peer, const ReportedCmtInfo *li)
+void notify_of_report_cmt(PeerId peer, const ReportedCmtInfo *li)
 {
     ReportCmtNotif notif = {
         .method = "report_illegal_comment",
@@ -495,9 +489,9 @@ void notify_of_report_cmt(const char *peer, const ReportedCmtInfo *li)
     vlogD(TAG_CMD "Sending new like notification to [%s]: "
           "{channel_id: %" PRIu64 ", post_id: %" PRIu64 ", comment_id: %" PRIu64
           ", reporter_name: %s, reporter_did: %s, reasons: %s created_at: %" PRIu64 "}",
-          peer, li->chan_id, li->post_id, li->cmt_id,
+          peer_name(peer), li->chan_id, li->post_id, li->cmt_id,
           li->reporter.name, li->reporter.did, li->reasons, li->created_at);
-    msgq_enq(peer, notif_marshal);
+    msgq_enq_peer(peer, notif_marshal);
     deref(notif_marshal);
 }
 
@@ -506,8 +500,8 @@ void as_dtor(void *obj)
 {
     ActiveSuber *as = obj;
 
-    deref(as->aspcs);
-    deref(as->ndpass);
+    flatmap_deinit(&as->aspcs);
+    flatmap_deinit(&as->ndpass);
 }
 
 static
@@ -519,28 +513,18 @@ ActiveSuber *as_create(uint64_t uid)
     if (!as)
         return NULL;
 
-    as->aspcs = linked_hashtable_create(8, 0, NULL, u64_cmp);
-    if (!as->aspcs) {
-        deref(as);
-        return NULL;
-    }
-
-    as->ndpass = linked_hashtable_create(8, 0, NULL, NULL);
-    if (!as->ndpass) {
+    if (flatmap_init(&as->aspcs, 0) < 0 || flatmap_init(&as->ndpass, 0) < 0) {
         deref(as);
         return NULL;
     }
 
-    as->uid       = uid;
-    as->he.data   = as;
-    as->he.key    = &as->uid;
-    as->he.keylen = sizeof(as->uid);
+    as->uid = uid;
 
     return as;
 }
 
 static
-ActiveSuberPerChan *aspc_create(const ActiveSuber *as, const Chan *chan)
+ActiveSuberPerChan *aspc_create(ActiveSuber *as, const Chan *chan)
 {
     ActiveSuberPerChan *aspc;
 
@@ -551,10 +535,6 @@ ActiveSuberPerChan *aspc_create(const ActiveSuber *as, const Chan *chan)
     aspc->chan = chan;
     aspc->as   = as;
 
-    aspc->he.data = aspc;
-    aspc->he.key = &aspc->chan->info.chan_id;
-    aspc->he.keylen = sizeof(aspc->chan->info.chan_id);
-
     aspc->le.data = aspc;
 
     return aspc;
@@ -569,69 +549,73 @@ int chan_exist_by_name(const char *name)
 static inline
 Chan *chan_get_by_id(uint64_t id)
 {
-    return linked_hashtable_get(chans_by_id, &id, sizeof(id));
+    // the caller keeps its reference, chan_sub() may replace the channel meanwhile.
+    Chan *chan = flatmap_get(&chans_by_id, id);
+    return chan ? ref(chan) : NULL;
 }
 
 static inline
 int chan_exist_by_id(uint64_t id)
 {
-    return linked_hashtable_exist(chans_by_id, &id, sizeof(id));
+    return flatmap_get(&chans_by_id, id) != NULL;
 }
 
 static inline
 ActiveSuber *as_get(uint64_t uid)
 {
-    return linked_hashtable_get(ass, &uid, sizeof(uid));
+    ActiveSuber *as = flatmap_get(&ass, uid);
+    return as ? ref(as) : NULL;
 }
 
 static inline
 ActiveSuber *as_remove(uint64_t uid)
 {
-    return linked_hashtable_remove(ass, &uid, sizeof(uid));
+    return flatmap_remove(&ass, uid);
 }
 
 static inline
 ActiveSuber *as_put(ActiveSuber *as)
 {
-    return linked_hashtable_put(ass, &as->he);
+    return flatmap_put(&ass, as->uid, as);
 }
 
 static inline
-NotifDest *nd_get(const char *node_id)
+NotifDest *nd_get(PeerId peer)
 {
-    return linked_hashtable_get(nds, node_id, strlen(node_id));
+    NotifDest *nd = flatmap_get(&nds, peer);
+    return nd ? ref(nd) : NULL;
 }
 
 static inline
 NotifDest *nd_put(NotifDest *nd)
 {
-    return linked_hashtable_put(nds, &nd->he);
+    return flatmap_put(&nds, nd->peer, nd);
 }
 
 static inline
-NotifDest *nd_remove(const char *node_id)
+NotifDest *nd_remove(PeerId peer)
 {
-    return linked_hashtable_remove(nds, node_id, strlen(node_id));
+    return flatmap_remove(&nds, peer);
 }
 
 static inline
-int ndpas_exist(ActiveSuber *as, const char *node_id)
+int ndpas_exist(ActiveSuber *as, PeerId peer)
 {
-    return linked_hashtable_exist(as->ndpass, node_id, strlen(node_id));
+    return flatmap_get(&as->ndpass, peer) != NULL;
 }
 
 static inline
 NotifDestPerActiveSuber *ndpas_put(NotifDestPerActiveSuber *ndpas)
 {
     linked_list_add(ndpas->nd->ndpass, &ndpas->le);
-    return linked_hashtable_put(ndpas->as->ndpass, &ndpas->he);
+    return flatmap_put(&ndpas->as->ndpass, ndpas->nd->peer, ndpas);
 }
 
 static inline
 ActiveSuberPerChan *aspc_put(ActiveSuberPerChan *aspc)
 {
     linked_list_add(aspc->chan->aspcs, &aspc->le);
-    return linked_hashtable_put(aspc->as->aspcs, &aspc->he);
+    return flatmap_put(&aspc->as->aspcs, aspc->chan->info.chan_id, aspc);
 }
 
 static inline
@@ -644,7 +628,7 @@ ActiveSuberPerChan *aspc_remove(uint64_t uid, Chan *chan)
     if (!as)
         return NULL;
 
-    aspc = linked_hashtable_remove(as->aspcs, &chan->info.chan_id, sizeof(chan->info.chan_id));
+    aspc = flatmap_remove(&as->aspcs, chan->info.chan_id);
     if (!aspc) {
         deref(as);
         return NULL;
@@ -900,10 +884,10 @@ void hdl_upd_chan_req(Carrier *c, const char *from, Req *base)
 
     list_foreach(chan->aspcs, aspc) {
         NotifDestPerActiveSuber *ndpas;
-        linked_hashtable_iterator_t it;
+        size_t i;
 
-        hashtable_foreach(aspc->as->ndpass, ndpas)
-            notify_of_chan_upd(ndpas->nd->node_id, &ci);
+        flatmap_foreach(&aspc->as->ndpass, i, ndpas)
+            notify_of_chan_upd(ndpas->nd->peer, &ci);
     }
 
 finally:
@@ -1075,10 +1059,10 @@ void hdl_pub_post_req(Carrier *c, const char *from, Req *base)
 
     list_foreach(chan->aspcs, aspc) {
         NotifDestPerActiveSuber *ndpas;
-        linked_hashtable_iterator_t it;
+        size_t i;
 
-        hashtable_foreach(aspc->as->ndpass, ndpas)
-            notify_of_new_post(ndpas->nd->node_id, &new_post);
+        flatmap_foreach(&aspc->as->ndpass, i, ndpas)
+            notify_of_new_post(ndpas->nd->peer, &new_post);
     }
 
 finally:
@@ -1190,10 +1174,10 @@ void hdl_declare_post_req(Carrier *c, const char *from, Req *base)
     if(req->params.with_notify) {
         list_foreach(chan->aspcs, aspc) {
             NotifDestPerActiveSuber *ndpas;
-            linked_hashtable_iterator_t it;
+            size_t i;
 
-            hashtable_foreach(aspc->as->ndpass, ndpas)
-                notify_of_new_post(ndpas->nd->node_id, &new_post);
+            flatmap_foreach(&aspc->as->ndpass, i, ndpas)
+                notify_of_new_post(ndpas->nd->peer, &new_post);
         }
     }
 
@@ -1317,10 +1301,10 @@ void hdl_notify_post_req(Carrier *c, const char *from, Req *base)
 
     list_foreach(chan->aspcs, aspc) {
         NotifDestPerActiveSuber *ndpas;
-        linked_hashtable_iterator_t it;
+        size_t i;
 
-        hashtable_foreach(aspc->as->ndpass, ndpas)
-            notify_of_post_upd(ndpas->nd->node_id, &post_notify);
+        flatmap_foreach(&aspc->as->ndpass, i, ndpas)
+            notify_of_post_upd(ndpas->nd->peer, &post_notify);
     }
 
     deref(post_notify.content);
@@ -1437,10 +1421,10 @@ void hdl_edit_post_req(Carrier *c, const char *from, Req *base)
 
     list_foreach(chan->aspcs, aspc) {
         NotifDestPerActiveSuber *ndpas;
-        linked_hashtable_iterator_t it;
+        size_t i;
 
-        hashtable_foreach(aspc->as->ndpass, ndpas)
-            notify_of_post_upd(ndpas->nd->node_id, &post_mod);
+        flatmap_foreach(&aspc->as->ndpass, i, ndpas)
+            notify_of_post_upd(ndpas->nd->peer, &post_mod);
     }
 
 finally:
@@ -1543,10 +1527,10 @@ void hdl_del_post_req(Carrier *c, const char *from, Req *base)
 
     list_foreach(chan->aspcs, aspc) {
         NotifDestPerActiveSuber *ndpas;
-        linked_hashtable_iterator_t it;
+        size_t i;
 
-        hashtable_foreach(aspc->as->ndpass, ndpas)
-            notify_of_post_upd(ndpas->nd->node_id, &post_del);
+        flatmap_foreach(&aspc->as->ndpass, i, ndpas)
+            notify_of_post_upd(ndpas->nd->peer, &post_del);
     }
 
 finally:
@@ -1669,10 +1653,10 @@ void hdl_post_cmt_req(Carrier *c, const char *from, Req *base)
 
     list_foreach(chan->aspcs, aspc) {
         NotifDestPerActiveSuber *ndpas;
-        linked_hashtable_iterator_t it;
+        size_t i;
 
-        hashtable_foreach(aspc->as->ndpass, ndpas)
-            notify_of_new_cmt(ndpas->nd->node_id, &new_cmt);
+        flatmap_foreach(&aspc->as->ndpass, i, ndpas)
+            notify_of_new_cmt(ndpas->nd->peer, &new_cmt);
     }
 
 finally:
@@ -1818,10 +1802,10 @@ void hdl_edit_cmt_req(Carrier *c, const char *from, Req *base)
 
     list_foreach(chan->aspcs, aspc) {
         NotifDestPerActiveSuber *ndpas;
-        linked_hashtable_iterator_t it;
+        size_t i;
 
-        hashtable_foreach(aspc->as->ndpass, ndpas)
-            notify_of_cmt_upd(ndpas->nd->node_id, &cmt_mod);
+        flatmap_foreach(&aspc->as->ndpass, i, ndpas)
+            notify_of_cmt_upd(ndpas->nd->peer, &cmt_mod);
     }
 
 finally:
@@ -1943,10 +1927,10 @@ void hdl_del_cmt_req(Carrier *c, const char *from, Req *base)
 
     list_foreach(chan->aspcs, aspc) {
         NotifDestPerActiveSuber *ndpas;
-        linked_hashtable_iterator_t it;
+        size_t i;
 
-        hashtable_foreach(aspc->as->ndpass, ndpas)
-            notify_of_cmt_upd(ndpas->nd->node_id, &cmt_del);
+        flatmap_foreach(&aspc->as->ndpass, i, ndpas)
+            notify_of_cmt_upd(ndpas->nd->peer, &cmt_del);
     }
 
 finally:
@@ -2068,10 +2052,10 @@ void hdl_block_cmt_req(Carrier *c, const char *from, Req *base)
 
     list_foreach(chan->aspcs, aspc) {
         NotifDestPerActiveSuber *ndpas;
-        linked_hashtable_iterator_t it;
+        size_t i;
 
-        hashtable_foreach(aspc->as->ndpass, ndpas)
-            notify_of_cmt_upd(ndpas->nd->node_id, &cmt_block);
+        flatmap_foreach(&aspc->as->ndpass, i, ndpas)
+            notify_of_cmt_upd(ndpas->nd->peer, &cmt_block);
     }
 
 finally:
@@ -2193,10 +2177,10 @@ void hdl_unblock_cmt_req(Carrier *c, const char *from, Req *base)
 
     list_foreach(chan->aspcs, aspc) {
         NotifDestPerActiveSuber *ndpas;
-        linked_hashtable_iterator_t it;
+        size_t i;
 
-        hashtable_foreach(aspc->as->ndpass, ndpas)
-            notify_of_cmt_upd(ndpas->nd->node_id, &cmt_unblock);
+        flatmap_foreach(&aspc->as->ndpass, i, ndpas)
+            notify_of_cmt_upd(ndpas->nd->peer, &cmt_unblock);
     }
 
 finally:
@@ -2320,10 +2304,10 @@ void hdl_post_like_req(Carrier *c, const char *from, Req *base)
 
     list_foreach(chan->aspcs, aspc) {
         NotifDestPerActiveSuber *ndpas;
-        linked_hashtable_iterator_t it;
+        size_t i;
 
-        hashtable_foreach(aspc->as->ndpass, ndpas)
-            notify_of_new_like(ndpas->nd->node_id, &li);
+        flatmap_foreach(&aspc->as->ndpass, i, ndpas)
+            notify_of_new_like(ndpas->nd->peer, &li);
     }
 
 finally:
@@ -2418,7 +2402,9 @@ finally:
     deref(chan);
 }
 
-#define MAX_CONTENT_LEN (ELA_MAX_APP_BULKMSG_LEN - 100 * 1024)
+#define MAX_RESP_LEN MSGQ_FRAME_LEN
+// replies sent along with each comment of get_comment_thread, at most.
+#define CMT_THREAD_MAX_REPLIES 32
 void hdl_get_my_chans_req(Carrier *c, const char *from, Req *base)
 {
     GetMyChansReq *req = (GetMyChansReq *)base;
@@ -2489,34 +2475,23 @@ void hdl_get_my_chans_req(Carrier *c, const char *from, Req *base)
     }
 
     {
-        size_t left = MAX_CONTENT_LEN;
         cvector_vector_type(ChanInfo *) cinfos_tmp = NULL;
-        int i;
+        RespChunker ck;
+        size_t i;
 
-        if (!cvector_size(cinfos)) {
-            GetMyChansResp resp = {
-                .tsx_id = req->tsx_id,
-                .result = {
-                    .is_last = true,
-                    .cinfos  = cinfos
-                }
-            };
-            resp_marshal = rpc_marshal_get_my_chans_resp(&resp);
-            vlogD(TAG_CMD "Sending get_my_channels response.");
-            goto finally;
-        }
-
-        for (i = 0; i < cvector_size(cinfos); ++i) {
-            left -= cinfos[i]->len;
-            cvector_push_back(cinfos_tmp, cinfos[i]);
+        rpc_chunker_init(&ck, rpc_get_my_chans_item_sz, MAX_RESP_LEN);
+        for (i = 0; i <= cvector_size(cinfos); ++i) {
+            bool is_last = i == cvector_size(cinfos);
 
-            if (!(!left || i == cvector_size(cinfos) - 1 || cinfos[i + 1]->len > left))
+            if (!is_last && rpc_chunker_fits(&ck, cinfos[i])) {
+                cvector_push_back(cinfos_tmp, cinfos[i]);
                 continue;
+            }
 
             GetMyChansResp resp = {
                 .tsx_id = req->tsx_id,
                 .result = {
-                    .is_last = i == cvector_size(cinfos) - 1,
+                    .is_last = is_last,
                     .cinfos  = cinfos_tmp
                 }
             };
@@ -2527,11 +2502,11 @@ void hdl_get_my_chans_req(Carrier *c, const char *from, Req *base)
             rc = msgq_enq(from, resp_marshal);
             deref(resp_marshal);
             resp_marshal = NULL;
-            if (rc < 0)
+            if (rc < 0 || is_last)
                 break;
 
             cvector_set_size(cinfos_tmp, 0);
-            left = MAX_CONTENT_LEN;
+            cvector_push_back(cinfos_tmp, cinfos[i]);
         }
 
         cvector_free(cinfos_tmp);
@@ -2645,14 +2620,151 @@ finally:
     deref(it);
 }
 
+/*
+ * Cursors after the last item of a page, see QryCursor. Lists that are
+ * not sorted by any column have none.
+ */
+static inline
+uint64_t qry_cursor_val(uint64_t by, uint64_t id, uint64_t upd_at, uint64_t created_at)
+{
+    return by == ID ? id : by == UPD_AT ? upd_at : created_at;
+}
+
+static
+QryCursor chan_page_cursor(uint64_t by, ChanInfo **page)
+{
+    QryCursor cur = {0};
+    ChanInfo *last;
+
+    if (!by || cvector_empty(page))
+        return cur;
+
+    last = page[cvector_size(page) - 1];
+    cur.by    = by;
+    cur.val   = qry_cursor_val(by, last->chan_id, last->upd_at, last->created_at);
+    cur.id[0] = last->chan_id;
+    return cur;
+}
+
+static
+QryCursor post_page_cursor(uint64_t by, PostInfo **page)
+{
+    QryCursor cur = {0};
+    PostInfo *last;
+
+    if (!by || cvector_empty(page))
+        return cur;
+
+    last = page[cvector_size(page) - 1];
+    cur.by    = by;
+    cur.val   = qry_cursor_val(by, last->post_id, last->upd_at, last->created_at);
+    cur.id[0] = last->post_id;
+    return cur;
+}
+
+// liked posts come from many channels, channel_id is part of their key.
+static
+QryCursor liked_post_page_cursor(uint64_t by, PostInfo **page)
+{
+    QryCursor cur = post_page_cursor(by, page);
+
+    if (cur.by) {
+        cur.id[1] = cur.id[0];
+        cur.id[0] = page[cvector_size(page) - 1]->chan_id;
+    }
+    return cur;
+}
+
+static
+QryCursor cmt_page_cursor(uint64_t by, CmtInfo **page)
+{
+    QryCursor cur = {0};
+    CmtInfo *last;
+
+    if (!by || cvector_empty(page))
+        return cur;
+
+    last = page[cvector_size(page) - 1];
+    cur.by    = by;
+    cur.val   = qry_cursor_val(by, last->cmt_id, last->upd_at, last->created_at);
+    cur.id[0] = last->cmt_id;
+    return cur;
+}
+
+typedef struct {
+    uint64_t val;
+    uint64_t id;
+    Chan *chan;
+} ChanKey;
+
+static
+int chan_key_cmp(const void *a, const void *b)
+{
+    const ChanKey *x = a;
+    const ChanKey *y = b;
+
+    if (x->val != y->val)
+        return x->val < y->val ? -1 : 1;
+    if (x->id != y->id)
+        return x->id < y->id ? -1 : 1;
+    return 0;
+}
+
+/*
+ * Channels matching qc from the channel table, in the order and with the
+ * bounds, cursor and limit db_iter_chans() applies to the same query.
+ */
+static
+int chans_query(const QryCriteria *qc, cvector_vector_type(Chan *) *chans)
+{
+    cvector_vector_type(ChanKey) keys = NULL;
+    ChanKey after = {0};
+    QryCursor cur;
+    bool asc = qc->by == NONE || qc->by == ID;
+    Chan *chan;
+    size_t i;
+
+    if (qc->by && qc->cursor_len) {
+        if (!qry_cursor_unpack(qc->cursor, qc->cursor_len, &cur) || cur.by != qc->by)
+            return -1;
+        after.val = cur.val;
+        after.id  = cur.id[0];
+    }
+
+    flatmap_foreach(&chans_by_id, i, chan) {
+        ChanKey key = {
+            .val  = qc->by ? qry_cursor_val(qc->by, chan->info.chan_id, chan->info.upd_at,
+                                            chan->info.created_at) : chan->info.chan_id,
+            .id   = chan->info.chan_id,
+            .chan = chan
+        };
+
+        if (qc->by && ((qc->lower && key.val < qc->lower) || (qc->upper && key.val > qc->upper)))
+            continue;
+        if (after.id && (asc ? chan_key_cmp(&key, &after) <= 0 : chan_key_cmp(&key, &after) >= 0))
+            continue;
+
+        cvector_push_back(keys, key);
+    }
+
+    if (keys)
+        qsort(keys, cvector_size(keys), sizeof(ChanKey), chan_key_cmp);
+
+    for (i = 0; i < cvector_size(keys) && (!qc->maxcnt || i < qc->maxcnt); ++i)
+        cvector_push_back(*chans, ref(keys[asc ? i : cvector_size(keys) - 1 - i].chan));
+
+    cvector_free(keys);
+    return 0;
+}
+
 void hdl_get_chans_req(Carrier *c, const char *from, Req *base)
 {
     GetChansReq *req = (GetChansReq *)base;
-    cvector_vector_type(ChanInfo *) cinfos = NULL;
+    cvector_vector_type(Marshalled *) items = NULL;
+    cvector_vector_type(Chan *) chans = NULL;
     Marshalled *resp_marshal = NULL;
     UserInfo *uinfo = NULL;
-    DBObjIt *it = NULL;
-    ChanInfo *cinfo;
+    Chan **chan;
     int rc;
 
     vlogD(TAG_CMD "Received get_channels request from [%s]: "
@@ -2677,66 +2789,66 @@ void hdl_get_chans_req(Carrier *c, const char *from, Req *base)
         goto finally;
     }
 
-    it = db_iter_chans(&req->params.qc);
-    if (!it) {
-        vlogE(TAG_CMD "Getting channels from database failed.");
+    if (chans_query(&req->params.qc, &chans) < 0) {
+        vlogE(TAG_CMD "Invalid query cursor.");
         ErrResp resp = {
             .tsx_id = req->tsx_id,
-            .ec     = ERR_INTERNAL_ERROR
+            .ec     = ERR_INVALID_PARAMS
         };
         resp_marshal = rpc_marshal_err_resp(&resp);
         goto finally;
     }
 
-    foreach_db_obj(cinfo) {
-        cvector_push_back(cinfos, ref(cinfo));
+    // channels are packed when they change, only a projection is packed here.
+    cvector_foreach(chans, chan) {
+        ChanInfo proj = (*chan)->info;
+        Marshalled *item;
+
+        proj.fields = req->params.qc.fields;
+        if (known_tag_matches(&req->params.qc, proj.chan_id, (*chan)->tag))
+            proj.fields = PROJ_NOT_MODIFIED;
+        item = !proj.fields && (*chan)->packed ? ref((*chan)->packed) : rpc_pack_chan(&proj);
+        if (!item) {
+            vlogE(TAG_CMD "Packing channels failed.");
+            ErrResp resp = {
+                .tsx_id = req->tsx_id,
+                .ec     = ERR_INTERNAL_ERROR
+            };
+            resp_marshal = rpc_marshal_err_resp(&resp);
+            goto finally;
+        }
+        cvector_push_back(items, item);
+
         vlogD(TAG_CMD "Retrieved channel: "
               "{channel_id: %" PRIu64 ", name: %s, introduction: %s, "
               "owner_name: %s, owner_did: %s, subscribers: %" PRIu64 ", last_update: %" PRIu64
               ", avatar_length: %zu}",
-              cinfo->chan_id, cinfo->name, cinfo->intro, cinfo->owner->name,
-              cinfo->owner->did, cinfo->subs, cinfo->upd_at, cinfo->len);
-    }
-    if (rc < 0) {
-        vlogE(TAG_CMD "Iterating channels failed.");
-        ErrResp resp = {
-            .tsx_id = req->tsx_id,
-            .ec     = ERR_INTERNAL_ERROR
-        };
-        resp_marshal = rpc_marshal_err_resp(&resp);
-        goto finally;
+              proj.chan_id, proj.name, proj.intro, proj.owner->name,
+              proj.owner->did, proj.subs, proj.upd_at, proj.len);
     }
 
     {
-        size_t left = MAX_CONTENT_LEN;
+        cvector_vector_type(Marshalled *) items_tmp = NULL;
         cvector_vector_type(ChanInfo *) cinfos_tmp = NULL;
-        int i;
+        RespChunker ck;
+        size_t i;
 
-        if (!cvector_size(cinfos)) {
-            GetChansResp resp = {
-                .tsx_id = req->tsx_id,
-                .result = {
-                    .is_last = true,
-                    .cinfos  = cinfos
-                }
-            };
-            resp_marshal = rpc_marshal_get_chans_resp(&resp);
-            vlogD(TAG_CMD "Sending get_channels response.");
-            goto finally;
-        }
-
-        for (i = 0; i < cvector_size(cinfos); ++i) {
-            left -= cinfos[i]->len;
-            cvector_push_back(cinfos_tmp, cinfos[i]);
+        rpc_chunker_init(&ck, rpc_packed_item_sz, MAX_RESP_LEN);
+        for (i = 0; i <= cvector_size(items); ++i) {
+            bool is_last = i == cvector_size(items);
 
-            if (!(!left || i == cvector_size(cinfos) - 1 || cinfos[i + 1]->len > left))
+            if (!is_last && rpc_chunker_fits(&ck, items[i])) {
+                cvector_push_back(items_tmp, items[i]);
+                cvector_push_back(cinfos_tmp, &chans[i]->info);
                 continue;
+            }
 
             GetChansResp resp = {
                 .tsx_id = req->tsx_id,
                 .result = {
-                    .is_last = i == cvector_size(cinfos) - 1,
-                    .cinfos  = cinfos_tmp
+                    .is_last = is_last,
+                    .items   = items_tmp,
+                    .cursor  = chan_page_cursor(req->params.qc.by, cinfos_tmp)
                 }
             };
             resp_marshal = rpc_marshal_get_chans_resp(&resp);
@@ -2746,13 +2858,16 @@ void hdl_get_chans_req(Carrier *c, const char *from, Req *base)
             rc = msgq_enq(from, resp_marshal);
             deref(resp_marshal);
             resp_marshal = NULL;
-            if (rc < 0)
+            if (rc < 0 || is_last)
                 break;
 
+            cvector_set_size(items_tmp, 0);
             cvector_set_size(cinfos_tmp, 0);
-            left = MAX_CONTENT_LEN;
+            cvector_push_back(items_tmp, items[i]);
+            cvector_push_back(cinfos_tmp, &chans[i]->info);
         }
 
+        cvector_free(items_tmp);
         cvector_free(cinfos_tmp);
     }
 
@@ -2761,14 +2876,18 @@ finally:
         msgq_enq(from, resp_marshal);
         deref(resp_marshal);
     }
-    if (cinfos) {
-        ChanInfo **i;
-        cvector_foreach(cinfos, i)
+    if (items) {
+        Marshalled **i;
+        cvector_foreach(items, i)
             deref(*i);
-        cvector_free(cinfos);
+        cvector_free(items);
+    }
+    if (chans) {
+        cvector_foreach(chans, chan)
+            deref(*chan);
+        cvector_free(chans);
     }
     deref(uinfo);
-    deref(it);
 }
 
 void hdl_get_chan_dtl_req(Carrier *c, const char *from, Req *base)
@@ -2811,7 +2930,8 @@ void hdl_get_chan_dtl_req(Carrier *c, const char *from, Req *base)
         GetChanDtlResp resp = {
             .tsx_id = req->tsx_id,
             .result = {
-                .cinfo = &chan->info
+                .cinfo        = &chan->info,
+                .not_modified = req->params.known_tag && req->params.known_tag == chan->tag
             }
         };
         resp_marshal = rpc_marshal_get_chan_dtl_resp(&resp);
@@ -2894,34 +3014,23 @@ void hdl_get_sub_chans_req(Carrier *c, const char *from, Req *base)
     }
 
     {
-        size_t left = MAX_CONTENT_LEN;
         cvector_vector_type(ChanInfo *) cinfos_tmp = NULL;
-        int i;
-
-        if (!cvector_size(cinfos)) {
-            GetSubChansResp resp = {
-                .tsx_id = req->tsx_id,
-                .result = {
-                    .is_last = true,
-                    .cinfos  = cinfos
-                }
-            };
-            resp_marshal = rpc_marshal_get_sub_chans_resp(&resp);
-            vlogD(TAG_CMD "Sending get_subscribed_channels response.");
-            goto finally;
-        }
+        RespChunker ck;
+        size_t i;
 
-        for (i = 0; i < cvector_size(cinfos); ++i) {
-            left -= cinfos[i]->len;
-            cvector_push_back(cinfos_tmp, cinfos[i]);
+        rpc_chunker_init(&ck, rpc_get_sub_chans_item_sz, MAX_RESP_LEN);
+        for (i = 0; i <= cvector_size(cinfos); ++i) {
+            bool is_last = i == cvector_size(cinfos);
 
-            if (!(!left || i == cvector_size(cinfos) - 1 || cinfos[i + 1]->len > left))
+            if (!is_last && rpc_chunker_fits(&ck, cinfos[i])) {
+                cvector_push_back(cinfos_tmp, cinfos[i]);
                 continue;
+            }
 
             GetSubChansResp resp = {
                 .tsx_id = req->tsx_id,
                 .result = {
-                    .is_last = i == cvector_size(cinfos) - 1,
+                    .is_last = is_last,
                     .cinfos  = cinfos_tmp
                 }
             };
@@ -2932,11 +3041,11 @@ void hdl_get_sub_chans_req(Carrier *c, const char *from, Req *base)
             rc = msgq_enq(from, resp_marshal);
             deref(resp_marshal);
             resp_marshal = NULL;
-            if (rc < 0)
+            if (rc < 0 || is_last)
                 break;
 
             cvector_set_size(cinfos_tmp, 0);
-            left = MAX_CONTENT_LEN;
+            cvector_push_back(cinfos_tmp, cinfos[i]);
         }
 
         cvector_free(cinfos_tmp);
@@ -2963,6 +3072,7 @@ void hdl_get_posts_req(Carrier *c, const char *from, Req *base)
     cvector_vector_type(PostInfo *) pinfos = NULL;
     Marshalled *resp_marshal = NULL;
     UserInfo *uinfo = NULL;
+    Arena *arena = NULL;
     DBObjIt *it = NULL;
     PostInfo *pinfo;
     int rc;
@@ -2999,7 +3109,8 @@ void hdl_get_posts_req(Carrier *c, const char *from, Req *base)
         goto finally;
     }
 
-    it = db_iter_posts(req->params.chan_id, &req->params.qc);
+    arena = arena_create(0);
+    it = arena ? db_iter_posts(req->params.chan_id, &req->params.qc) : NULL;
     if (!it) {
         vlogE(TAG_CMD "Getting posts from database failed.");
         ErrResp resp = {
@@ -3009,9 +3120,13 @@ void hdl_get_posts_req(Carrier *c, const char *from, Req *base)
         resp_marshal = rpc_marshal_err_resp(&resp);
         goto finally;
     }
+    db_iter_set_arena(it, arena);
 
-    foreach_db_obj(pinfo) {
-        cvector_push_back(pinfos, ref(pinfo));
+    foreach_arena_obj(pinfo) {
+        if (req->params.qc.known_tags_len && post_has_tag(pinfo) &&
+            known_tag_matches(&req->params.qc, pinfo->post_id, post_tag(pinfo)))
+            pinfo->fields |= PROJ_NOT_MODIFIED;
+        cvector_push_back(pinfos, pinfo);
         vlogD(TAG_CMD "Retrieved post: "
               "{channel_id: %" PRIu64 ", post_id: %" PRIu64 ", status: %s,"
               "comments: %" PRIu64 ", likes: %" PRIu64 ", created_at: %" PRIu64 ","
@@ -3032,51 +3147,271 @@ void hdl_get_posts_req(Carrier *c, const char *from, Req *base)
     }
 
     {
-        size_t left = MAX_CONTENT_LEN;
         cvector_vector_type(PostInfo *) pinfos_tmp = NULL;
-        int i;
+        RespChunker ck;
+        size_t i;
+
+        rpc_chunker_init(&ck, rpc_get_posts_item_sz, MAX_RESP_LEN);
+        for (i = 0; i <= cvector_size(pinfos); ++i) {
+            bool is_last = i == cvector_size(pinfos);
+
+            if (!is_last && rpc_chunker_fits(&ck, pinfos[i])) {
+                cvector_push_back(pinfos_tmp, pinfos[i]);
+                continue;
+            }
 
-        if (!cvector_size(pinfos)) {
             GetPostsResp resp = {
                 .tsx_id = req->tsx_id,
                 .result = {
-                    .is_last = true,
-                    .pinfos  = pinfos
+                    .is_last = is_last,
+                    .pinfos  = pinfos_tmp,
+                    .cursor  = post_page_cursor(req->params.qc.by, pinfos_tmp)
                 }
             };
             resp_marshal = rpc_marshal_get_posts_resp(&resp);
+
             vlogD(TAG_CMD "Sending get_posts response.");
-            goto finally;
-        }
 
-        for (i = 0; i < cvector_size(pinfos); ++i) {
-            left -= pinfos[i]->con_len;
-            left -= pinfos[i]->thu_len;
+            rc = msgq_enq(from, resp_marshal);
+            deref(resp_marshal);
+            resp_marshal = NULL;
+            if (rc < 0 || is_last)
+                break;
+
+            cvector_set_size(pinfos_tmp, 0);
             cvector_push_back(pinfos_tmp, pinfos[i]);
+        }
+
+        cvector_free(pinfos_tmp);
+    }
+
+finally:
+    if (resp_marshal) {
+        msgq_enq(from, resp_marshal);
+        deref(resp_marshal);
+    }
+    cvector_free(pinfos);
+    deref(uinfo);
+    deref(it);
+    deref(arena);
+}
+
+void hdl_sync_changes_req(Carrier *c, const char *from, Req *base)
+{
+    SyncChangesReq *req = (SyncChangesReq *)base;
+    cvector_vector_type(ChangeInfo *) chinfos = NULL;
+    Marshalled *resp_marshal = NULL;
+    UserInfo *uinfo = NULL;
+    DBObjIt *it = NULL;
+    ChangeInfo *chinfo;
+    int rc;
+
+    vlogD(TAG_CMD "Received sync_changes request from [%s]: "
+          "{access_token: %s, channel_id: %" PRIu64 ", cursor: %" PRIu64
+          ", max_count: %" PRIu64 "}",
+          from, req->params.tk, req->params.chan_id, req->params.cursor,
+          req->params.maxcnt);
+
+    if (!did_is_ready()) {
+        vlogE(TAG_CMD "Feeds DID is not ready.");
+        return;
+    }
+
+    uinfo = create_uinfo_from_access_token(req->params.tk);
+    if (!uinfo) {
+        vlogE(TAG_CMD "Invalid access token.");
+        ErrResp resp = {
+            .tsx_id = req->tsx_id,
+            .ec     = ERR_ACCESS_TOKEN_EXP
+        };
+        resp_marshal = rpc_marshal_err_resp(&resp);
+        goto finally;
+    }
+
+    if (!chan_exist_by_id(req->params.chan_id)) {
+        vlogE(TAG_CMD "Syncing changes of non-existent channel");
+        ErrResp resp = {
+            .tsx_id = req->tsx_id,
+            .ec     = ERR_NOT_EXIST
+        };
+        resp_marshal = rpc_marshal_err_resp(&resp);
+        goto finally;
+    }
+
+    it = db_iter_changes(req->params.chan_id, req->params.cursor, req->params.maxcnt);
+    if (!it) {
+        vlogE(TAG_CMD "Getting changes from database failed.");
+        ErrResp resp = {
+            .tsx_id = req->tsx_id,
+            .ec     = ERR_INTERNAL_ERROR
+        };
+        resp_marshal = rpc_marshal_err_resp(&resp);
+        goto finally;
+    }
+
+    foreach_db_obj(chinfo) {
+        cvector_push_back(chinfos, ref(chinfo));
+    }
+    if (rc < 0) {
+        vlogE(TAG_CMD "Iterating changes failed.");
+        ErrResp resp = {
+            .tsx_id = req->tsx_id,
+            .ec     = ERR_INTERNAL_ERROR
+        };
+        resp_marshal = rpc_marshal_err_resp(&resp);
+        goto finally;
+    }
+    vlogD(TAG_CMD "Retrieved %zu changes.", cvector_size(chinfos));
 
-            if (!(!left || i == cvector_size(pinfos) - 1 ||
-                    pinfos[i + 1]->con_len + pinfos[i + 1]->thu_len > left))  //2.0
+    {
+        cvector_vector_type(ChangeInfo *) chinfos_tmp = NULL;
+        uint64_t cursor = req->params.cursor;
+        RespChunker ck;
+        size_t i;
+
+        // every response carries the cursor to resume after its last change.
+        rpc_chunker_init(&ck, rpc_sync_changes_item_sz, MAX_RESP_LEN);
+        for (i = 0; i <= cvector_size(chinfos); ++i) {
+            bool is_last = i == cvector_size(chinfos);
+
+            if (!is_last && rpc_chunker_fits(&ck, chinfos[i])) {
+                cvector_push_back(chinfos_tmp, chinfos[i]);
+                cursor = chinfos[i]->seq;
                 continue;
+            }
 
-            GetPostsResp resp = {
+            SyncChangesResp resp = {
+                .tsx_id = req->tsx_id,
+                .result = {
+                    .is_last = is_last,
+                    .cursor  = cursor,
+                    .chinfos = chinfos_tmp
+                }
+            };
+            resp_marshal = rpc_marshal_sync_changes_resp(&resp);
+
+            vlogD(TAG_CMD "Sending sync_changes response.");
+
+            rc = msgq_enq(from, resp_marshal);
+            deref(resp_marshal);
+            resp_marshal = NULL;
+            if (rc < 0 || is_last)
+                break;
+
+            cvector_set_size(chinfos_tmp, 0);
+            cvector_push_back(chinfos_tmp, chinfos[i]);
+            cursor = chinfos[i]->seq;
+        }
+
+        cvector_free(chinfos_tmp);
+    }
+
+finally:
+    if (resp_marshal) {
+        msgq_enq(from, resp_marshal);
+        deref(resp_marshal);
+    }
+    if (chinfos) {
+        ChangeInfo **i;
+        cvector_foreach(chinfos, i)
+            deref(*i);
+        cvector_free(chinfos);
+    }
+    deref(uinfo);
+    deref(it);
+}
+
+void hdl_get_timeline_req(Carrier *c, const char *from, Req *base)
+{
+    GetTimelineReq *req = (GetTimelineReq *)base;
+    cvector_vector_type(PostInfo *) pinfos = NULL;
+    Marshalled *resp_marshal = NULL;
+    UserInfo *uinfo = NULL;
+    DBObjIt *it = NULL;
+    PostInfo *pinfo;
+    int rc;
+
+    vlogD(TAG_CMD "Received get_timeline request from [%s]: "
+          "{access_token: %s, before_created_at: %" PRIu64 ", before_channel_id: %" PRIu64
+          ", before_post_id: %" PRIu64 ", max_count: %" PRIu64 ", fields: %" PRIu64 "}",
+          from, req->params.tk, req->params.before.created_at, req->params.before.chan_id,
+          req->params.before.post_id, req->params.maxcnt, req->params.fields);
+
+    if (!did_is_ready()) {
+        vlogE(TAG_CMD "Feeds DID is not ready.");
+        return;
+    }
+
+    uinfo = create_uinfo_from_access_token(req->params.tk);
+    if (!uinfo) {
+        vlogE(TAG_CMD "Invalid access token.");
+        ErrResp resp = {
+            .tsx_id = req->tsx_id,
+            .ec     = ERR_ACCESS_TOKEN_EXP
+        };
+        resp_marshal = rpc_marshal_err_resp(&resp);
+        goto finally;
+    }
+
+    it = db_iter_timeline(uinfo->uid, &req->params.before, req->params.maxcnt,
+                          req->params.fields);
+    if (!it) {
+        vlogE(TAG_CMD "Getting timeline from database failed.");
+        ErrResp resp = {
+            .tsx_id = req->tsx_id,
+            .ec     = ERR_INTERNAL_ERROR
+        };
+        resp_marshal = rpc_marshal_err_resp(&resp);
+        goto finally;
+    }
+
+    foreach_db_obj(pinfo) {
+        cvector_push_back(pinfos, ref(pinfo));
+    }
+    if (rc < 0) {
+        vlogE(TAG_CMD "Iterating timeline failed.");
+        ErrResp resp = {
+            .tsx_id = req->tsx_id,
+            .ec     = ERR_INTERNAL_ERROR
+        };
+        resp_marshal = rpc_marshal_err_resp(&resp);
+        goto finally;
+    }
+    vlogD(TAG_CMD "Retrieved %zu timeline posts.", cvector_size(pinfos));
+
+    {
+        cvector_vector_type(PostInfo *) pinfos_tmp = NULL;
+        RespChunker ck;
+        size_t i;
+
+        rpc_chunker_init(&ck, rpc_get_posts_item_sz, MAX_RESP_LEN);
+        for (i = 0; i <= cvector_size(pinfos); ++i) {
+            bool is_last = i == cvector_size(pinfos);
+
+            if (!is_last && rpc_chunker_fits(&ck, pinfos[i])) {
+                cvector_push_back(pinfos_tmp, pinfos[i]);
+                continue;
+            }
+
+            GetTimelineResp resp = {
                 .tsx_id = req->tsx_id,
                 .result = {
-                    .is_last = i == cvector_size(pinfos) - 1,
+                    .is_last = is_last,
                     .pinfos  = pinfos_tmp
                 }
             };
-            resp_marshal = rpc_marshal_get_posts_resp(&resp);
+            resp_marshal = rpc_marshal_get_timeline_resp(&resp);
 
-            vlogD(TAG_CMD "Sending get_posts response.");
+            vlogD(TAG_CMD "Sending get_timeline response.");
 
             rc = msgq_enq(from, resp_marshal);
             deref(resp_marshal);
             resp_marshal = NULL;
-            if (rc < 0)
+            if (rc < 0 || is_last)
                 break;
 
             cvector_set_size(pinfos_tmp, 0);
-            left = MAX_CONTENT_LEN;
+            cvector_push_back(pinfos_tmp, pinfos[i]);
         }
 
         cvector_free(pinfos_tmp);
@@ -3097,6 +3432,144 @@ finally:
     deref(it);
 }
 
+void hdl_get_cmt_thread_req(Carrier *c, const char *from, Req *base)
+{
+    GetCmtThreadReq *req = (GetCmtThreadReq *)base;
+    cvector_vector_type(CmtThreadInfo *) tinfos = NULL;
+    Marshalled *resp_marshal = NULL;
+    UserInfo *uinfo = NULL;
+    CmtThreadInfo *tinfo;
+    DBObjIt *it = NULL;
+    Chan *chan = NULL;
+    int rc;
+
+    vlogD(TAG_CMD "Received get_comment_thread request from [%s]: "
+          "{access_token: %s, channel_id: %" PRIu64 ", post_id: %" PRIu64
+          ", comment_id: %" PRIu64 ", after_comment_id: %" PRIu64 ", max_count: %" PRIu64
+          ", max_replies: %" PRIu64 ", fields: %" PRIu64 "}",
+          from, req->params.tk, req->params.chan_id, req->params.post_id,
+          req->params.cmt_id, req->params.after, req->params.maxcnt,
+          req->params.max_replies, req->params.fields);
+
+    if (!did_is_ready()) {
+        vlogE(TAG_CMD "Feeds DID is not ready.");
+        return;
+    }
+
+    uinfo = create_uinfo_from_access_token(req->params.tk);
+    if (!uinfo) {
+        vlogE(TAG_CMD "Invalid access token.");
+        ErrResp resp = {
+            .tsx_id = req->tsx_id,
+            .ec     = ERR_ACCESS_TOKEN_EXP
+        };
+        resp_marshal = rpc_marshal_err_resp(&resp);
+        goto finally;
+    }
+
+    if (!(chan = chan_get_by_id(req->params.chan_id))) {
+        vlogE(TAG_CMD "Getting comment thread from non-existent channel");
+        ErrResp resp = {
+            .tsx_id = req->tsx_id,
+            .ec     = ERR_NOT_EXIST
+        };
+        resp_marshal = rpc_marshal_err_resp(&resp);
+        goto finally;
+    }
+
+    if (req->params.post_id >= chan->info.next_post_id) {
+        vlogE(TAG_CMD "Getting comment thread from non-existent post");
+        ErrResp resp = {
+            .tsx_id = req->tsx_id,
+            .ec     = ERR_NOT_EXIST
+        };
+        resp_marshal = rpc_marshal_err_resp(&resp);
+        goto finally;
+    }
+
+    it = db_iter_cmt_thread(req->params.chan_id, req->params.post_id, req->params.cmt_id,
+                            req->params.after, req->params.maxcnt,
+                            req->params.max_replies < CMT_THREAD_MAX_REPLIES ?
+                                req->params.max_replies : CMT_THREAD_MAX_REPLIES,
+                            req->params.fields);
+    if (!it) {
+        vlogE(TAG_CMD "Getting comment thread from database failed.");
+        ErrResp resp = {
+            .tsx_id = req->tsx_id,
+            .ec     = ERR_INTERNAL_ERROR
+        };
+        resp_marshal = rpc_marshal_err_resp(&resp);
+        goto finally;
+    }
+
+    foreach_db_obj(tinfo) {
+        cvector_push_back(tinfos, ref(tinfo));
+    }
+    if (rc < 0) {
+        vlogE(TAG_CMD "Iterating comment thread failed.");
+        ErrResp resp = {
+            .tsx_id = req->tsx_id,
+            .ec     = ERR_INTERNAL_ERROR
+        };
+        resp_marshal = rpc_marshal_err_resp(&resp);
+        goto finally;
+    }
+    vlogD(TAG_CMD "Retrieved %zu comments of the thread.", cvector_size(tinfos));
+
+    {
+        cvector_vector_type(CmtThreadInfo *) tinfos_tmp = NULL;
+        RespChunker ck;
+        size_t i;
+
+        rpc_chunker_init(&ck, rpc_get_cmt_thread_item_sz, MAX_RESP_LEN);
+        for (i = 0; i <= cvector_size(tinfos); ++i) {
+            bool is_last = i == cvector_size(tinfos);
+
+            if (!is_last && rpc_chunker_fits(&ck, tinfos[i])) {
+                cvector_push_back(tinfos_tmp, tinfos[i]);
+                continue;
+            }
+
+            GetCmtThreadResp resp = {
+                .tsx_id = req->tsx_id,
+                .result = {
+                    .is_last = is_last,
+                    .tinfos  = tinfos_tmp
+                }
+            };
+            resp_marshal = rpc_marshal_get_cmt_thread_resp(&resp);
+
+            vlogD(TAG_CMD "Sending get_comment_thread response.");
+
+            rc = msgq_enq(from, resp_marshal);
+            deref(resp_marshal);
+            resp_marshal = NULL;
+            if (rc < 0 || is_last)
+                break;
+
+            cvector_set_size(tinfos_tmp, 0);
+            cvector_push_back(tinfos_tmp, tinfos[i]);
+        }
+
+        cvector_free(tinfos_tmp);
+    }
+
+finally:
+    if (resp_marshal) {
+        msgq_enq(from, resp_marshal);
+        deref(resp_marshal);
+    }
+    if (tinfos) {
+        CmtThreadInfo **i;
+        cvector_foreach(tinfos, i)
+            deref(*i);
+        cvector_free(tinfos);
+    }
+    deref(uinfo);
+    deref(chan);
+    deref(it);
+}
+
 void hdl_get_posts_lac_req(Carrier *c, const char *from, Req *base)
 {
     GetPostsLACReq *req = (GetPostsLACReq *)base;
@@ -3252,35 +3725,25 @@ void hdl_get_liked_posts_req(Carrier *c, const char *from, Req *base)
     }
 
     {
-        size_t left = MAX_CONTENT_LEN;
         cvector_vector_type(PostInfo *) pinfos_tmp = NULL;
-        int i;
-
-        if (!cvector_size(pinfos)) {
-            GetLikedPostsResp resp = {
-                .tsx_id = req->tsx_id,
-                .result = {
-                    .is_last = true,
-                    .pinfos  = pinfos
-                }
-            };
-            resp_marshal = rpc_marshal_get_liked_posts_resp(&resp);
-            vlogD(TAG_CMD "Sending get_liked_posts response.");
-            goto finally;
-        }
+        RespChunker ck;
+        size_t i;
 
-        for (i = 0; i < cvector_size(pinfos); ++i) {
-            left -= pinfos[i]->con_len;
-            cvector_push_back(pinfos_tmp, pinfos[i]);
+        rpc_chunker_init(&ck, rpc_get_liked_posts_item_sz, MAX_RESP_LEN);
+        for (i = 0; i <= cvector_size(pinfos); ++i) {
+            bool is_last = i == cvector_size(pinfos);
 
-            if (!(!left || i == cvector_size(pinfos) - 1 || pinfos[i + 1]->con_len > left))
+            if (!is_last && rpc_chunker_fits(&ck, pinfos[i])) {
+                cvector_push_back(pinfos_tmp, pinfos[i]);
                 continue;
+            }
 
             GetLikedPostsResp resp = {
                 .tsx_id = req->tsx_id,
                 .result = {
-                    .is_last = i == cvector_size(pinfos) - 1,
-                    .pinfos  = pinfos_tmp
+                    .is_last = is_last,
+                    .pinfos  = pinfos_tmp,
+                    .cursor  = liked_post_page_cursor(req->params.qc.by, pinfos_tmp)
                 }
             };
             resp_marshal = rpc_marshal_get_liked_posts_resp(&resp);
@@ -3290,11 +3753,11 @@ void hdl_get_liked_posts_req(Carrier *c, const char *from, Req *base)
             rc = msgq_enq(from, resp_marshal);
             deref(resp_marshal);
             resp_marshal = NULL;
-            if (rc < 0)
+            if (rc < 0 || is_last)
                 break;
 
             cvector_set_size(pinfos_tmp, 0);
-            left = MAX_CONTENT_LEN;
+            cvector_push_back(pinfos_tmp, pinfos[i]);
         }
 
         cvector_free(pinfos_tmp);
@@ -3378,40 +3841,23 @@ void hdl_get_liked_data_req(Carrier *c, const char *from, Req *base)
     }
 
     {
-        size_t left = MAX_CONTENT_LEN;
         cvector_vector_type(LikeInfo *) linfos_tmp = NULL;
-        int i;
-
-        if (!cvector_size(linfos)) {
-            GetLikedDataResp resp = {
-                .tsx_id = req->tsx_id,
-                .result = {
-                    .is_last = true,
-                    .linfos  = linfos
-                }
-            };
-            resp_marshal = rpc_marshal_get_liked_data_resp(&resp);
-            vlogD(TAG_CMD "Sending get_liked_data response.");
-            goto finally;
-        }
+        RespChunker ck;
+        size_t i;
 
-        for (i = 0; i < cvector_size(linfos); ++i) {
-            left = left - sizeof(linfo) - strlen(linfos[i]->proof) -1 
-                - strlen(linfos[i]->user.name) - 1
-                - strlen(linfos[i]->user.did) - 1;
-            cvector_push_back(linfos_tmp, linfos[i]);
+        rpc_chunker_init(&ck, rpc_get_liked_data_item_sz, MAX_RESP_LEN);
+        for (i = 0; i <= cvector_size(linfos); ++i) {
+            bool is_last = i == cvector_size(linfos);
 
-            if (!(!left || i == cvector_size(linfos) - 1 || 
-                sizeof(linfo) + strlen(linfos[i]->proof) + 1 + 
-                strlen(linfos[i]->user.name) + 1 + 
-                strlen(linfos[i]->user.did) + 1 > left)) {
+            if (!is_last && rpc_chunker_fits(&ck, linfos[i])) {
+                cvector_push_back(linfos_tmp, linfos[i]);
                 continue;
             }
 
             GetLikedDataResp resp = {
                 .tsx_id = req->tsx_id,
                 .result = {
-                    .is_last = i == cvector_size(linfos) - 1,
+                    .is_last = is_last,
                     .linfos  = linfos_tmp
                 }
             };
@@ -3422,11 +3868,11 @@ void hdl_get_liked_data_req(Carrier *c, const char *from, Req *base)
             rc = msgq_enq(from, resp_marshal);
             deref(resp_marshal);
             resp_marshal = NULL;
-            if (rc < 0)
+            if (rc < 0 || is_last)
                 break;
 
             cvector_set_size(linfos_tmp, 0);
-            left = MAX_CONTENT_LEN;
+            cvector_push_back(linfos_tmp, linfos[i]);
         }
 
         cvector_free(linfos_tmp);
@@ -3454,6 +3900,7 @@ void hdl_get_cmts_req(Carrier *c, const char *from, Req *base)
     cvector_vector_type(CmtInfo *) cinfos = NULL;
     Marshalled *resp_marshal = NULL;
     UserInfo *uinfo = NULL;
+    Arena *arena = NULL;
     DBObjIt *it = NULL;
     Chan *chan = NULL;
     CmtInfo *cinfo;
@@ -3501,7 +3948,8 @@ void hdl_get_cmts_req(Carrier *c, const char *from, Req *base)
         goto finally;
     }
 
-    it = db_iter_cmts(req->params.chan_id, req->params.post_id, &req->params.qc);
+    arena = arena_create(0);
+    it = arena ? db_iter_cmts(req->params.chan_id, req->params.post_id, &req->params.qc) : NULL;
     if (!it) {
         vlogE(TAG_CMD "Getting comments from database failed.");
         ErrResp resp = {
@@ -3511,9 +3959,10 @@ void hdl_get_cmts_req(Carrier *c, const char *from, Req *base)
         resp_marshal = rpc_marshal_err_resp(&resp);
         goto finally;
     }
+    db_iter_set_arena(it, arena);
 
-    foreach_db_obj(cinfo) {
-        cvector_push_back(cinfos, ref(cinfo));
+    foreach_arena_obj(cinfo) {
+        cvector_push_back(cinfos, cinfo);
         vlogD(TAG_CMD "Retrieved comment: "
               "{channel_id: %" PRIu64 ", post_id: %" PRIu64 ", comment_id: %" PRIu64 ","
               "status: %s, refcomment_id: %" PRIu64 ", user_name: %s, user_did: %s,"
@@ -3535,36 +3984,25 @@ void hdl_get_cmts_req(Carrier *c, const char *from, Req *base)
     }
 
     {
-        size_t left = MAX_CONTENT_LEN;
         cvector_vector_type(CmtInfo *) cinfos_tmp = NULL;
-        int i;
+        RespChunker ck;
+        size_t i;
 
-        if (!cvector_size(cinfos)) {
-            GetCmtsResp resp = {
-                .tsx_id = req->tsx_id,
-                .result = {
-                    .is_last = true,
-                    .cinfos  = cinfos
-                }
-            };
-            resp_marshal = rpc_marshal_get_cmts_resp(&resp);
-            vlogD(TAG_CMD "Sending get_comments response.");
-            goto finally;
-        }
-
-        for (i = 0; i < cvector_size(cinfos); ++i) {
-            left -= cinfos[i]->con_len;
-            cvector_push_back(cinfos_tmp, cinfos[i]);
+        rpc_chunker_init(&ck, rpc_get_cmts_item_sz, MAX_RESP_LEN);
+        for (i = 0; i <= cvector_size(cinfos); ++i) {
+            bool is_last = i == cvector_size(cinfos);
 
-            if (!(!left || i == cvector_size(cinfos) - 1 ||
-                    cinfos[i + 1]->con_len + cinfos[i + 1]->thu_len > left))  //2.0
+            if (!is_last && rpc_chunker_fits(&ck, cinfos[i])) {
+                cvector_push_back(cinfos_tmp, cinfos[i]);
                 continue;
+            }
 
             GetCmtsResp resp = {
                 .tsx_id = req->tsx_id,
                 .result = {
-                    .is_last = i == cvector_size(cinfos) - 1,
-                    .cinfos  = cinfos_tmp
+                    .is_last = is_last,
+                    .cinfos  = cinfos_tmp,
+                    .cursor  = cmt_page_cursor(req->params.qc.by, cinfos_tmp)
                 }
             };
             resp_marshal = rpc_marshal_get_cmts_resp(&resp);
@@ -3574,11 +4012,11 @@ void hdl_get_cmts_req(Carrier *c, const char *from, Req *base)
             rc = msgq_enq(from, resp_marshal);
             deref(resp_marshal);
             resp_marshal = NULL;
-            if (rc < 0)
+            if (rc < 0 || is_last)
                 break;
 
             cvector_set_size(cinfos_tmp, 0);
-            left = MAX_CONTENT_LEN;
+            cvector_push_back(cinfos_tmp, cinfos[i]);
         }
 
         cvector_free(cinfos_tmp);
@@ -3589,15 +4027,11 @@ finally:
         msgq_enq(from, resp_marshal);
         deref(resp_marshal);
     }
-    if (cinfos) {
-        CmtInfo **i;
-        cvector_foreach(cinfos, i)
-            deref(*i);
-        cvector_free(cinfos);
-    }
+    cvector_free(cinfos);
     deref(uinfo);
     deref(chan);
     deref(it);
+    deref(arena);
 }
 
 void hdl_get_cmts_likes_req(Carrier *c, const char *from, Req *base)
@@ -3847,6 +4281,7 @@ void hdl_sub_chan_req(Carrier *c, const char *from, Req *base)
         aspc_put(aspc);
 
     ++chan->info.subs;
+    chan_pack(chan);
     vlogI(TAG_CMD "[%s] subscribed to channel [%" PRIu64 "]", uinfo->did, req->params.id);
 
     {
@@ -3862,11 +4297,11 @@ void hdl_sub_chan_req(Carrier *c, const char *from, Req *base)
     }
 
     if ((owner = as_get(OWNER_USER_ID))) {
-        linked_hashtable_iterator_t it;
         NotifDestPerActiveSuber *ndpas;
+        size_t i;
 
-        hashtable_foreach(owner->ndpass, ndpas)
-            notify_of_new_sub(ndpas->nd->node_id, chan->info.chan_id, uinfo);
+        flatmap_foreach(&owner->ndpass, i, ndpas)
+            notify_of_new_sub(ndpas->nd->peer, chan->info.chan_id, uinfo);
     }
 
 finally:
@@ -3942,6 +4377,7 @@ void hdl_unsub_chan_req(Carrier *c, const char *from, Req *base)
 
     deref(aspc_remove(uinfo->uid, chan));
     --chan->info.subs;
+    chan_pack(chan);
     vlogI(TAG_CMD "[%s] unsubscribed channel [%" PRIu64 "]", uinfo->did, req->params.id);
 
     {
@@ -3970,7 +4406,7 @@ void nd_dtor(void *obj)
 }
 
 static
-NotifDest *nd_create(const char *node_id)
+NotifDest *nd_create(PeerId peer)
 {
     NotifDest *nd = rc_zalloc(sizeof(NotifDest), nd_dtor);
     if (!nd) {
@@ -3984,10 +4420,7 @@ NotifDest *nd_create(const char *node_id)
         return NULL;
     }
 
-    strcpy(nd->node_id, node_id);
-    nd->he.data   = nd;
-    nd->he.key    = nd->node_id;
-    nd->he.keylen = strlen(nd->node_id);
+    nd->peer = peer;
 
     return nd;
 }
@@ -4002,10 +4435,6 @@ NotifDestPerActiveSuber *ndpas_create(ActiveSuber *as, NotifDest *nd)
     ndpas->as = as;
     ndpas->nd = nd;
 
-    ndpas->he.data   = ndpas;
-    ndpas->he.key    = nd->node_id;
-    ndpas->he.keylen = strlen(nd->node_id);
-
     ndpas->le.data = ndpas;
 
     return ndpas;
@@ -4021,6 +4450,7 @@ void hdl_enbl_notif_req(Carrier *c, const char *from, Req *base)
     UserInfo *uinfo = NULL;
     ActiveSuberPerChan **i;
     NotifDest *nd = NULL;
+    PeerId peer = peer_intern(from);
     bool new_nd = false;
     bool new_as = false;
     QryCriteria qc = {
@@ -4051,7 +4481,7 @@ void hdl_enbl_notif_req(Carrier *c, const char *from, Req *base)
     }
 
     as = as_get(uinfo->uid);
-    if (as && ndpas_exist(as, from)) {
+    if (as && ndpas_exist(as, peer)) {
         vlogE(TAG_CMD "Already enabled notification");
         goto success_resp;
     } else if (!as) {
@@ -4069,9 +4499,9 @@ void hdl_enbl_notif_req(Carrier *c, const char *from, Req *base)
         new_as = true;
     }
 
-    nd = nd_get(from);
+    nd = nd_get(peer);
     if (!nd) {
-        nd = nd_create(from);
+        nd = nd_create(peer);
         if (!nd) {
             vlogE(TAG_CMD "Creating notification destination failed.");
             rc = ERR_INTERNAL_ERROR;
@@ -4182,18 +4612,27 @@ void hdl_get_srv_ver_req(Carrier *c, const char *from, Req *base)
     GetSrvVerReq *req = (GetSrvVerReq *)base;
     Marshalled *resp_marshal = NULL;
 
-    vlogD(TAG_CMD "Received get_service_version request from [%s]: ", from);
+    bool compression;
+
+    vlogD(TAG_CMD "Received get_service_version request from [%s]: "
+          "{compression: %s}", from, req->params.compression ? req->params.compression : "none");
+
+    // the peer gets compressed messages until it asks again without compression.
+    compression = req->params.compression && !strcmp(req->params.compression, MSGQ_COMPRESS_ALGO);
+    msgq_set_compression(peer_intern(from), compression);
 
     GetSrvVerResp resp = {
         .tsx_id = req->tsx_id,
         .result = {
             .version  = FEEDSD_VER,
             .version_code  = FEEDSD_VERCODE,
+            .compression = compression ? MSGQ_COMPRESS_ALGO : NULL,
         }
     };
     resp_marshal = rpc_marshal_get_srv_ver_resp(&resp);
     vlogD(TAG_CMD "get_service_version response: "
-          "{version: %s, version_code:%lld}", resp.result.version, resp.result.version_code);
+          "{version: %s, version_code:%lld, compression: %s}", resp.result.version,
+          resp.result.version_code, compression ? MSGQ_COMPRESS_ALGO : "none");
 
     if (resp_marshal) {
         msgq_enq(from, resp_marshal);
@@ -4308,11 +4747,11 @@ void hdl_report_illegal_cmt_req(Carrier *c, const char *from, Req *base)
     li.reporter    = *uinfo;
 
     if ((owner = as_get(OWNER_USER_ID))) {
-        linked_hashtable_iterator_t it;
         NotifDestPerActiveSuber *ndpas;
+        size_t i;
 
-        hashtable_foreach(owner->ndpass, ndpas)
-            notify_of_report_cmt(ndpas->nd->node_id, &li);
+        flatmap_foreach(&owner->ndpass, i, ndpas)
+            notify_of_report_cmt(ndpas->nd->peer, &li);
     }
 
 finally:
@@ -4400,34 +4839,23 @@ void hdl_get_reported_cmts_req(Carrier *c, const char *from, Req *base)
     }
 
     {
-        // size_t left = MAX_CONTENT_LEN;
         cvector_vector_type(ReportedCmtInfo *) rcinfos_tmp = NULL;
-        int i;
-
-        if (!cvector_size(rcinfos)) {
-            GetReportedCmtsResp resp = {
-                .tsx_id = req->tsx_id,
-                .result = {
-                    .is_last = true,
-                    .rcinfos  = rcinfos
-                }
-            };
-            resp_marshal = rpc_marshal_get_reported_cmts_resp(&resp);
-            vlogD(TAG_CMD "Sending get_reported_comments empty response.");
-            goto finally;
-        }
+        RespChunker ck;
+        size_t i;
 
-        for (i = 0; i < cvector_size(rcinfos); ++i) {
-            // left -= rcinfos[i]->len;
-            cvector_push_back(rcinfos_tmp, rcinfos[i]);
+        rpc_chunker_init(&ck, rpc_get_reported_cmts_item_sz, MAX_RESP_LEN);
+        for (i = 0; i <= cvector_size(rcinfos); ++i) {
+            bool is_last = i == cvector_size(rcinfos);
 
-            // if (!(!left || i == cvector_size(rcinfos) - 1 || rcinfos[i + 1]->len > left))
-            //     continue;
+            if (!is_last && rpc_chunker_fits(&ck, rcinfos[i])) {
+                cvector_push_back(rcinfos_tmp, rcinfos[i]);
+                continue;
+            }
 
             GetReportedCmtsResp resp = {
                 .tsx_id = req->tsx_id,
                 .result = {
-                    .is_last = i == cvector_size(rcinfos) - 1,
+                    .is_last = is_last,
                     .rcinfos  = rcinfos_tmp
                 }
             };
@@ -4438,11 +4866,11 @@ void hdl_get_reported_cmts_req(Carrier *c, const char *from, Req *base)
             rc = msgq_enq(from, resp_marshal);
             deref(resp_marshal);
             resp_marshal = NULL;
-            if (rc < 0)
+            if (rc < 0 || is_last)
                 break;
 
             cvector_set_size(rcinfos_tmp, 0);
-            // left = MAX_CONTENT_LEN;
+            cvector_push_back(rcinfos_tmp, rcinfos[i]);
         }
 
         cvector_free(rcinfos_tmp);
@@ -4481,24 +4909,24 @@ void hdl_unknown_req(Carrier *c, const char *from, Req *base)
     }
 }
 
-void feeds_deactivate_suber(const char *node_id)
+void feeds_deactivate_suber(PeerId peer)
 {
     linked_list_iterator_t it;
     NotifDest *nd;
     NotifDestPerActiveSuber *ndpas;
 
-    nd = nd_remove(node_id);
+    nd = nd_remove(peer);
     if (!nd)
         return;
 
     list_foreach(nd->ndpass, ndpas) {
         ActiveSuber *as = ndpas->as;
-        deref(linked_hashtable_remove(as->ndpass, node_id, strlen(node_id)));
-        if (linked_hashtable_is_empty(as->ndpass)) {
-            linked_hashtable_iterator_t it;
+        deref(flatmap_remove(&as->ndpass, peer));
+        if (flatmap_is_empty(&as->ndpass)) {
             ActiveSuberPerChan *aspc;
+            size_t i;
 
-            hashtable_foreach(as->aspcs, aspc)
+            flatmap_foreach(&as->aspcs, i, aspc)
                 deref(linked_list_remove_entry(aspc->chan->aspcs, &aspc->le));
             deref(as_remove(as->uid));
         }
@@ -4507,22 +4935,32 @@ void feeds_deactivate_suber(const char *node_id)
     deref(nd);
 }
 
+// cached channel items carry the owner name, repack them all.
+void feeds_owner_info_changed()
+{
+    Chan *chan;
+    size_t i;
+
+    flatmap_foreach(&chans_by_id, i, chan)
+        chan_pack(chan);
+}
+
 void hdl_stats_changed_notify()
 {
-    linked_hashtable_iterator_t it;
     NotifDest *nd;
     NotifDestPerActiveSuber *ndpas;
+    size_t i;
     int total_clients = db_get_count("users");
     if(total_clients < 0) {
         vlogE(TAG_CMD "DB get user count failed.");
         return;
     }
 
-    hashtable_foreach(nds, nd) {
+    flatmap_foreach(&nds, i, nd) {
         linked_list_iterator_t it;
         list_foreach(nd->ndpass, ndpas) {
             ActiveSuber *as = ndpas->as;
-            notify_of_stats_changed(ndpas->nd->node_id, total_clients);
+            notify_of_stats_changed(ndpas->nd->peer, total_clients);
         }
     }
 }
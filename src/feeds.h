@@ -27,11 +27,13 @@
 #include <carrier.h>
 
 #include "cfg.h"
+#include "peers.h"
 #include "rpc.h"
 
 int feeds_init(FeedsConfig *cfg);
 void feeds_deinit();
-void feeds_deactivate_suber(const char *node_id);
+void feeds_deactivate_suber(PeerId peer);
+void feeds_owner_info_changed();
 void hdl_create_chan_req(Carrier *c, const char *from, Req *base);
 void hdl_upd_chan_req(Carrier *c, const char *from, Req *base);
 void hdl_upd_user_info_req(Carrier *c, const char *from, Req *base);
@@ -53,6 +55,9 @@ void hdl_get_chans_req(Carrier *c, const char *from, Req *base);
 void hdl_get_chan_dtl_req(Carrier *c, const char *from, Req *base);
 void hdl_get_sub_chans_req(Carrier *c, const char *from, Req *base);
 void hdl_get_posts_req(Carrier *c, const char *from, Req *base);
+void hdl_sync_changes_req(Carrier *c, const char *from, Req *base);
+void hdl_get_timeline_req(Carrier *c, const char *from, Req *base);
+void hdl_get_cmt_thread_req(Carrier *c, const char *from, Req *base);
 void hdl_get_posts_lac_req(Carrier *c, const char *from, Req *base);
 void hdl_get_liked_posts_req(Carrier *c, const char *from, Req *base);
 void hdl_get_liked_data_req(Carrier *c, const char *from, Req *base);
@@ -2,6 +2,7 @@
 #define _FEEDS_RPC_DECLARE_HPP_
 
 #include <MsgPackExtension.hpp>
+#include <RpcMethod.hpp>
 
 namespace trinity {
 namespace Rpc {
@@ -10,6 +11,7 @@ struct Request {
     std::string version;
     std::string method;
     int64_t id = -1;
+    RpcMethod methodId = RPC_METHOD_UNKNOWN; // resolved on unmarshal, not packed.
     MSGPACK_DEFINE_STRUCT(Request, MSGPACK_REQUEST_ARGS);
 };
 
@@ -32,13 +32,15 @@ int Factory::Unmarshal(const std::vector<uint8_t>& data, std::shared_ptr<Request
     CHECK_ASSERT(method.empty() == false, ErrCode::MsgPackInvalidValue);
 
     int processed = 0;
-    request = MakeRequest(method);
+    auto methodId = MethodTable::Id(method);
+    request = MakeRequest(methodId);
     if(request == nullptr) {
         request = std::make_shared<Request>();
         processed = ErrCode::UnimplementedError;
     }
     request->unpack(mpRoot);
     CHECK_ASSERT(request->method.empty() == false, ErrCode::MsgPackParseFailed);
+    request->methodId = methodId;
 
     return processed;
 }
@@ -55,41 +57,56 @@ int Factory::Marshal(const std::shared_ptr<Response>& response, std::vector<uint
     return data.size();
 }
 
-std::shared_ptr<Request> Factory::MakeRequest(const std::string& method)
+std::shared_ptr<Request> Factory::MakeRequest(RpcMethod method)
 {
     std::shared_ptr<Request> request;
 
-    if(method == Method::StandardSignIn) {
+    switch(method) {
+    case RPC_METHOD_STANDARD_SIGN_IN:
         request = std::make_shared<StandardSignInRequest>();
-    } else if(method == Method::StandardDidAuth) {
+        break;
+    case RPC_METHOD_STANDARD_DID_AUTH:
         request = std::make_shared<StandardDidAuthRequest>();
-    } else if(method == Method::GetMultiComments) {
+        break;
+    case RPC_METHOD_GET_MULTI_CMTS:
         request = std::make_shared<GetMultiCommentsRequest>();
-    } else if(method == Method::GetMultiLikesAndCommentsCount) {
+        break;
+    case RPC_METHOD_GET_MULTI_LAC_COUNT:
         request = std::make_shared<GetMultiLikesAndCommentsCountRequest>();
-    } else if(method == Method::GetMultiSubscribersCount) {
+        break;
+    case RPC_METHOD_GET_MULTI_SUBS_COUNT:
         request = std::make_shared<GetMultiSubscribersCountRequest>();
+        break;
+    default:
+        break;
     }
 
     return request;
 }
 
-std::shared_ptr<Response> Factory::MakeResponse(const std::string& method)
+std::shared_ptr<Response> Factory::MakeResponse(RpcMethod method)
 {
     std::shared_ptr<Response> response;
 
-    if(method == Method::StandardSignIn) {
+    switch(method) {
+    case RPC_METHOD_STANDARD_SIGN_IN:
         response = std::make_shared<StandardSignInResponse>();
-    } else if(method == Method::StandardDidAuth) {
+        break;
+    case RPC_METHOD_STANDARD_DID_AUTH:
         response = std::make_shared<StandardDidAuthResponse>();
-    } else if(method == Method::GetMultiComments) {
+        break;
+    case RPC_METHOD_GET_MULTI_CMTS:
         response = std::make_shared<GetMultiCommentsResponse>();
-    } else if(method == Method::GetMultiLikesAndCommentsCount) {
+        break;
+    case RPC_METHOD_GET_MULTI_LAC_COUNT:
         response = std::make_shared<GetMultiLikesAndCommentsCountResponse>();
-    } else if(method == Method::GetMultiSubscribersCount) {
+        break;
+    case RPC_METHOD_GET_MULTI_SUBS_COUNT:
         response = std::make_shared<GetMultiSubscribersCountResponse>();
-    } else {
-        Log::E(Log::Tag::Rpc, "RPC Factory ignore to make response from method: %s.", method.c_str());
+        break;
+    default:
+        Log::E(Log::Tag::Rpc, "RPC Factory ignore to make response from method id: %d.", method);
+        break;
     }
 
     return response;
@@ -98,6 +115,11 @@ std::shared_ptr<Response> Factory::MakeResponse(const std::string& method)
 /* =========================================== */
 /* === class public function implement  ====== */
 /* =========================================== */
+Chunker::Chunker(size_t limit)
+    : limit(limit > EnvelopeSize ? limit - EnvelopeSize : 0)
+    , used(0)
+{
+}
 
 /* =========================================== */
 /* === class protected function implement  === */
@@ -12,23 +12,14 @@ namespace Rpc {
 class Factory {
 public:
     /*** type define ***/
-    struct Method {
-        static constexpr const char* StandardSignIn = "standard_sign_in";
-        static constexpr const char* StandardDidAuth = "standard_did_auth";
-        static constexpr const char* GetMultiComments = "get_multi_comments";
-        static constexpr const char* GetMultiLikesAndCommentsCount = "get_multi_likes_and_comments_count";
-        static constexpr const char* GetMultiSubscribersCount = "get_multi_subscribers_count";
-    };
 
     /*** static function and variable ***/
-    static std::shared_ptr<Request> MakeRequest(const std::string& method);
-    static std::shared_ptr<Response> MakeResponse(const std::string& method);
+    static std::shared_ptr<Request> MakeRequest(RpcMethod method);
+    static std::shared_ptr<Response> MakeResponse(RpcMethod method);
 
     static int Unmarshal(const std::vector<uint8_t>& data, std::shared_ptr<Request>& request);
     static int Marshal(const std::shared_ptr<Response>& response, std::vector<uint8_t>& data);
 
-    static constexpr const int MaxAvailableSize = 4 * 1024; // 4KB
-
     /*** class function and variable ***/
 
 protected:
@@ -50,9 +41,60 @@ private:
     virtual ~Factory() = delete;
 };
 
+// splits list results over responses, each item is sized exactly as it is packed.
+class Chunker {
+public:
+    /*** type define ***/
+
+    /*** static function and variable ***/
+    static constexpr const size_t EnvelopeSize = 128;
+
+    /*** class function and variable ***/
+    explicit Chunker(size_t limit);
+    virtual ~Chunker() = default;
+
+    // false if obj does not fit the current response, it then starts the next one.
+    template <class T>
+    bool fits(const T& obj);
+
+protected:
+    /*** type define ***/
+
+    /*** static function and variable ***/
+
+    /*** class function and variable ***/
+
+private:
+    /*** type define ***/
+    struct Counter {
+        size_t size = 0;
+        void write(const char*, size_t len) { size += len; }
+    };
+
+    /*** static function and variable ***/
+
+    /*** class function and variable ***/
+    size_t limit;
+    size_t used;
+};
+
 /***********************************************/
 /***** class template function implement *******/
 /***********************************************/
+template <class T>
+bool Chunker::fits(const T& obj)
+{
+    Counter counter;
+    msgpack::pack(counter, obj);
+
+    if(used > 0 && used + counter.size > limit) {
+        used = counter.size;
+        return false;
+    }
+
+    used += counter.size;
+    return true;
+}
 
 /***********************************************/
 /***** macro definition ************************/
@@ -0,0 +1,17 @@
+#include "RpcMethod.hpp"
+
+using trinity::Rpc::MethodTable;
+
+extern "C" {
+
+RpcMethod rpc_method_id(const char *name, size_t len)
+{
+    return MethodTable::Id(std::string_view(name, len));
+}
+
+const char *rpc_method_name(RpcMethod method)
+{
+    return MethodTable::Name(method);
+}
+
+} // extern "C"
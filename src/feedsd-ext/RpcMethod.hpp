@@ -0,0 +1,131 @@
+#ifndef _FEEDS_RPC_METHOD_HPP_
+#define _FEEDS_RPC_METHOD_HPP_
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+extern "C" {
+#include <method.h>
+}
+
+namespace trinity {
+namespace Rpc {
+
+// maps method names to RpcMethod ids by a perfect hash found at compile time.
+class MethodTable {
+public:
+    /*** type define ***/
+
+    /*** static function and variable ***/
+    static constexpr RpcMethod Id(std::string_view name);
+    static constexpr const char* Name(RpcMethod method);
+
+    /*** class function and variable ***/
+
+protected:
+    /*** type define ***/
+
+    /*** static function and variable ***/
+
+    /*** class function and variable ***/
+
+private:
+    /*** type define ***/
+    using Slots = std::array<uint8_t, 512>;
+
+    /*** static function and variable ***/
+    static constexpr const char* Names[RPC_METHOD_COUNT] = {
+        "",
+#define RPC_METHOD_NAME(id, name) name,
+        RPC_METHODS(RPC_METHOD_NAME)
+#undef RPC_METHOD_NAME
+    };
+
+    static constexpr uint32_t Hash(std::string_view str, uint32_t seed);
+    static constexpr bool BuildSlots(uint32_t seed, Slots& slots);
+    static constexpr uint32_t FindSeed();
+    static constexpr Slots MakeSlots(uint32_t seed);
+
+    static const uint32_t Seed;
+    static const Slots SlotTable;
+
+    /*** class function and variable ***/
+    explicit MethodTable() = delete;
+    virtual ~MethodTable() = delete;
+};
+
+/***********************************************/
+/***** class template function implement *******/
+/***********************************************/
+constexpr uint32_t MethodTable::Hash(std::string_view str, uint32_t seed)
+{
+    uint32_t hash = 2166136261u ^ seed;
+    for(auto ch: str) {
+        hash = (hash ^ static_cast<uint8_t>(ch)) * 16777619u;
+    }
+
+    return hash ^ (hash >> 15);
+}
+
+constexpr bool MethodTable::BuildSlots(uint32_t seed, Slots& slots)
+{
+    for(auto& slot: slots) {
+        slot = RPC_METHOD_UNKNOWN;
+    }
+
+    for(int id = RPC_METHOD_UNKNOWN + 1; id < RPC_METHOD_COUNT; id++) {
+        auto& slot = slots[Hash(Names[id], seed) % slots.size()];
+        if(slot != RPC_METHOD_UNKNOWN) {
+            return false;
+        }
+        slot = id;
+    }
+
+    return true;
+}
+
+constexpr uint32_t MethodTable::FindSeed()
+{
+    Slots slots {};
+    for(uint32_t seed = 0; seed < 100000; seed++) {
+        if(BuildSlots(seed, slots) == true) {
+            return seed;
+        }
+    }
+
+    return UINT32_MAX;
+}
+
+constexpr MethodTable::Slots MethodTable::MakeSlots(uint32_t seed)
+{
+    Slots slots {};
+    BuildSlots(seed, slots);
+    return slots;
+}
+
+inline constexpr uint32_t MethodTable::Seed = FindSeed();
+
+inline constexpr MethodTable::Slots MethodTable::SlotTable = MakeSlots(MethodTable::Seed);
+
+constexpr RpcMethod MethodTable::Id(std::string_view name)
+{
+    static_assert(Seed != UINT32_MAX, "No perfect hash seed for RPC methods, enlarge Slots.");
+
+    auto id = SlotTable[Hash(name, Seed) % SlotTable.size()];
+    return name == Names[id] ? static_cast<RpcMethod>(id) : RPC_METHOD_UNKNOWN;
+}
+
+constexpr const char* MethodTable::Name(RpcMethod method)
+{
+    return method > RPC_METHOD_UNKNOWN && method < RPC_METHOD_COUNT ? Names[method] : nullptr;
+}
+
+/***********************************************/
+/***** macro definition ************************/
+/***********************************************/
+
+} // namespace Rpc
+} // namespace trinity
+
+#endif /* _FEEDS_RPC_METHOD_HPP_ */
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2020 trinity-tech
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <crystal.h>
+
+#include "flatmap.h"
+
+// keep at most 7/8 of the slots used, Robin Hood probing stays short up to there.
+#define FLATMAP_MAX_LOAD(cap) ((cap) - (cap) / 8)
+
+static inline
+size_t slot_of(const FlatMap *map, uint64_t key)
+{
+    // fibonacci hashing spreads the sequential ids of channels and peers.
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (map->cap - 1);
+}
+
+static
+void slot_insert(FlatMap *map, FlatMapSlot ins)
+{
+    size_t mask = map->cap - 1;
+    size_t i = slot_of(map, ins.key);
+
+    for (ins.dist = 1; ; i = (i + 1) & mask, ++ins.dist) {
+        FlatMapSlot *slot = &map->slots[i];
+
+        if (!slot->dist) {
+            *slot = ins;
+            ++map->size;
+            return;
+        }
+
+        // take the slot of a richer entry and carry it on.
+        if (slot->dist < ins.dist) {
+            FlatMapSlot tmp = *slot;
+            *slot = ins;
+            ins = tmp;
+        }
+    }
+}
+
+static
+FlatMapSlot *slot_find(const FlatMap *map, uint64_t key)
+{
+    size_t mask = map->cap - 1;
+    size_t i = slot_of(map, key);
+    uint32_t dist;
+
+    for (dist = 1; ; i = (i + 1) & mask, ++dist) {
+        FlatMapSlot *slot = &map->slots[i];
+
+        if (slot->dist < dist)
+            return NULL;
+        if (slot->key == key)
+            return slot;
+    }
+}
+
+static
+int flatmap_grow(FlatMap *map)
+{
+    FlatMapSlot *old = map->slots;
+    size_t old_cap = map->cap;
+    size_t i;
+
+    map->slots = calloc(old_cap * 2, sizeof(FlatMapSlot));
+    if (!map->slots) {
+        map->slots = old;
+        return -1;
+    }
+    map->cap  = old_cap * 2;
+    map->size = 0;
+
+    for (i = 0; i < old_cap; ++i) {
+        if (old[i].dist)
+            slot_insert(map, old[i]);
+    }
+    free(old);
+
+    return 0;
+}
+
+int flatmap_init(FlatMap *map, size_t cap)
+{
+    size_t pow2 = 8;
+
+    while (pow2 < cap)
+        pow2 <<= 1;
+
+    map->slots = calloc(pow2, sizeof(FlatMapSlot));
+    if (!map->slots)
+        return -1;
+
+    map->cap  = pow2;
+    map->size = 0;
+
+    return 0;
+}
+
+void flatmap_deinit(FlatMap *map)
+{
+    size_t i;
+
+    if (!map->slots)
+        return;
+
+    for (i = 0; i < map->cap; ++i) {
+        if (map->slots[i].dist)
+            deref(map->slots[i].val);
+    }
+
+    free(map->slots);
+    memset(map, 0, sizeof(*map));
+}
+
+void *flatmap_get(const FlatMap *map, uint64_t key)
+{
+    FlatMapSlot *slot = slot_find(map, key);
+
+    return slot ? slot->val : NULL;
+}
+
+void *flatmap_put(FlatMap *map, uint64_t key, void *val)
+{
+    FlatMapSlot *slot = slot_find(map, key);
+    FlatMapSlot ins = {
+        .key = key,
+        .val = ref(val)
+    };
+
+    if (slot) {
+        deref(slot->val);
+        slot->val = ins.val;
+        return val;
+    }
+
+    if (map->size + 1 > FLATMAP_MAX_LOAD(map->cap) && flatmap_grow(map) < 0) {
+        deref(val);
+        return NULL;
+    }
+
+    slot_insert(map, ins);
+
+    return val;
+}
+
+void *flatmap_remove(FlatMap *map, uint64_t key)
+{
+    FlatMapSlot *slot = slot_find(map, key);
+    size_t mask = map->cap - 1;
+    size_t i;
+    void *val;
+
+    if (!slot)
+        return NULL;
+
+    val = slot->val;
+    i = slot - map->slots;
+
+    // shift the following entries of the run back by one slot.
+    for (;;) {
+        size_t nxt = (i + 1) & mask;
+
+        if (map->slots[nxt].dist <= 1) {
+            memset(&map->slots[i], 0, sizeof(FlatMapSlot));
+            break;
+        }
+
+        map->slots[i] = map->slots[nxt];
+        --map->slots[i].dist;
+        i = nxt;
+    }
+    --map->size;
+
+    return val;
+}
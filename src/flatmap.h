@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2020 trinity-tech
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __FLATMAP_H__
+#define __FLATMAP_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Open addressing map from uint64_t keys to reference counted objects,
+ * with the keys inline in a flat slot array and Robin Hood probing, so a
+ * lookup reads a few adjacent slots instead of chasing hash entries.
+ *
+ * The map holds one reference of each value: flatmap_put() takes it and
+ * flatmap_remove() hands it over to the caller. flatmap_get() and
+ * flatmap_foreach() borrow the values without touching their counts, so
+ * the map must not be changed while iterating.
+ */
+typedef struct {
+    uint64_t key;
+    void *val;
+    uint32_t dist;  // probe distance + 1, 0 for an empty slot
+} FlatMapSlot;
+
+typedef struct {
+    FlatMapSlot *slots;
+    size_t cap;     // power of 2
+    size_t size;
+} FlatMap;
+
+int flatmap_init(FlatMap *map, size_t cap);
+void flatmap_deinit(FlatMap *map);
+void *flatmap_get(const FlatMap *map, uint64_t key);
+void *flatmap_put(FlatMap *map, uint64_t key, void *val);
+void *flatmap_remove(FlatMap *map, uint64_t key);
+
+static inline
+bool flatmap_is_empty(const FlatMap *map)
+{
+    return !map->size;
+}
+
+#define flatmap_foreach(map, i, entry)                               \
+    for ((i) = 0; (i) < (map)->cap; ++(i))                           \
+        if ((map)->slots[(i)].dist && ((entry) = (map)->slots[(i)].val, 1))
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //__FLATMAP_H__
@@ -24,6 +24,8 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <inttypes.h>
+#include <time.h>
 #include <signal.h>
 #include <limits.h>
 #include <sys/stat.h>
@@ -61,6 +63,7 @@ extern "C" {
 #include "feeds.h"
 #include "auth.h"
 #include "msgq.h"
+#include "peers.h"
 #include "cfg.h"
 #include "did.h"
 #include "rpc.h"
@@ -73,6 +76,7 @@ Carrier *carrier;
 }
 
 #define TAG_MAIN "[Feedsd.Main]: "
+#define STATS_LOG_INTERVAL 60 // seconds
 
 std::shared_ptr<Carrier> carrier_instance;
 
@@ -88,10 +92,47 @@ void on_receiving_message(Carrier *c, const char *from,
     (void)offline;
     (void)context;
 
+    Marshalled *whole = NULL;
+    PeerId peer = peer_intern(from);
+    if (peer == PEER_NONE)
+        return;
+
+    int rc = msgq_reassemble(peer, msg, len, &whole);
+    if (rc < 0 || (rc > 0 && !whole))
+        return;
+
+    if (whole) {
+        msg = whole->data;
+        len = whole->sz;
+    }
+
     vlogD(TAG_MAIN "received message: %s", msg);
     auto msgptr = reinterpret_cast<uint8_t*>(const_cast<void*>(msg));
     auto data = std::vector<uint8_t>(msgptr, msgptr + len);
-    std::ignore = trinity::CommandHandler::GetInstance()->received(from, data);
+    deref(whole);
+    std::ignore = trinity::CommandHandler::GetInstance()->received(peer, data);
+}
+
+static
+void stats_log()
+{
+    static time_t last;
+    time_t now = time(NULL);
+
+    if (now - last < STATS_LOG_INTERVAL)
+        return;
+    last = now;
+
+    MsgqStats msgq;
+    msgq_get_stats(&msgq);
+    vlogD(TAG_MAIN "message queue, messages live: %zu, pooled: %zu, queues live: %zu, pooled: %zu",
+          msgq.msgs_live, msgq.msgs_pooled, msgq.queues_live, msgq.queues_pooled);
+
+    auto cmdHandler = trinity::CommandHandler::GetInstance();
+    vlogD(TAG_MAIN "rate limited requests, auth: %" PRIu64 ", read: %" PRIu64 ", write: %" PRIu64,
+          cmdHandler->getRejectedCount(trinity::RateLimiter::Auth),
+          cmdHandler->getRejectedCount(trinity::RateLimiter::Read),
+          cmdHandler->getRejectedCount(trinity::RateLimiter::Write));
 }
 
 static
@@ -106,6 +147,7 @@ void idle_callback(Carrier *c, void *context)
     }
 
     auth_expire_login();
+    stats_log();
 }
 
 static
@@ -124,6 +166,7 @@ void friend_connection_callback(Carrier *c, const char *friend_id,
 {
     (void)c;
     (void)context;
+    PeerId peer;
 
     vlogI(TAG_MAIN "[%s] %s", friend_id, status == CarrierConnectionStatus_Connected ?
                                 "connected" : "disconnected");
@@ -131,12 +174,15 @@ void friend_connection_callback(Carrier *c, const char *friend_id,
     if (status == CarrierConnectionStatus_Connected) {
         ++connecting_clients;
         return;
-    } else
-        trinity::MassDataManager::GetInstance()->removeDataPipe(friend_id);
+    }
+
+    // a peer never interned has nothing to clean up.
+    peer = peer_find(friend_id);
+    trinity::MassDataManager::GetInstance()->removeDataPipe(peer);
 
     --connecting_clients;
-    feeds_deactivate_suber(friend_id);
-    msgq_peer_offline(friend_id);
+    feeds_deactivate_suber(peer);
+    msgq_peer_offline(peer);
 }
 
 static
@@ -309,7 +355,7 @@ int transport_init(FeedsConfig *cfg)
         goto failure;
     }
 
-    rc = trinity::CommandHandler::GetInstance()->config(cfg->data_dir, carrier_instance);
+    rc = trinity::CommandHandler::GetInstance()->config(cfg->data_dir, carrier_instance, cfg->rate_limits);
     if(rc < 0) {
         vlogE(TAG_MAIN "Config command handler failed");
         goto failure;
@@ -88,8 +88,9 @@ void MassDataManager::onSessionRequest(std::weak_ptr<Carrier> carrier,
     dataPipe->processor = std::make_shared<MassDataProcessor>(massDataDir);
 
     // config session.
-    auto unpackedListener = makeUnpackedListener(from);
-    auto connectListener = makeConnectListener(from, unpackedListener);
+    auto peerId = peer_intern(from.c_str());
+    auto unpackedListener = makeUnpackedListener(peerId);
+    auto connectListener = makeConnectListener(peerId, unpackedListener);
 
     dataPipe->session->setSdp(sdp);
     int ret = dataPipe->session->allowConnectAsync(from, connectListener);
@@ -98,18 +99,18 @@ void MassDataManager::onSessionRequest(std::weak_ptr<Carrier> carrier,
     // config parser.
     dataPipe->parser->config(massDataDir / MassData::MassDataCacheDirName);
 
-    appendDataPipe(from, dataPipe);
+    appendDataPipe(peerId, dataPipe);
 }
 
-void MassDataManager::appendDataPipe(const std::string& key, std::shared_ptr<MassDataManager::DataPipe> value)
+void MassDataManager::appendDataPipe(PeerId key, std::shared_ptr<MassDataManager::DataPipe> value)
 {
-    Log::D(Log::Tag::Msg, "append datapipe key=%s,val=%p", key.c_str(), value->session.get());
+    Log::D(Log::Tag::Msg, "append datapipe key=%s,val=%p", peer_name(key), value->session.get());
     dataPipeMap[key] = value;
 }
 
-void MassDataManager::removeDataPipe(const std::string& key)
+void MassDataManager::removeDataPipe(PeerId key)
 {
-    Log::D(Log::Tag::Msg, "remove datapipe key=%s", key.c_str());
+    Log::D(Log::Tag::Msg, "remove datapipe key=%s", peer_name(key));
     dataPipeMap.erase(key);
 }
 
@@ -119,7 +120,7 @@ void MassDataManager::clearAllDataPipe()
     dataPipeMap.clear();
 }
 
-std::shared_ptr<MassDataManager::DataPipe> MassDataManager::find(const std::string& key)
+std::shared_ptr<MassDataManager::DataPipe> MassDataManager::find(PeerId key)
 {
     auto dataPipeIt = dataPipeMap.find(key);
     if(dataPipeIt == dataPipeMap.end()) {
@@ -130,11 +131,11 @@ std::shared_ptr<MassDataManager::DataPipe> MassDataManager::find(const std::stri
     return value;
 }
 
-std::shared_ptr<CarrierSessionHelper::ConnectListener> MassDataManager::makeConnectListener(const std::string& peerId,
+std::shared_ptr<CarrierSessionHelper::ConnectListener> MassDataManager::makeConnectListener(PeerId peerId,
                                                                                       std::shared_ptr<SessionParser::OnUnpackedListener> unpackedListener) {
     struct SessionListener: CarrierSessionHelper::ConnectListener {
         explicit SessionListener(std::weak_ptr<MassDataManager> mgr,
-                                 const std::string& peerId,
+                                 PeerId peerId,
                                  std::shared_ptr<SessionParser::OnUnpackedListener> unpackedListener) {
             this->mgr = mgr;
             this->peerId = peerId;
@@ -161,7 +162,7 @@ std::shared_ptr<CarrierSessionHelper::ConnectListener> MassDataManager::makeConn
 
     private:
         std::weak_ptr<MassDataManager> mgr;
-        std::string peerId;
+        PeerId peerId;
         std::shared_ptr<SessionParser::OnUnpackedListener> unpackedListener;
     };
     auto sessionListener = std::make_shared<SessionListener>(weak_from_this(), peerId, unpackedListener);
@@ -169,7 +170,7 @@ std::shared_ptr<CarrierSessionHelper::ConnectListener> MassDataManager::makeConn
     return sessionListener;
 }
 
-std::shared_ptr<SessionParser::OnUnpackedListener> MassDataManager::makeUnpackedListener(const std::string& peerId)
+std::shared_ptr<SessionParser::OnUnpackedListener> MassDataManager::makeUnpackedListener(PeerId peerId)
 {
     auto unpackedListener = std::make_shared<SessionParser::OnUnpackedListener>([=](
             const std::vector<uint8_t>& headData,
@@ -2,8 +2,8 @@
 #define _MASSDATA_MANAGER_HPP_
 
 #include <memory>
-#include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <CarrierSessionHelper.hpp>
 #include <SessionParser.hpp>
@@ -12,6 +12,10 @@
 struct Carrier;
 struct ElaSession;
 
+extern "C" {
+#include <peers.h>
+}
+
 namespace trinity {
 
 class MassDataProcessor;
@@ -28,7 +32,7 @@ public:
                std::weak_ptr<Carrier> carrier);
     void cleanup();
 
-    void removeDataPipe(const std::string& key);
+    void removeDataPipe(PeerId key);
     void clearAllDataPipe();
 
 protected:
@@ -56,15 +60,15 @@ private:
     void onSessionRequest(std::weak_ptr<Carrier> carrier,
                           const std::string& from, const std::string& sdp);
                         
-    void appendDataPipe(const std::string& key, std::shared_ptr<DataPipe> value);
-    std::shared_ptr<DataPipe> find(const std::string& key);
+    void appendDataPipe(PeerId key, std::shared_ptr<DataPipe> value);
+    std::shared_ptr<DataPipe> find(PeerId key);
 
-    std::shared_ptr<CarrierSessionHelper::ConnectListener> makeConnectListener(const std::string& peerId,
+    std::shared_ptr<CarrierSessionHelper::ConnectListener> makeConnectListener(PeerId peerId,
                                                                                std::shared_ptr<SessionParser::OnUnpackedListener> unpackedListener);
-    std::shared_ptr<SessionParser::OnUnpackedListener> makeUnpackedListener(const std::string& peerId);
+    std::shared_ptr<SessionParser::OnUnpackedListener> makeUnpackedListener(PeerId peerId);
 
     std::filesystem::path massDataDir;
-    std::map<std::string, std::shared_ptr<DataPipe>> dataPipeMap;
+    std::unordered_map<PeerId, std::shared_ptr<DataPipe>> dataPipeMap;
 };
 
 /***********************************************/
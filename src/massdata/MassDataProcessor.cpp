@@ -31,8 +31,8 @@ MassDataProcessor::MassDataProcessor(const std::filesystem::path& massDataDir)
 {
     using namespace std::placeholders;
     mothodHandleMap = {
-        {MassData::Method::SetBinary, {std::bind(&MassDataProcessor::onSetBinary, this, _1, _2, _3), MassData::Accessible::Owner}},
-        {MassData::Method::GetBinary, {std::bind(&MassDataProcessor::onGetBinary, this, _1, _2, _3), MassData::Accessible::Member}},
+        {RPC_METHOD_SET_BINARY, {std::bind(&MassDataProcessor::onSetBinary, this, _1, _2, _3), MassData::Accessible::Owner}},
+        {RPC_METHOD_GET_BINARY, {std::bind(&MassDataProcessor::onGetBinary, this, _1, _2, _3), MassData::Accessible::Member}},
     };
 }
 
@@ -43,24 +43,19 @@ MassDataProcessor::~MassDataProcessor()
 int MassDataProcessor::dispose(const std::vector<uint8_t>& headData,
                                const std::filesystem::path& bodyPath)
 {
+    std::vector<uint8_t> reqData = headData; // head is small, req borrows from the copy.
     std::shared_ptr<Req> req;
     std::shared_ptr<Resp> resp;
-    int ret = CommandHandler::GetInstance()->unpackRequest(headData, req);
+    int ret = CommandHandler::GetInstance()->unpackRequest(reqData, req);
     if(ret >= 0) {
         Log::D(Log::Tag::Msg, "Mass data processor: dispose method [%s]", req->method);
         ret = ErrCode::UnimplementedError;
-        for (const auto& it : mothodHandleMap) {
-            if (std::strcmp(it.first, req->method) != 0) {
-                continue;
+        auto it = mothodHandleMap.find(Rpc::MethodTable::Id(req->method));
+        if (it != mothodHandleMap.end()) {
+            ret = checkAccessible(it->second.accessible, reinterpret_cast<TkReq*>(req.get())->params.tk);
+            if(ret >= 0) {
+                ret = it->second.callback(req, bodyPath, resp);
             }
-
-            ret = checkAccessible(it.second.accessible, reinterpret_cast<TkReq*>(req.get())->params.tk);
-            if(ret < 0) {
-                break;
-            }
-
-            ret = it.second.callback(req, bodyPath, resp);
-            break;
         }
     }
 
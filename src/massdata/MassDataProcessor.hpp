@@ -64,7 +64,7 @@ private:
     int isMember(const std::string& accessToken);
     int getUserInfo(const std::string& accessToken, std::shared_ptr<UserInfo>& userInfo);
 
-    std::map<const char*, Handler> mothodHandleMap;
+    std::map<RpcMethod, Handler> mothodHandleMap;
 
     std::vector<uint8_t> resultHeadData;
     std::filesystem::path resultBodyPath;
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2020 trinity-tech
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __METHOD_H__
+#define __METHOD_H__
+
+#include <stddef.h>
+
+/*
+ * Every RPC method served by feedsd. The list feeds the RpcMethod ids
+ * and the compile time perfect hash table that maps names to them
+ * (feedsd-ext/RpcMethod.hpp), so routing never compares method names.
+ */
+#define RPC_METHODS(X)                                                  \
+    X(DECL_OWNER          , "declare_owner"                     )       \
+    X(IMP_DID             , "import_did"                        )       \
+    X(ISS_VC              , "issue_credential"                  )       \
+    X(UPDATE_VC           , "update_credential"                 )       \
+    X(SIGNIN_REQ_CHAL     , "signin_request_challenge"          )       \
+    X(SIGNIN_CONF_CHAL    , "signin_confirm_challenge"          )       \
+    X(CREATE_CHAN         , "create_channel"                    )       \
+    X(UPD_CHAN            , "update_feedinfo"                   )       \
+    X(UPD_USER_INFO       , "update_user_info"                  )       \
+    X(PUB_POST            , "publish_post"                      )       \
+    X(DECLARE_POST        , "declare_post"                      )       \
+    X(NOTIFY_POST         , "notify_post"                       )       \
+    X(EDIT_POST           , "edit_post"                         )       \
+    X(DEL_POST            , "delete_post"                       )       \
+    X(POST_CMT            , "post_comment"                      )       \
+    X(EDIT_CMT            , "edit_comment"                      )       \
+    X(DEL_CMT             , "delete_comment"                    )       \
+    X(BLOCK_CMT           , "block_comment"                     )       \
+    X(UNBLOCK_CMT         , "unblock_comment"                   )       \
+    X(POST_LIKE           , "post_like"                         )       \
+    X(POST_UNLIKE         , "post_unlike"                       )       \
+    X(GET_MY_CHANS        , "get_my_channels"                   )       \
+    X(GET_MY_CHANS_META   , "get_my_channels_metadata"          )       \
+    X(GET_CHANS           , "get_channels"                      )       \
+    X(GET_CHAN_DTL        , "get_channel_detail"                )       \
+    X(GET_SUB_CHANS       , "get_subscribed_channels"           )       \
+    X(GET_POSTS           , "get_posts"                         )       \
+    X(GET_POSTS_LAC       , "get_posts_likes_and_comments"      )       \
+    X(GET_LIKED_POSTS     , "get_liked_posts"                   )       \
+    X(GET_LIKED_DATA      , "get_liked_data"                    )       \
+    X(GET_CMTS            , "get_comments"                      )       \
+    X(GET_CMTS_LIKES      , "get_comments_likes"                )       \
+    X(GET_STATS           , "get_statistics"                    )       \
+    X(SUB_CHAN            , "subscribe_channel"                 )       \
+    X(UNSUB_CHAN          , "unsubscribe_channel"               )       \
+    X(ENBL_NOTIF          , "enable_notification"               )       \
+    X(SET_BINARY          , "set_binary"                        )       \
+    X(GET_BINARY          , "get_binary"                        )       \
+    X(GET_SRV_VER         , "get_service_version"               )       \
+    X(REPORT_ILLEGAL_CMT  , "report_illegal_comment"            )       \
+    X(GET_REPORTED_CMTS   , "get_reported_comments"             )       \
+    X(STANDARD_SIGN_IN    , "standard_sign_in"                  )       \
+    X(STANDARD_DID_AUTH   , "standard_did_auth"                 )       \
+    X(GET_MULTI_CMTS      , "get_multi_comments"                )       \
+    X(GET_MULTI_LAC_COUNT , "get_multi_likes_and_comments_count")       \
+    X(GET_MULTI_SUBS_COUNT, "get_multi_subscribers_count"       )       \
+    X(BATCH               , "batch"                             )       \
+    X(SYNC_CHANGES        , "sync_changes"                      )       \
+    X(GET_TIMELINE        , "get_timeline"                      )       \
+    X(GET_CMT_THREAD      , "get_comment_thread"                )
+
+typedef enum {
+    RPC_METHOD_UNKNOWN = 0,
+#define RPC_METHOD_ENUM(id, name) RPC_METHOD_##id,
+    RPC_METHODS(RPC_METHOD_ENUM)
+#undef RPC_METHOD_ENUM
+    RPC_METHOD_COUNT
+} RpcMethod;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+RpcMethod rpc_method_id(const char *name, size_t len);
+const char *rpc_method_name(RpcMethod method);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //__METHOD_H__
@@ -20,134 +20,376 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <carrier.h>
 #include <crystal.h>
 #include <inttypes.h>
+#include <zlib.h>
 
 #undef static_assert // fix double conflict between crystal and std functional
 #include <CommandHandler.hpp>
+#include <ObjectPool.hpp>
 #include "msgq.h"
 
 #define TAG_MSG "[Feedsd.Msg ]: "
 
+// room kept in each frame for the fragment envelope.
+#define FRAGMENT_HDR_LEN  64
+#define FRAGMENT_DATA_LEN (MSGQ_FRAME_LEN - FRAGMENT_HDR_LEN)
+#define FRAGMENT_KEY      "fragment"
+#define COMPRESSED_KEY    "compressed"
+
+// messages and queues come and go with every notification, they are pooled.
+struct Msg {
+    Msg *next = NULL;
+    std::atomic<uint32_t> refs {1};
+    Marshalled *data = NULL;
+    uint64_t frag_id = 0;
+    uint32_t frag_idx = 0;
+    uint32_t frag_cnt = 0;
+};
+
+struct MsgQ {
+    std::atomic<uint32_t> refs {1};
+    PeerId peer = PEER_NONE;
+    Msg *head = NULL;  // queued messages, each holding a reference
+    Msg *tail = NULL;
+    Msg *cur = NULL;
+    bool depr = false;
+};
+
+using MsgPool = trinity::ObjectPool<Msg>;
+using MsgQPool = trinity::ObjectPool<MsgQ>;
+
 typedef struct {
-    linked_hash_entry_t he;
-    char peer[CARRIER_MAX_ID_LEN + 1];
-    linked_list_t *q;
-    bool depr;
-} MsgQ;
+    uint64_t id;
+    uint32_t next;
+    uint32_t count;
+    std::vector<uint8_t> data;
+} Reassembly;
 
 typedef struct {
-    linked_list_entry_t le;
-    Marshalled *data;
-} Msg;
+    PeerId peer;
+    MsgqCaptureCallback *cb;
+    void *context;
+} Capture;
+
+// deflate stream reused by all the messages compressed on a thread.
+struct Deflater {
+    z_stream zs {};
+    bool ready = false;
+    std::vector<uint8_t> out;
+
+    ~Deflater()
+    {
+        if (ready)
+            deflateEnd(&zs);
+    }
+};
+
+struct FrameWriter {
+    std::vector<uint8_t> &frame;
+
+    void write(const char *buf, size_t len)
+    {
+        frame.insert(frame.end(), buf, buf + len);
+    }
+};
 
 extern Carrier *carrier;
 
-static linked_hashtable_t *msgqs;
+static std::unordered_map<PeerId, MsgQ *> msgqs;
 static std::recursive_mutex mutex;
+static uint64_t next_frag_id;
+static std::unordered_map<PeerId, Reassembly> reassemblies;
+static std::unordered_set<PeerId> compressed_peers;
+static thread_local Capture capture;
+static thread_local Deflater deflater;
+
+static inline
+Msg *msg_ref(Msg *m)
+{
+    ++m->refs;
+    return m;
+}
+
+static
+void msg_deref(Msg *m)
+{
+    if (!m || --m->refs)
+        return;
+
+    deref(m->data);
+    MsgPool::Release(m);
+}
+
+static inline
+MsgQ *msgq_ref(MsgQ *q)
+{
+    ++q->refs;
+    return q;
+}
+
+static
+void msgq_deref(MsgQ *q)
+{
+    Msg *m;
+
+    if (!q || --q->refs)
+        return;
+
+    msg_deref(q->cur);
+    while ((m = q->head)) {
+        q->head = m->next;
+        msg_deref(m);
+    }
+    MsgQPool::Release(q);
+}
 
 static inline
-MsgQ *msgq_get(const char *peer)
+MsgQ *msgq_get(PeerId peer)
 {
     std::lock_guard<decltype(mutex)> lock(mutex);
-    return (MsgQ*)linked_hashtable_get(msgqs, peer, strlen(peer));
+    auto it = msgqs.find(peer);
+    return it != msgqs.end() ? msgq_ref(it->second) : NULL;
 }
 
 static inline
 MsgQ *msgq_put(MsgQ *q)
 {
     std::lock_guard<decltype(mutex)> lock(mutex);
-    return (MsgQ*)linked_hashtable_put(msgqs, &q->he);
+    MsgQ *&slot = msgqs[q->peer];
+    msgq_deref(slot);
+    slot = msgq_ref(q);
+    return q;
 }
 
 static inline
-MsgQ *msgq_rm(const char *peer)
+MsgQ *msgq_rm(PeerId peer)
 {
     std::lock_guard<decltype(mutex)> lock(mutex);
-    return (MsgQ*)linked_hashtable_remove(msgqs, peer, strlen(peer));
+    auto it = msgqs.find(peer);
+    if (it == msgqs.end())
+        return NULL;
+
+    MsgQ *q = it->second;
+    msgqs.erase(it);
+    return q;
 }
 
 static inline
 Msg *msgq_pop_head(MsgQ *q)
 {
     std::lock_guard<decltype(mutex)> lock(mutex);
-    return (Msg*)(linked_list_is_empty(q->q) ? NULL : linked_list_pop_head(q->q));
+    Msg *m = q->head;
+    if (m) {
+        q->head = m->next;
+        if (!q->head)
+            q->tail = NULL;
+        m->next = NULL;
+    }
+    return m;
 }
 
 static inline
-void msgq_push_tail(MsgQ *q, Msg *m)
+Msg *msgq_cur(MsgQ *q)
 {
     std::lock_guard<decltype(mutex)> lock(mutex);
-    linked_list_push_tail(q->q, &m->le);
+    return q->cur ? msg_ref(q->cur) : NULL;
 }
 
-static
-void msg_dtor(void *obj)
+static inline
+void msgq_push_tail(MsgQ *q, Msg *m)
 {
     std::lock_guard<decltype(mutex)> lock(mutex);
-    Msg *msg = (Msg*)obj;
-
-    deref(msg->data);
+    if (q->tail)
+        q->tail->next = msg_ref(m);
+    else
+        q->head = msg_ref(m);
+    q->tail = m;
 }
 
 static
 Msg *msg_create(Marshalled *msg)
 {
     std::lock_guard<decltype(mutex)> lock(mutex);
-    Msg *m = (Msg*)rc_zalloc(sizeof(Msg), msg_dtor);
+    Msg *m = MsgPool::Acquire();
     if (!m)
         return NULL;
 
-    m->le.data = m;
-    m->data    = (Marshalled*)ref(msg);
+    m->data = (Marshalled*)ref(msg);
+
+    if (msg->sz > MSGQ_FRAME_LEN) {
+        m->frag_id  = ++next_frag_id;
+        m->frag_cnt = (msg->sz + FRAGMENT_DATA_LEN - 1) / FRAGMENT_DATA_LEN;
+    }
 
     return m;
 }
 
 static
-void msgq_dtor(void *obj)
+bool peer_compression(PeerId peer)
 {
     std::lock_guard<decltype(mutex)> lock(mutex);
-    MsgQ *q = (MsgQ*)obj;
-
-    deref(q->q);
+    return compressed_peers.count(peer) > 0;
 }
 
+/*
+ * Returns the compressed envelope of msg, or NULL if msg does not gain
+ * enough from compression to be worth it.
+ */
 static
-MsgQ *msgq_create(const char *to)
+Marshalled *msg_compress(const Marshalled *msg)
 {
-    std::lock_guard<decltype(mutex)> lock(mutex);
-    MsgQ *q = (MsgQ*)rc_zalloc(sizeof(MsgQ), msgq_dtor);
-    if (!q)
+    Deflater &d = deflater;
+    std::vector<uint8_t> hdr;
+    Marshalled *z;
+    size_t len;
+
+    if (!d.ready) {
+        if (deflateInit(&d.zs, Z_DEFAULT_COMPRESSION) != Z_OK) {
+            vlogE(TAG_MSG "Initializing deflate stream failed.");
+            return NULL;
+        }
+        d.ready = true;
+    } else
+        deflateReset(&d.zs);
+
+    d.out.resize(deflateBound(&d.zs, msg->sz));
+    d.zs.next_in   = (Bytef *)msg->data;
+    d.zs.avail_in  = msg->sz;
+    d.zs.next_out  = d.out.data();
+    d.zs.avail_out = d.out.size();
+    if (deflate(&d.zs, Z_FINISH) != Z_STREAM_END) {
+        vlogE(TAG_MSG "Deflating message failed.");
+        return NULL;
+    }
+    len = d.zs.total_out;
+
+    FrameWriter writer{hdr};
+    msgpack::packer<FrameWriter> pk(writer);
+
+    pk.pack_map(1);
+    pk.pack(COMPRESSED_KEY);
+    pk.pack_map(3);
+    pk.pack("algo");
+    pk.pack(MSGQ_COMPRESS_ALGO);
+    pk.pack("size");
+    pk.pack(msg->sz);
+    pk.pack("data");
+    pk.pack_bin(len);
+
+    if (hdr.size() + len > msg->sz - msg->sz / MSGQ_COMPRESS_MIN_GAIN)
         return NULL;
 
-    q->q = linked_list_create(0, NULL);
-    if (!q->q) {
-        deref(q);
+    z = (Marshalled *)rc_zalloc(sizeof(Marshalled) + hdr.size() + len, NULL);
+    if (!z)
         return NULL;
+
+    z->data = z + 1;
+    z->sz   = hdr.size() + len;
+    memcpy(z->data, hdr.data(), hdr.size());
+    memcpy((uint8_t *)z->data + hdr.size(), d.out.data(), len);
+
+    vlogD(TAG_MSG "Compressed message from %zu to %zu bytes.", msg->sz, z->sz);
+
+    return z;
+}
+
+static
+void msg_next_frame(Msg *m, std::vector<uint8_t> &frame)
+{
+    const uint8_t *data = reinterpret_cast<uint8_t*>(m->data->data);
+    size_t off;
+    size_t len;
+
+    if (!m->frag_cnt) {
+        frame.assign(data, data + m->data->sz);
+        return;
     }
 
-    strcpy(q->peer, to);
-    q->he.data   = q;
-    q->he.key    = q->peer;
-    q->he.keylen = strlen(q->peer);
+    off = (size_t)m->frag_idx * FRAGMENT_DATA_LEN;
+    len = std::min<size_t>(FRAGMENT_DATA_LEN, m->data->sz - off);
+
+    FrameWriter writer{frame};
+    msgpack::packer<FrameWriter> pk(writer);
+
+    frame.reserve(len + FRAGMENT_HDR_LEN);
+    pk.pack_map(1);
+    pk.pack(FRAGMENT_KEY);
+    pk.pack_map(4);
+    pk.pack("id");
+    pk.pack(m->frag_id);
+    pk.pack("index");
+    pk.pack(m->frag_idx);
+    pk.pack("count");
+    pk.pack(m->frag_cnt);
+    pk.pack("data");
+    pk.pack_bin(len);
+    pk.pack_bin_body(reinterpret_cast<const char*>(data + off), len);
+
+    ++m->frag_idx;
+}
+
+static
+MsgQ *msgq_create(PeerId to)
+{
+    MsgQ *q = MsgQPool::Acquire();
+    if (!q)
+        return NULL;
+
+    q->peer = to;
 
     return q;
 }
 
+static void on_msg_receipt(uint32_t msgid, CarrierReceiptState state, void *context);
+
+/*
+ * Send the next frame of m, a message with frames left stays as the
+ * current one of q until its last fragment is handed out.
+ */
+static
+void msgq_send(MsgQ *q, Msg *m)
+{
+    std::vector<uint8_t> data;
+
+    {
+        std::lock_guard<decltype(mutex)> lock(mutex);
+
+        msg_next_frame(m, data);
+        if (q->cur != m && m->frag_idx < m->frag_cnt) {
+            msg_deref(q->cur);
+            q->cur = msg_ref(m);
+        } else if (q->cur == m && m->frag_idx >= m->frag_cnt) {
+            msg_deref(q->cur);
+            q->cur = NULL;
+        }
+    }
+
+    if (m->frag_cnt)
+        vlogD(TAG_MSG "Send fragment %" PRIu32 "/%" PRIu32 " of message %" PRIu64 " to %s.",
+              m->frag_idx, m->frag_cnt, m->frag_id, peer_name(q->peer));
+
+    std::ignore = trinity::CommandHandler::GetInstance()->send(q->peer, data, on_msg_receipt, msgq_ref(q));
+}
+
 static
 void on_msg_receipt(uint32_t msgid, CarrierReceiptState state, void *context)
 {
     MsgQ *q = (MsgQ*)context;
     Msg *m = NULL;
-    std::vector<uint8_t> data;
 
     (void)msgid;
     (void)state;
 
-    vlogD(TAG_MSG "Message %lu to %s receipt status: %s", msgid, q->peer,
+    vlogD(TAG_MSG "Message %lu to %s receipt status: %s", msgid, peer_name(q->peer),
           state == CarrierReceipt_ByFriend ? "received" :
                    state == CarrierReceipt_Offline ? "friend offline" : "error");
   
@@ -160,37 +402,54 @@ void on_msg_receipt(uint32_t msgid, CarrierReceiptState state, void *context)
         goto finally;
     }
 
-    if (!(m = msgq_pop_head(q))) {
+    m = msgq_cur(q);
+    if (!m && !(m = msgq_pop_head(q))) {
         vlogD(TAG_MSG "Transport channel becomes idle.");
-        deref(msgq_rm(q->peer));
+        msgq_deref(msgq_rm(q->peer));
         goto finally;
     }
 
-    data = std::move(std::vector<uint8_t>{ reinterpret_cast<uint8_t*>(m->data->data),
-                                           reinterpret_cast<uint8_t*>(m->data->data) + m->data->sz });
-    std::ignore = trinity::CommandHandler::GetInstance()->send(q->peer, data, on_msg_receipt, ref(q));
+    msgq_send(q, m);
 
 finally:
-    deref(q);
-    deref(m);
+    msgq_deref(q);
+    msg_deref(m);
 }
 
 int msgq_enq(const char *to, Marshalled *msg)
 {
+    PeerId peer = peer_intern(to);
+    if (peer == PEER_NONE)
+        return -1;
+
+    return msgq_enq_peer(peer, msg);
+}
+
+int msgq_enq_peer(PeerId to, Marshalled *msg)
+{
+    Marshalled *z = NULL;
     MsgQ *q = NULL;
     Msg *m = NULL;
     int rc = -1;
-    std::vector<uint8_t> data;
+
+    if (capture.cb && capture.peer == to) {
+        capture.cb(msg, capture.context);
+        return 0;
+    }
+
+    if (msg->sz >= MSGQ_COMPRESS_MIN_LEN && peer_compression(to))
+        z = msg_compress(msg);
+
+    m = msg_create(z ? z : msg);
+    deref(z);
+    if (!m) {
+        vlogE(TAG_MSG "Creating message failed.");
+        goto finally;
+    }
 
     q = msgq_get(to);
     if (q) {
-        vlogD(TAG_MSG "Transport channel[%s] is busy, put in message queue.", to);
-
-        m = msg_create(msg);
-        if (!m) {
-            vlogE(TAG_MSG "Creating message failed.");
-            goto finally;
-        }
+        vlogD(TAG_MSG "Transport channel[%s] is busy, put in message queue.", peer_name(to));
 
         msgq_push_tail(q, m);
         rc = 0;
@@ -203,39 +462,151 @@ int msgq_enq(const char *to, Marshalled *msg)
         goto finally;
     }
 
-    data = std::move(std::vector<uint8_t>{ reinterpret_cast<uint8_t*>(msg->data),
-                                           reinterpret_cast<uint8_t*>(msg->data) + msg->sz });
-    std::ignore = trinity::CommandHandler::GetInstance()->send(to, data, on_msg_receipt, ref(q));
-
     msgq_put(q);
+    msgq_send(q, m);
     rc = 0;
 
 finally:
-    deref(q);
-    deref(m);
+    msgq_deref(q);
+    msg_deref(m);
     return rc;
 }
 
-void msgq_peer_offline(const char *peer)
+void msgq_capture_begin(PeerId peer, MsgqCaptureCallback *cb, void *context)
+{
+    capture.peer = peer;
+    capture.cb = cb;
+    capture.context = context;
+}
+
+void msgq_capture_end()
+{
+    capture = {};
+}
+
+int msgq_reassemble(PeerId from, const void *frame, size_t len, Marshalled **msg)
+{
+    static const char prefix[] = "\x81\xa8" FRAGMENT_KEY;
+    msgpack::object_handle handle;
+    uint64_t id = 0;
+    uint32_t index = UINT32_MAX;
+    uint32_t count = 0;
+    const char *data = NULL;
+    size_t data_len = 0;
+    Marshalled *whole;
+
+    *msg = NULL;
+
+    // the envelope is the only key of the map, so a fragment always starts with it.
+    if (len < sizeof(prefix) - 1 || memcmp(frame, prefix, sizeof(prefix) - 1))
+        return 0;
+
+    try {
+        msgpack::unpack_reference_func ref_all = [](msgpack::type::object_type, std::size_t, void*) { return true; };
+        handle = msgpack::unpack((const char *)frame, len, ref_all);
+
+        const msgpack::object &env = handle.get().via.map.ptr[0].val;
+        if (env.type != msgpack::type::MAP)
+            throw msgpack::type_error();
+
+        for (uint32_t i = 0; i < env.via.map.size; i++) {
+            const msgpack::object_kv &kv = env.via.map.ptr[i];
+            std::string key = kv.key.as<std::string>();
+
+            if (key == "id")
+                id = kv.val.as<uint64_t>();
+            else if (key == "index")
+                index = kv.val.as<uint32_t>();
+            else if (key == "count")
+                count = kv.val.as<uint32_t>();
+            else if (key == "data" && kv.val.type == msgpack::type::BIN) {
+                data = kv.val.via.bin.ptr;
+                data_len = kv.val.via.bin.size;
+            }
+        }
+    } catch (const std::exception &e) {
+        vlogE(TAG_MSG "Invalid fragment from %s: %s", peer_name(from), e.what());
+        return -1;
+    }
+
+    std::lock_guard<decltype(mutex)> lock(mutex);
+    Reassembly &r = reassemblies[from];
+
+    if (index == 0) {
+        r.id = id;
+        r.next = 0;
+        r.count = count;
+        r.data.clear();
+    }
+
+    if (!data || !count || r.id != id || r.count != count || r.next != index ||
+        r.data.size() + data_len > MSGQ_MAX_REASSEMBLED_LEN) {
+        vlogE(TAG_MSG "Dropped fragment %" PRIu32 "/%" PRIu32 " of message %" PRIu64 " from %s.",
+              index, count, id, peer_name(from));
+        reassemblies.erase(from);
+        return -1;
+    }
+
+    r.data.insert(r.data.end(), data, data + data_len);
+    if (++r.next < r.count)
+        return 1;
+
+    whole = (Marshalled *)rc_zalloc(sizeof(Marshalled) + r.data.size(), NULL);
+    if (whole) {
+        whole->data = whole + 1;
+        whole->sz = r.data.size();
+        memcpy(whole->data, r.data.data(), r.data.size());
+    }
+    reassemblies.erase(from);
+
+    if (!whole)
+        return -1;
+
+    *msg = whole;
+    return 1;
+}
+
+void msgq_peer_offline(PeerId peer)
 {
     MsgQ *q = msgq_rm(peer);
 
+    {
+        std::lock_guard<decltype(mutex)> lock(mutex);
+        reassemblies.erase(peer);
+        compressed_peers.erase(peer);
+    }
+
     if (q) {
-        vlogD(TAG_MSG "Set message queue[%s] deprecated.", q->peer);
+        vlogD(TAG_MSG "Set message queue[%s] deprecated.", peer_name(q->peer));
         q->depr = true;
     }
 
-    deref(q);
+    msgq_deref(q);
 }
 
-int msgq_init()
+void msgq_set_compression(PeerId peer, bool enable)
 {
-    msgqs = linked_hashtable_create(8, 0, NULL, NULL);
-    if (!msgqs) {
-        vlogE(TAG_MSG "Creating message queues failed");
-        return -1;
-    }
+    std::lock_guard<decltype(mutex)> lock(mutex);
+
+    if (enable)
+        compressed_peers.insert(peer);
+    else
+        compressed_peers.erase(peer);
+}
 
+void msgq_get_stats(MsgqStats *stats)
+{
+    MsgPool::Stats msg = MsgPool::GetStats();
+    MsgQPool::Stats q = MsgQPool::GetStats();
+
+    stats->msgs_live     = msg.live;
+    stats->msgs_pooled   = msg.pooled;
+    stats->queues_live   = q.live;
+    stats->queues_pooled = q.pooled;
+}
+
+int msgq_init()
+{
     vlogI(TAG_MSG "Message queue module initialized.");
 
     return 0;
@@ -243,5 +614,19 @@ int msgq_init()
 
 void msgq_deinit()
 {
-    deref(msgqs);
+    MsgqStats stats;
+
+    {
+        std::lock_guard<decltype(mutex)> lock(mutex);
+        for (auto &kv : msgqs)
+            msgq_deref(kv.second);
+        msgqs.clear();
+    }
+    reassemblies.clear();
+    compressed_peers.clear();
+
+    msgq_get_stats(&stats);
+    vlogI(TAG_MSG "Message queue module deinitialized, messages live: %zu, pooled: %zu, "
+          "queues live: %zu, pooled: %zu.", stats.msgs_live, stats.msgs_pooled,
+          stats.queues_live, stats.queues_pooled);
 }
@@ -23,16 +23,73 @@
 #ifndef __MSGQ_H__
 #define __MSGQ_H__
 
+#include <carrier.h>
+
+#include "peers.h"
 #include "rpc.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*
+ * Messages larger than one carrier bulk message are cut into fragment
+ * frames on the way out and sent back to back. A fragment frame is a
+ * msgpack map with the single key "fragment":
+ *
+ *   {"fragment": {"id": uint, "index": uint, "count": uint, "data": bin}}
+ *
+ * Concatenating the data of fragments 0..count-1 with the same id gives
+ * the original message. Peers may fragment their requests the same way,
+ * msgq_reassemble() collects them in order.
+ */
+#define MSGQ_FRAME_LEN            CARRIER_MAX_APP_BULKMSG_LEN
+#define MSGQ_MAX_REASSEMBLED_LEN  (64 * 1024 * 1024)
+
+/*
+ * Peers that enabled compression get their messages of at least
+ * MSGQ_COMPRESS_MIN_LEN bytes deflated (zlib format) and wrapped before
+ * fragmentation as:
+ *
+ *   {"compressed": {"algo": "deflate", "size": uint, "data": bin}}
+ *
+ * size is the length of the inflated message. Messages that do not
+ * shrink by at least 1/MSGQ_COMPRESS_MIN_GAIN are sent as they are.
+ */
+#define MSGQ_COMPRESS_ALGO     "deflate"
+#define MSGQ_COMPRESS_MIN_LEN  1024
+#define MSGQ_COMPRESS_MIN_GAIN 8
+
+typedef struct {
+    size_t msgs_live;
+    size_t msgs_pooled;
+    size_t queues_live;
+    size_t queues_pooled;
+} MsgqStats;
+
 int msgq_init();
 void msgq_deinit();
+void msgq_get_stats(MsgqStats *stats);
 int msgq_enq(const char *to, Marshalled *msg);
-void msgq_peer_offline(const char *peer);
+int msgq_enq_peer(PeerId to, Marshalled *msg);
+void msgq_peer_offline(PeerId peer);
+void msgq_set_compression(PeerId peer, bool enable);
+
+/*
+ * While a capture is open on the calling thread, messages queued to its
+ * peer by that thread are handed to cb instead of being sent. cb must
+ * ref() the message to keep it.
+ */
+typedef void MsgqCaptureCallback(Marshalled *msg, void *context);
+void msgq_capture_begin(PeerId peer, MsgqCaptureCallback *cb, void *context);
+void msgq_capture_end();
+
+/*
+ * Returns 0 if frame is not a fragment, a positive value if the fragment
+ * is consumed, in which case msg is set to the reassembled message once
+ * the last fragment arrived, or -1 if the fragment is dropped.
+ */
+int msgq_reassemble(PeerId from, const void *frame, size_t len, Marshalled **msg);
 
 #ifdef __cplusplus
 } // extern "C"
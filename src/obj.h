@@ -23,7 +23,10 @@
 #ifndef __OBJ_H__
 #define __OBJ_H__
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #define CHAN_ID_START 1
 #define POST_ID_START 1
@@ -50,8 +53,79 @@ typedef struct {
     uint64_t upper;
     uint64_t lower;
     uint64_t maxcnt;
+    uint64_t fields;
+    const void *cursor;  // QryCursor to resume after, packed
+    size_t   cursor_len;
+    const void *known_tags;  // (id, tag) pairs the client has, see obj_tag()
+    size_t   known_tags_len;
 } QryCriteria;
 
+/*
+ * Position of the last item of a page sorted by `by`: the value of that
+ * column and the primary key of the item, which breaks ties between
+ * equal values. Clients get it packed as an opaque blob with each page
+ * and hand it back to read the next one.
+ */
+typedef struct {
+    uint64_t by;
+    uint64_t val;
+    uint64_t id[2];
+} QryCursor;
+
+#define QRY_CURSOR_LEN 32
+
+static inline
+void qry_cursor_pack(const QryCursor *cur, uint8_t *buf)
+{
+    const uint64_t u64s[] = {cur->by, cur->val, cur->id[0], cur->id[1]};
+    size_t i, j;
+
+    for (i = 0; i < 4; i++) {
+        for (j = 0; j < 8; j++)
+            buf[i * 8 + j] = (uint8_t)(u64s[i] >> (56 - j * 8));
+    }
+}
+
+static inline
+bool qry_cursor_unpack(const void *data, size_t len, QryCursor *cur)
+{
+    const uint8_t *buf = (const uint8_t *)data;
+    uint64_t u64s[4] = {0};
+    size_t i, j;
+
+    if (len != QRY_CURSOR_LEN)
+        return false;
+
+    for (i = 0; i < 4; i++) {
+        for (j = 0; j < 8; j++)
+            u64s[i] = u64s[i] << 8 | buf[i * 8 + j];
+    }
+
+    cur->by    = u64s[0];
+    cur->val   = u64s[1];
+    cur->id[0] = u64s[2];
+    cur->id[1] = u64s[3];
+    return cur->by != NONE && qry_fld_is_valid(cur->by);
+}
+
+/*
+ * Optional fields of the items listed by get_channels, get_posts and
+ * get_comments. A query names the ones it wants in QryCriteria.fields,
+ * the rest are neither read from the database nor packed into the
+ * response. An empty mask asks for every field.
+ */
+#define PROJ_CONTENT     (1 << 0)  // posts and comments
+#define PROJ_THUMBNAILS  (1 << 1)  // posts and comments
+#define PROJ_HASH_ID     (1 << 2)  // posts and comments
+#define PROJ_PROOF       (1 << 3)  // channels, posts and comments
+#define PROJ_ORIGIN_URL  (1 << 4)  // posts
+#define PROJ_INTRO       (1 << 5)  // channels
+#define PROJ_AVATAR      (1 << 6)  // channels
+#define PROJ_TIP_METHODS (1 << 7)  // channels
+#define PROJ_NOT_MODIFIED (1ULL << 63)  // set by the server, see obj_tag()
+
+#define proj_has(fields, fld) (!(fields) || ((fields) & (fld)))
+
 typedef struct {
     uint64_t uid;
     char    *did;
@@ -78,6 +152,7 @@ typedef struct {
     const char *tip_methods;  //v2.0
     const char *proof;  //v2.0
     uint64_t    status;  //2.0
+    uint64_t    fields;  // projection it was loaded with
 } ChanInfo;
 
 typedef enum {
@@ -119,8 +194,98 @@ typedef struct {
     const char *hash_id;  //2.0
     const char *proof;  //2.0
     const char *origin_post_url;  //2.0
+    uint64_t    fields;  // projection it was loaded with
 } PostInfo;
 
+/*
+ * Version tag of a channel or a post: a hash of its updated_at, status
+ * and every field a not_modified item leaves out. Items are listed with
+ * their "tag" and clients hand the tags they hold back as a bin of
+ * (id, tag) pairs, both 64-bit big-endian. An item whose tag is known is
+ * then sent without those fields and flagged "not_modified", its
+ * counters are always fresh.
+ */
+#define OBJ_TAG_SEED  0xcbf29ce484222325ULL
+#define OBJ_TAG_PRIME 0x100000001b3ULL
+#define KNOWN_TAG_LEN 16
+
+static inline
+uint64_t obj_tag(uint64_t tag, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint64_t w;
+
+    for (; len >= sizeof(w); p += sizeof(w), len -= sizeof(w)) {
+        memcpy(&w, p, sizeof(w));
+        tag = (tag ^ w) * OBJ_TAG_PRIME;
+        tag ^= tag >> 32;
+    }
+    for (; len; ++p, --len)
+        tag = (tag ^ *p) * OBJ_TAG_PRIME;
+
+    return tag;
+}
+
+static inline
+uint64_t obj_tag_str(uint64_t tag, const char *str)
+{
+    return str ? obj_tag(tag, str, strlen(str) + 1) : obj_tag(tag, "", 1);
+}
+
+static inline
+uint64_t chan_tag(const ChanInfo *ci)
+{
+    uint64_t tag = OBJ_TAG_SEED;
+
+    tag = obj_tag(tag, &ci->upd_at, sizeof(ci->upd_at));
+    tag = obj_tag(tag, &ci->status, sizeof(ci->status));
+    tag = obj_tag_str(tag, ci->name);
+    tag = obj_tag_str(tag, ci->intro);
+    tag = obj_tag_str(tag, ci->owner ? ci->owner->name : NULL);
+    tag = obj_tag_str(tag, ci->tip_methods);
+    tag = obj_tag_str(tag, ci->proof);
+    return obj_tag(tag, ci->avatar, ci->len);
+}
+
+static inline
+uint64_t post_tag(const PostInfo *pi)
+{
+    uint64_t tag = OBJ_TAG_SEED;
+    uint64_t stat = pi->stat;
+
+    tag = obj_tag(tag, &pi->upd_at, sizeof(pi->upd_at));
+    tag = obj_tag(tag, &stat, sizeof(stat));
+    tag = obj_tag_str(tag, pi->hash_id);
+    tag = obj_tag_str(tag, pi->proof);
+    tag = obj_tag_str(tag, pi->origin_post_url);
+    tag = obj_tag(tag, pi->content, pi->con_len);
+    return obj_tag(tag, pi->thumbnails, pi->thu_len);
+}
+
+// only items loaded with all their tagged fields have a tag.
+#define CHAN_TAG_FIELDS (PROJ_INTRO | PROJ_AVATAR | PROJ_TIP_METHODS | PROJ_PROOF)
+#define POST_TAG_FIELDS (PROJ_CONTENT | PROJ_THUMBNAILS | PROJ_HASH_ID | PROJ_PROOF | PROJ_ORIGIN_URL)
+#define chan_has_tag(ci) (!(ci)->fields || ((ci)->fields & CHAN_TAG_FIELDS) == CHAN_TAG_FIELDS)
+#define post_has_tag(pi) (!(pi)->fields || ((pi)->fields & POST_TAG_FIELDS) == POST_TAG_FIELDS)
+
+static inline
+bool known_tag_matches(const QryCriteria *qc, uint64_t id, uint64_t tag)
+{
+    const uint8_t *p = (const uint8_t *)qc->known_tags;
+    size_t i, j;
+
+    for (i = 0; i + KNOWN_TAG_LEN <= qc->known_tags_len; i += KNOWN_TAG_LEN) {
+        uint64_t u64s[2] = {0};
+
+        for (j = 0; j < KNOWN_TAG_LEN; j++)
+            u64s[j / 8] = u64s[j / 8] << 8 | p[i + j];
+        if (u64s[0] == id)
+            return u64s[1] == tag;
+    }
+
+    return false;
+}
+
 typedef enum {
     CMT_AVAILABLE,
     CMT_DELETED,
@@ -159,8 +324,20 @@ typedef struct {
     size_t      thu_len;  //2.0
     const char *hash_id;  //2.0
     const char *proof;  //2.0
+    uint64_t    fields;  // projection it was loaded with
 } CmtInfo;
 
+/*
+ * A comment with the first replies to it, oldest first, and the number
+ * of all its replies.
+ */
+typedef struct {
+    CmtInfo  *cinfo;
+    uint64_t  replies_cnt;
+    CmtInfo **replies;
+    size_t    nreplies;
+} CmtThreadInfo;
+
 typedef struct {
     uint64_t chan_id;
     uint64_t post_id;
@@ -171,6 +348,27 @@ typedef struct {
     const char *proof;  //2.0
 } LikeInfo;
 
+/*
+ * Keyset position in the home timeline of a user, newest first. Posts of
+ * different channels may share created_at and post_id, so channel_id
+ * breaks the tie.
+ */
+typedef struct {
+    uint64_t created_at;
+    uint64_t chan_id;
+    uint64_t post_id;
+} TimelineKey;
+
+/*
+ * Entry of the change log of a channel, seq orders the changes of the
+ * whole service. Exactly one of pinfo and cinfo is set.
+ */
+typedef struct {
+    uint64_t  seq;
+    PostInfo *pinfo;
+    CmtInfo  *cinfo;
+} ChangeInfo;
+
 typedef struct {
     uint64_t    chan_id;
     uint64_t    post_id;
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2020 trinity-tech
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "peers.h"
+
+static std::mutex mutex;
+static std::deque<std::string> names; // element addresses are stable on push_back.
+static std::unordered_map<std::string_view, PeerId> peers;
+
+PeerId peer_intern(const char *node_id)
+{
+    if (!node_id || !*node_id)
+        return PEER_NONE;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = peers.find(node_id);
+    if (it != peers.end())
+        return it->second;
+
+    const std::string &name = names.emplace_back(node_id);
+    PeerId peer = (PeerId)names.size();
+    peers.emplace(name, peer);
+
+    return peer;
+}
+
+PeerId peer_find(const char *node_id)
+{
+    if (!node_id)
+        return PEER_NONE;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = peers.find(node_id);
+
+    return it != peers.end() ? it->second : PEER_NONE;
+}
+
+const char *peer_name(PeerId peer)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (peer == PEER_NONE || peer > names.size())
+        return "";
+
+    return names[peer - 1].c_str();
+}
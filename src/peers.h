@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2020 trinity-tech
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __PEERS_H__
+#define __PEERS_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Carrier node ids are interned once into small integer handles, so the
+ * tables keyed by peer hash and compare 4 bytes instead of a base58
+ * string. Handles are never reused and their names stay valid for the
+ * life of the process.
+ */
+typedef uint32_t PeerId;
+
+#define PEER_NONE ((PeerId)0)
+
+// returns the handle of node_id, registering it on first use, or PEER_NONE.
+PeerId peer_intern(const char *node_id);
+// returns the handle of node_id if it was ever interned, otherwise PEER_NONE.
+PeerId peer_find(const char *node_id);
+// returns the node id of peer, or "" for an unknown handle.
+const char *peer_name(PeerId peer);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //__PEERS_H__
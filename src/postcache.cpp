@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2020 trinity-tech
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <crystal.h>
+
+#include "postcache.h"
+
+typedef std::tuple<uint64_t, uint64_t, uint64_t> PostKey; // channel_id, post_id, fields
+
+typedef struct {
+    Marshalled *item;
+    uint64_t stat;
+    uint64_t cmts;
+    uint64_t likes;
+    uint64_t upd_at;
+    std::list<PostKey>::iterator lru;
+} PostEntry;
+
+static std::mutex mutex;
+static std::map<PostKey, PostEntry> entries;
+static std::list<PostKey> lru; // most recently used first
+static size_t bytes;
+
+static inline
+PostKey post_key(const PostInfo *pi)
+{
+    return PostKey(pi->chan_id, pi->post_id, pi->fields);
+}
+
+static
+void entry_erase(std::map<PostKey, PostEntry>::iterator it)
+{
+    bytes -= it->second.item->sz;
+    deref(it->second.item);
+    lru.erase(it->second.lru);
+    entries.erase(it);
+}
+
+Marshalled *postcache_get(const PostInfo *pi)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = entries.find(post_key(pi));
+    if (it == entries.end())
+        return NULL;
+
+    PostEntry &e = it->second;
+    if (e.stat != pi->stat || e.cmts != pi->cmts ||
+        e.likes != pi->likes || e.upd_at != pi->upd_at) {
+        entry_erase(it);
+        return NULL;
+    }
+
+    lru.splice(lru.begin(), lru, e.lru);
+    return (Marshalled *)ref(e.item);
+}
+
+void postcache_put(const PostInfo *pi, Marshalled *item)
+{
+    if (item->sz > POSTCACHE_MAX_ITEM)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    PostKey key = post_key(pi);
+    auto it = entries.find(key);
+    if (it != entries.end())
+        entry_erase(it);
+
+    while (!lru.empty() && bytes + item->sz > POSTCACHE_MAX_BYTES)
+        entry_erase(entries.find(lru.back()));
+
+    lru.push_front(key);
+    entries.emplace(key, PostEntry{(Marshalled *)ref(item), pi->stat, pi->cmts,
+                                   pi->likes, pi->upd_at, lru.begin()});
+    bytes += item->sz;
+}
+
+void postcache_invalidate(uint64_t chan_id, uint64_t post_id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = entries.lower_bound(PostKey(chan_id, post_id, 0));
+    while (it != entries.end() &&
+           std::get<0>(it->first) == chan_id && std::get<1>(it->first) == post_id)
+        entry_erase(it++);
+}
+
+void postcache_clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    while (!entries.empty())
+        entry_erase(entries.begin());
+}
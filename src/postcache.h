@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2020 trinity-tech
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __POSTCACHE_H__
+#define __POSTCACHE_H__
+
+#include "obj.h"
+#include "rpc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * LRU cache of posts already packed as response items, keyed by
+ * (channel_id, post_id, fields). An entry is only handed out while its
+ * status, counters and updated_at still match the post it is asked for,
+ * and the writers of a post drop its entries with postcache_invalidate().
+ */
+#define POSTCACHE_MAX_BYTES (32 * 1024 * 1024)
+#define POSTCACHE_MAX_ITEM  (POSTCACHE_MAX_BYTES / 64)
+
+// returns a reference to the packed post or NULL, deref() it after use.
+Marshalled *postcache_get(const PostInfo *pi);
+void postcache_put(const PostInfo *pi, Marshalled *item);
+void postcache_invalidate(uint64_t chan_id, uint64_t post_id);
+void postcache_clear();
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif //__POSTCACHE_H__
@@ -21,6 +21,8 @@
  */
 
 #include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
 
 #include <msgpack.h>
 #include <crystal.h>
@@ -28,6 +30,8 @@
 
 #include "rpc.h"
 #include "err.h"
+#include "method.h"
+#include "postcache.h"
 
 #define TAG_RPC "[Feedsd.Rpc ]: "
 
@@ -44,7 +48,6 @@
 #define bin_sz     via.bin.size
 #define bool_val   via.boolean
 
-static msgpack_unpacked msgpack;
 static int rpc_version = 1;
 
 static inline
@@ -171,2958 +174,853 @@ size_t str_reserve_spc(const msgpack_object *str)
     return str ? str->str_sz + 1 : 0;
 }
 
-static
-int unmarshal_decl_owner_req(const msgpack_object *req, Req **req_unmarshal)
+/*
+ * Unpacked strings point into the request buffer. The byte behind a string
+ * is the header of the next object (or the pad byte behind the buffer),
+ * which was consumed by the unpacker already, so terminate the string there
+ * and hand out the slice itself instead of a copy.
+ */
+static inline
+char *str_borrow(const msgpack_object *str)
 {
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *nonce;
-    const msgpack_object *owner_did;
-    DeclOwnerReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            nonce     = map_val_str("nonce");
-            owner_did = map_val_str("owner_did");
-        });
-    });
+    char *val;
 
-    if (!nonce || !nonce->str_sz || !owner_did || !owner_did->str_sz) {
-        vlogE(TAG_RPC "Invalid declare_owner request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(DeclOwnerReq) + str_reserve_spc(method) +
-                    str_reserve_spc(nonce) + str_reserve_spc(owner_did), NULL);
-    if (!tmp)
-        return -1;
+    if (!str)
+        return NULL;
 
-    buf = (char *)(tmp + 1);
-    tmp->method           = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id           = tsx_id->u64_val;
-    tmp->params.nonce     = strncpy(buf, nonce->str_val, nonce->str_sz);
-    buf += str_reserve_spc(nonce);
-    tmp->params.owner_did = strncpy(buf, owner_did->str_val, owner_did->str_sz);
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
+    val = (char *)str->str_val;
+    val[str->str_sz] = '\0';
+    return val;
 }
 
-static
-int unmarshal_imp_did_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *mnemo;
-    const msgpack_object *passphrase;
-    const msgpack_object *idx;
-    ImpDIDReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
+/*
+ * Request params and flat response results are described by field schemas
+ * instead of hand-walked maps: each schema lists the wire key, the kind of
+ * the value, where it lives in the C struct and what makes it valid. Keys
+ * are matched by a hash computed once per schema field, so params may come
+ * in any order and unknown keys are skipped.
+ */
+typedef enum {
+    FLD_STR,
+    FLD_BIN,
+    FLD_U64,
+    FLD_I64,
+    FLD_BOOL,
+    FLD_MAP
+} MsgFieldKind;
+
+typedef enum {
+    RULE_OPT,         // may be absent
+    RULE_REQ,         // must be present
+    RULE_FILLED,      // must be present and not empty
+    RULE_OPT_FILLED,  // may be absent, not empty if present
+    RULE_DEF,         // 2.0 field of a 1.0 request, placeholder if absent
+    RULE_CHAN_ID,
+    RULE_POST_ID,
+    RULE_CMT_ID,
+    RULE_QRY_FLD,
+    RULE_CURSOR,      // may be absent, a packed QryCursor if present
+    RULE_TAGS,        // may be absent, (id, tag) pairs if present
+    RULE_PROJ         // may be absent, bits set by the server are cleared
+} MsgFieldRule;
 
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            mnemo      = map_val_str("mnemonic");
-            passphrase = map_val_str("passphrase");
-            idx        = map_val_u64("index");
-        });
-    });
+typedef struct {
+    const char *key;
+    uint32_t    hash;
+    uint8_t     key_sz;
+    uint8_t     kind;
+    uint8_t     rule;
+    uint16_t    off;
+    uint16_t    len_off;
+} MsgField;
 
-    tmp = rc_zalloc(sizeof(ImpDIDReq) + str_reserve_spc(method) +
-                    str_reserve_spc(mnemo) + str_reserve_spc(passphrase), NULL);
-    if (!tmp)
-        return -1;
+typedef struct {
+    size_t    sz;
+    MsgField *flds;
+    size_t    nflds;
+} MsgSchema;
 
-    buf = (char *)(tmp + 1);
-    tmp->method = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id = tsx_id->u64_val;
+#define FLD_LEN_STR(T, l)  0
+#define FLD_LEN_BIN(T, l)  offsetof(T, l)
+#define FLD_LEN_U64(T, l)  0
+#define FLD_LEN_I64(T, l)  0
+#define FLD_LEN_BOOL(T, l) 0
+#define FLD_LEN_MAP(T, l)  0
 
-    if (mnemo)
-        tmp->params.mnemo = strncpy(buf, mnemo->str_val, mnemo->str_sz);
+#define SCHEMA_FIELD(T, K, k, f, l, R)                                \
+    { .key = k, .key_sz = sizeof(k) - 1, .kind = FLD_##K,             \
+      .rule = RULE_##R, .off = offsetof(T, f), .len_off = FLD_LEN_##K(T, l) },
 
-    if (passphrase) {
-        buf += str_reserve_spc(mnemo);
-        tmp->params.passphrase = strncpy(buf, passphrase->str_val, passphrase->str_sz);
+#define SCHEMA_OF(schema, T)                                          \
+    static MsgSchema schema = {                                       \
+        sizeof(T), schema##_flds, sizeof(schema##_flds) / sizeof(MsgField) \
     }
 
-    if (idx)
-        tmp->params.idx = idx->u64_val;
+#define DEFINE_SCHEMA(schema, T, fields)                              \
+    static MsgField schema##_flds[] = { fields(T, SCHEMA_FIELD) };    \
+    SCHEMA_OF(schema, T)
 
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
+#define DEFINE_VERSIONED_SCHEMA(schema, T, fields, V2)                \
+    static MsgField schema##_flds[] = { fields(T, SCHEMA_FIELD, V2) }; \
+    SCHEMA_OF(schema, T)
 
-static
-int unmarshal_iss_vc_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *vc;
-    IssVCReq *tmp;
-    char *buf;
+typedef struct {
+    char                 *version;
+    char                 *method;
+    uint64_t              tsx_id;
+    const msgpack_object *params;
+} ReqEnvelope;
+
+#define REQ_ENVELOPE(T, X)                                      \
+    X(T, STR,  "version", version, _, FILLED)                   \
+    X(T, STR,  "method",  method,  _, FILLED)                   \
+    X(T, U64,  "id",      tsx_id,  _, REQ)                      \
+    X(T, MAP,  "params",  params,  _, OPT)
+
+#define TK_FIELD(T, X)                                          \
+    X(T, STR,  "access_token", params.tk, _, FILLED)
+
+#define QC_FIELDS(T, X)                                         \
+    X(T, U64,  "by",          params.qc.by,     _, QRY_FLD)     \
+    X(T, U64,  "upper_bound", params.qc.upper,  _, REQ)         \
+    X(T, U64,  "lower_bound", params.qc.lower,  _, REQ)         \
+    X(T, U64,  "max_count",   params.qc.maxcnt, _, REQ)
+
+#define PROJ_FIELD(T, X)                                        \
+    X(T, U64,  "fields",      params.qc.fields, _, PROJ)
+
+#define CURSOR_FIELD(T, X)                                      \
+    X(T, BIN,  "cursor",      params.qc.cursor, params.qc.cursor_len, CURSOR)
+
+#define TAGS_FIELD(T, X)                                        \
+    X(T, BIN,  "known_tags",  params.qc.known_tags, params.qc.known_tags_len, TAGS)
+
+#define DECL_OWNER_REQ(T, X)                                    \
+    X(T, STR,  "nonce",     params.nonce,     _, FILLED)        \
+    X(T, STR,  "owner_did", params.owner_did, _, FILLED)
+
+#define IMP_DID_REQ(T, X)                                       \
+    X(T, STR,  "mnemonic",   params.mnemo,      _, OPT)         \
+    X(T, STR,  "passphrase", params.passphrase, _, OPT)         \
+    X(T, U64,  "index",      params.idx,        _, OPT)
+
+#define ISS_VC_REQ(T, X)                                        \
+    X(T, STR,  "credential", params.vc, _, FILLED)
+
+#define UPDATE_VC_REQ(T, X)                                     \
+    TK_FIELD(T, X)                                              \
+    X(T, STR,  "credential", params.vc, _, FILLED)
+
+#define SIGNIN_REQ_CHAL_REQ(T, X)                               \
+    X(T, STR,  "iss",                 params.iss,    _, FILLED) \
+    X(T, BOOL, "credential_required", params.vc_req, _, REQ)
+
+#define SIGNIN_CONF_CHAL_REQ(T, X)                              \
+    X(T, STR,  "jws",        params.jws, _, FILLED)             \
+    X(T, STR,  "credential", params.vc,  _, OPT_FILLED)
+
+#define CHAN_PROFILE_FIELDS(T, X, V2)                           \
+    X(T, STR,  "name",         params.name,   _,         FILLED) \
+    X(T, STR,  "introduction", params.intro,  _,         FILLED) \
+    X(T, BIN,  "avatar",       params.avatar, params.sz, FILLED) \
+    X(T, STR,  "tip_methods",  params.tipm,   _,         V2)    \
+    X(T, STR,  "proof",        params.proof,  _,         V2)
+
+#define CREATE_CHAN_REQ(T, X, V2)                               \
+    TK_FIELD(T, X)                                              \
+    CHAN_PROFILE_FIELDS(T, X, V2)
+
+#define UPD_CHAN_REQ(T, X, V2)                                  \
+    TK_FIELD(T, X)                                              \
+    X(T, U64,  "id", params.chan_id, _, CHAN_ID)                \
+    CHAN_PROFILE_FIELDS(T, X, V2)
+
+#define UPD_USER_INFO_REQ(T, X)                                 \
+    TK_FIELD(T, X)                                              \
+    X(T, STR,  "name",         params.uinfo.name,         _, FILLED) \
+    X(T, STR,  "email",        params.uinfo.email,        _, FILLED) \
+    X(T, STR,  "display_name", params.uinfo.display_name, _, FILLED) \
+    X(T, BIN,  "avatar",       params.uinfo.avatar, params.uinfo.len, FILLED)
+
+#define POST_BODY_FIELDS(T, X, V2)                              \
+    X(T, BIN,  "content",    params.content,    params.con_sz, FILLED) \
+    X(T, BIN,  "thumbnails", params.thumbnails, params.thu_sz, V2) \
+    X(T, STR,  "hash_id",    params.hash_id,    _,             V2) \
+    X(T, STR,  "proof",      params.proof,      _,             V2)
+
+#define PUB_POST_REQ(T, X, V2)                                  \
+    TK_FIELD(T, X)                                              \
+    X(T, U64,  "channel_id",      params.chan_id,         _, CHAN_ID) \
+    POST_BODY_FIELDS(T, X, V2)                                  \
+    X(T, STR,  "origin_post_url", params.origin_post_url, _, V2)
+
+#define DECLARE_POST_REQ(T, X, V2)                              \
+    PUB_POST_REQ(T, X, V2)                                      \
+    X(T, BOOL, "with_notify", params.with_notify, _, OPT)
+
+#define NOTIFY_POST_REQ(T, X)                                   \
+    TK_FIELD(T, X)                                              \
+    X(T, U64,  "channel_id", params.chan_id, _, CHAN_ID)        \
+    X(T, U64,  "post_id",    params.post_id, _, POST_ID)
+
+#define EDIT_POST_REQ(T, X, V2)                                 \
+    TK_FIELD(T, X)                                              \
+    X(T, U64,  "channel_id",      params.chan_id,         _, CHAN_ID) \
+    X(T, U64,  "id",              params.post_id,         _, POST_ID) \
+    POST_BODY_FIELDS(T, X, V2)                                  \
+    X(T, STR,  "origin_post_url", params.origin_post_url, _, V2)
+
+#define DEL_POST_REQ(T, X)                                      \
+    TK_FIELD(T, X)                                              \
+    X(T, U64,  "channel_id", params.chan_id, _, CHAN_ID)        \
+    X(T, U64,  "id",         params.post_id, _, POST_ID)
+
+#define POST_CMT_REQ(T, X, V2)                                  \
+    TK_FIELD(T, X)                                              \
+    X(T, U64,  "channel_id", params.chan_id, _, CHAN_ID)        \
+    X(T, U64,  "post_id",    params.post_id, _, POST_ID)        \
+    X(T, U64,  "comment_id", params.cmt_id,  _, REQ)            \
+    POST_BODY_FIELDS(T, X, V2)
+
+#define EDIT_CMT_REQ(T, X, V2)                                  \
+    TK_FIELD(T, X)                                              \
+    X(T, U64,  "channel_id", params.chan_id, _, CHAN_ID)        \
+    X(T, U64,  "post_id",    params.post_id, _, POST_ID)        \
+    X(T, U64,  "id",         params.id,      _, CMT_ID)         \
+    X(T, U64,  "comment_id", params.cmt_id,  _, REQ)            \
+    POST_BODY_FIELDS(T, X, V2)
+
+#define DEL_CMT_REQ(T, X)                                       \
+    TK_FIELD(T, X)                                              \
+    X(T, U64,  "channel_id", params.chan_id, _, CHAN_ID)        \
+    X(T, U64,  "post_id",    params.post_id, _, POST_ID)        \
+    X(T, U64,  "id",         params.id,      _, CMT_ID)
+
+#define BLOCK_CMT_REQ(T, X)                                     \
+    TK_FIELD(T, X)                                              \
+    X(T, U64,  "channel_id", params.chan_id, _, CHAN_ID)        \
+    X(T, U64,  "post_id",    params.post_id, _, POST_ID)        \
+    X(T, U64,  "comment_id", params.cmt_id,  _, CMT_ID)
+
+#define POST_UNLIKE_REQ(T, X)                                   \
+    TK_FIELD(T, X)                                              \
+    X(T, U64,  "channel_id", params.chan_id, _, CHAN_ID)        \
+    X(T, U64,  "post_id",    params.post_id, _, POST_ID)        \
+    X(T, U64,  "comment_id", params.cmt_id,  _, REQ)
+
+#define POST_LIKE_REQ(T, X, V2)                                 \
+    POST_UNLIKE_REQ(T, X)                                       \
+    X(T, STR,  "proof", params.proof, _, V2)
+
+#define QRY_REQ(T, X)                                           \
+    TK_FIELD(T, X)                                              \
+    QC_FIELDS(T, X)
+
+#define CHAN_QRY_REQ(T, X)                                      \
+    TK_FIELD(T, X)                                              \
+    X(T, U64,  "channel_id", params.chan_id, _, CHAN_ID)        \
+    QC_FIELDS(T, X)
+
+#define POST_QRY_REQ(T, X)                                      \
+    TK_FIELD(T, X)                                              \
+    X(T, U64,  "channel_id", params.chan_id, _, CHAN_ID)        \
+    X(T, U64,  "post_id",    params.post_id, _, POST_ID)        \
+    QC_FIELDS(T, X)
+
+#define CHANS_QRY_REQ(T, X)                                     \
+    QRY_REQ(T, X)                                               \
+    PROJ_FIELD(T, X)                                            \
+    CURSOR_FIELD(T, X)                                          \
+    TAGS_FIELD(T, X)
+
+#define POSTS_QRY_REQ(T, X)                                     \
+    CHAN_QRY_REQ(T, X)                                          \
+    PROJ_FIELD(T, X)                                            \
+    CURSOR_FIELD(T, X)                                          \
+    TAGS_FIELD(T, X)
+
+#define CMTS_QRY_REQ(T, X)                                      \
+    POST_QRY_REQ(T, X)                                          \
+    PROJ_FIELD(T, X)                                            \
+    CURSOR_FIELD(T, X)
+
+#define LIKED_QRY_REQ(T, X)                                     \
+    QRY_REQ(T, X)                                               \
+    CURSOR_FIELD(T, X)
+
+#define SYNC_CHANGES_REQ(T, X)                                  \
+    TK_FIELD(T, X)                                              \
+    X(T, U64,  "channel_id", params.chan_id, _, CHAN_ID)        \
+    X(T, U64,  "cursor",     params.cursor,  _, OPT)            \
+    X(T, U64,  "max_count",  params.maxcnt,  _, OPT)
+
+#define GET_TIMELINE_REQ(T, X)                                            \
+    TK_FIELD(T, X)                                                        \
+    X(T, U64,  "before_created_at", params.before.created_at, _, OPT)     \
+    X(T, U64,  "before_channel_id", params.before.chan_id,    _, OPT)     \
+    X(T, U64,  "before_post_id",    params.before.post_id,    _, OPT)     \
+    X(T, U64,  "max_count",         params.maxcnt,            _, OPT)     \
+    X(T, U64,  "fields",            params.fields,            _, PROJ)
+
+#define GET_CMT_THREAD_REQ(T, X)                                    \
+    TK_FIELD(T, X)                                                  \
+    X(T, U64,  "channel_id",       params.chan_id,     _, CHAN_ID)  \
+    X(T, U64,  "post_id",          params.post_id,     _, POST_ID)  \
+    X(T, U64,  "comment_id",       params.cmt_id,      _, OPT)      \
+    X(T, U64,  "after_comment_id", params.after,       _, OPT)      \
+    X(T, U64,  "max_count",        params.maxcnt,      _, OPT)      \
+    X(T, U64,  "max_replies",      params.max_replies, _, OPT)      \
+    X(T, U64,  "fields",           params.fields,      _, PROJ)
+
+#define CHAN_REQ(T, X)                                          \
+    TK_FIELD(T, X)                                              \
+    X(T, U64,  "id", params.id, _, CHAN_ID)
+
+#define CHAN_DTL_REQ(T, X)                                      \
+    CHAN_REQ(T, X)                                              \
+    X(T, U64,  "known_tag", params.known_tag, _, OPT)
+
+#define SUB_CHAN_REQ(T, X, V2)                                  \
+    CHAN_REQ(T, X)                                              \
+    X(T, STR,  "proof", params.proof, _, V2)
+
+#define TK_REQ(T, X)                                            \
+    TK_FIELD(T, X)
+
+#define SET_BINARY_REQ(T, X)                                    \
+    TK_FIELD(T, X)                                              \
+    X(T, STR,  "key",      params.key,      _, FILLED)          \
+    X(T, STR,  "algo",     params.algo,     _, OPT)             \
+    X(T, STR,  "checksum", params.checksum, _, OPT)             \
+    X(T, BIN,  "content",  params.content,  params.content_sz, OPT)
+
+#define GET_BINARY_REQ(T, X)                                    \
+    TK_FIELD(T, X)                                              \
+    X(T, STR,  "key", params.key, _, FILLED)
+
+#define GET_SRV_VER_REQ(T, X)                                   \
+    X(T, STR,  "access_token", params.tk,          _, OPT)      \
+    X(T, STR,  "compression",  params.compression, _, OPT)
+
+#define REPORT_ILLEGAL_CMT_REQ(T, X)                            \
+    POST_UNLIKE_REQ(T, X)                                       \
+    X(T, STR,  "reasons", params.reasons, _, FILLED)
+
+DEFINE_SCHEMA(req_envelope,               ReqEnvelope,         REQ_ENVELOPE);
+DEFINE_SCHEMA(decl_owner_req,             DeclOwnerReq,        DECL_OWNER_REQ);
+DEFINE_SCHEMA(imp_did_req,                ImpDIDReq,           IMP_DID_REQ);
+DEFINE_SCHEMA(iss_vc_req,                 IssVCReq,            ISS_VC_REQ);
+DEFINE_SCHEMA(update_vc_req,              UpdateVCReq,         UPDATE_VC_REQ);
+DEFINE_SCHEMA(signin_req_chal_req,        SigninReqChalReq,    SIGNIN_REQ_CHAL_REQ);
+DEFINE_SCHEMA(signin_conf_chal_req,       SigninConfChalReq,   SIGNIN_CONF_CHAL_REQ);
+DEFINE_VERSIONED_SCHEMA(create_chan_req,   CreateChanReq,      CREATE_CHAN_REQ,  DEF);
+DEFINE_VERSIONED_SCHEMA(create_chan_req_2, CreateChanReq,      CREATE_CHAN_REQ,  FILLED);
+DEFINE_VERSIONED_SCHEMA(upd_chan_req,      UpdChanReq,         UPD_CHAN_REQ,     DEF);
+DEFINE_VERSIONED_SCHEMA(upd_chan_req_2,    UpdChanReq,         UPD_CHAN_REQ,     FILLED);
+DEFINE_SCHEMA(upd_user_info_req,          UpdUserInfoReq,      UPD_USER_INFO_REQ);  //2.0
+DEFINE_VERSIONED_SCHEMA(pub_post_req,      PubPostReq,         PUB_POST_REQ,     DEF);
+DEFINE_VERSIONED_SCHEMA(pub_post_req_2,    PubPostReq,         PUB_POST_REQ,     FILLED);
+DEFINE_VERSIONED_SCHEMA(declare_post_req,  DeclarePostReq,     DECLARE_POST_REQ, DEF);
+DEFINE_VERSIONED_SCHEMA(declare_post_req_2, DeclarePostReq,    DECLARE_POST_REQ, FILLED);
+DEFINE_SCHEMA(notify_post_req,            NotifyPostReq,       NOTIFY_POST_REQ);
+DEFINE_VERSIONED_SCHEMA(edit_post_req,     EditPostReq,        EDIT_POST_REQ,    DEF);
+DEFINE_VERSIONED_SCHEMA(edit_post_req_2,   EditPostReq,        EDIT_POST_REQ,    FILLED);
+DEFINE_SCHEMA(del_post_req,               DelPostReq,          DEL_POST_REQ);
+DEFINE_VERSIONED_SCHEMA(post_cmt_req,      PostCmtReq,         POST_CMT_REQ,     DEF);
+DEFINE_VERSIONED_SCHEMA(post_cmt_req_2,    PostCmtReq,         POST_CMT_REQ,     FILLED);
+DEFINE_VERSIONED_SCHEMA(edit_cmt_req,      EditCmtReq,         EDIT_CMT_REQ,     DEF);
+DEFINE_VERSIONED_SCHEMA(edit_cmt_req_2,    EditCmtReq,         EDIT_CMT_REQ,     FILLED);
+DEFINE_SCHEMA(del_cmt_req,                DelCmtReq,           DEL_CMT_REQ);
+DEFINE_SCHEMA(block_cmt_req,              BlockCmtReq,         BLOCK_CMT_REQ);
+DEFINE_SCHEMA(unblock_cmt_req,            UnblockCmtReq,       BLOCK_CMT_REQ);
+DEFINE_VERSIONED_SCHEMA(post_like_req,     PostLikeReq,        POST_LIKE_REQ,    DEF);
+DEFINE_VERSIONED_SCHEMA(post_like_req_2,   PostLikeReq,        POST_LIKE_REQ,    FILLED);
+DEFINE_SCHEMA(post_unlike_req,            PostUnlikeReq,       POST_UNLIKE_REQ);
+DEFINE_SCHEMA(get_my_chans_req,           GetMyChansReq,       QRY_REQ);
+DEFINE_SCHEMA(get_my_chans_meta_req,      GetMyChansMetaReq,   QRY_REQ);
+DEFINE_SCHEMA(get_chans_req,              GetChansReq,         CHANS_QRY_REQ);
+DEFINE_SCHEMA(get_chan_dtl_req,           GetChanDtlReq,       CHAN_DTL_REQ);
+DEFINE_SCHEMA(get_sub_chans_req,          GetSubChansReq,      QRY_REQ);
+DEFINE_SCHEMA(get_posts_req,              GetPostsReq,         POSTS_QRY_REQ);
+DEFINE_SCHEMA(get_posts_lac_req,          GetPostsLACReq,      CHAN_QRY_REQ);
+DEFINE_SCHEMA(get_liked_posts_req,        GetLikedPostsReq,    LIKED_QRY_REQ);
+DEFINE_SCHEMA(get_liked_data_req,         GetLikedDataReq,     QRY_REQ);  //2.0
+DEFINE_SCHEMA(get_cmts_req,               GetCmtsReq,          CMTS_QRY_REQ);
+DEFINE_SCHEMA(get_cmts_likes_req,         GetCmtsLikesReq,     POST_QRY_REQ);
+DEFINE_SCHEMA(sync_changes_req,           SyncChangesReq,      SYNC_CHANGES_REQ);
+DEFINE_SCHEMA(get_timeline_req,           GetTimelineReq,      GET_TIMELINE_REQ);
+DEFINE_SCHEMA(get_cmt_thread_req,         GetCmtThreadReq,     GET_CMT_THREAD_REQ);
+DEFINE_SCHEMA(get_stats_req,              GetStatsReq,         TK_REQ);
+DEFINE_VERSIONED_SCHEMA(sub_chan_req,      SubChanReq,         SUB_CHAN_REQ,     DEF);
+DEFINE_VERSIONED_SCHEMA(sub_chan_req_2,    SubChanReq,         SUB_CHAN_REQ,     FILLED);
+DEFINE_SCHEMA(unsub_chan_req,             UnsubChanReq,        CHAN_REQ);
+DEFINE_SCHEMA(enbl_notif_req,             EnblNotifReq,        TK_REQ);
+DEFINE_SCHEMA(set_binary_req,             SetBinaryReq,        SET_BINARY_REQ);
+DEFINE_SCHEMA(get_binary_req,             GetBinaryReq,        GET_BINARY_REQ);
+DEFINE_SCHEMA(get_srv_ver_req,            GetSrvVerReq,        GET_SRV_VER_REQ);
+DEFINE_SCHEMA(report_illegal_cmt_req,     ReportIllegalCmtReq, REPORT_ILLEGAL_CMT_REQ);
+DEFINE_SCHEMA(get_reported_cmts_req,      GetReportedCmtsReq,  QRY_REQ);
+
+static MsgSchema unknown_req = { sizeof(Req), NULL, 0 };
+
+static MsgSchema *req_schemas_1_0[RPC_METHOD_COUNT] = {
+    [RPC_METHOD_DECL_OWNER]         = &decl_owner_req,
+    [RPC_METHOD_IMP_DID]            = &imp_did_req,
+    [RPC_METHOD_ISS_VC]             = &iss_vc_req,
+    [RPC_METHOD_UPDATE_VC]          = &update_vc_req,
+    [RPC_METHOD_SIGNIN_REQ_CHAL]    = &signin_req_chal_req,
+    [RPC_METHOD_SIGNIN_CONF_CHAL]   = &signin_conf_chal_req,
+    [RPC_METHOD_CREATE_CHAN]        = &create_chan_req,
+    [RPC_METHOD_UPD_CHAN]           = &upd_chan_req,
+    [RPC_METHOD_UPD_USER_INFO]      = &upd_user_info_req,  //2.0
+    [RPC_METHOD_PUB_POST]           = &pub_post_req,
+    [RPC_METHOD_DECLARE_POST]       = &declare_post_req,
+    [RPC_METHOD_NOTIFY_POST]        = &notify_post_req,
+    [RPC_METHOD_EDIT_POST]          = &edit_post_req,
+    [RPC_METHOD_DEL_POST]           = &del_post_req,
+    [RPC_METHOD_POST_CMT]           = &post_cmt_req,
+    [RPC_METHOD_EDIT_CMT]           = &edit_cmt_req,
+    [RPC_METHOD_DEL_CMT]            = &del_cmt_req,
+    [RPC_METHOD_BLOCK_CMT]          = &block_cmt_req,
+    [RPC_METHOD_UNBLOCK_CMT]        = &unblock_cmt_req,
+    [RPC_METHOD_POST_LIKE]          = &post_like_req,
+    [RPC_METHOD_POST_UNLIKE]        = &post_unlike_req,
+    [RPC_METHOD_GET_MY_CHANS]       = &get_my_chans_req,
+    [RPC_METHOD_GET_MY_CHANS_META]  = &get_my_chans_meta_req,
+    [RPC_METHOD_GET_CHANS]          = &get_chans_req,
+    [RPC_METHOD_GET_CHAN_DTL]       = &get_chan_dtl_req,
+    [RPC_METHOD_GET_SUB_CHANS]      = &get_sub_chans_req,
+    [RPC_METHOD_GET_POSTS]          = &get_posts_req,
+    [RPC_METHOD_GET_POSTS_LAC]      = &get_posts_lac_req,
+    [RPC_METHOD_GET_LIKED_POSTS]    = &get_liked_posts_req,
+    [RPC_METHOD_GET_LIKED_DATA]     = &get_liked_data_req,
+    [RPC_METHOD_GET_CMTS]           = &get_cmts_req,
+    [RPC_METHOD_GET_CMTS_LIKES]     = &get_cmts_likes_req,
+    [RPC_METHOD_SYNC_CHANGES]       = &sync_changes_req,
+    [RPC_METHOD_GET_TIMELINE]       = &get_timeline_req,
+    [RPC_METHOD_GET_CMT_THREAD]     = &get_cmt_thread_req,
+    [RPC_METHOD_GET_STATS]          = &get_stats_req,
+    [RPC_METHOD_SUB_CHAN]           = &sub_chan_req,
+    [RPC_METHOD_UNSUB_CHAN]         = &unsub_chan_req,
+    [RPC_METHOD_ENBL_NOTIF]         = &enbl_notif_req,
+    [RPC_METHOD_SET_BINARY]         = &set_binary_req,
+    [RPC_METHOD_GET_BINARY]         = &get_binary_req,
+    [RPC_METHOD_GET_SRV_VER]        = &get_srv_ver_req,
+    [RPC_METHOD_REPORT_ILLEGAL_CMT] = &report_illegal_cmt_req,
+    [RPC_METHOD_GET_REPORTED_CMTS]  = &get_reported_cmts_req,
+};
 
-    assert(req->type == MSGPACK_OBJECT_MAP);
+static MsgSchema *req_schemas_2_0[RPC_METHOD_COUNT] = {
+    [RPC_METHOD_DECL_OWNER]         = &decl_owner_req,
+    [RPC_METHOD_IMP_DID]            = &imp_did_req,
+    [RPC_METHOD_ISS_VC]             = &iss_vc_req,
+    [RPC_METHOD_UPDATE_VC]          = &update_vc_req,
+    [RPC_METHOD_SIGNIN_REQ_CHAL]    = &signin_req_chal_req,
+    [RPC_METHOD_SIGNIN_CONF_CHAL]   = &signin_conf_chal_req,
+    [RPC_METHOD_CREATE_CHAN]        = &create_chan_req_2,
+    [RPC_METHOD_UPD_CHAN]           = &upd_chan_req_2,
+    [RPC_METHOD_UPD_USER_INFO]      = &upd_user_info_req,  //2.0
+    [RPC_METHOD_PUB_POST]           = &pub_post_req_2,
+    [RPC_METHOD_DECLARE_POST]       = &declare_post_req_2,
+    [RPC_METHOD_NOTIFY_POST]        = &notify_post_req,
+    [RPC_METHOD_EDIT_POST]          = &edit_post_req_2,
+    [RPC_METHOD_DEL_POST]           = &del_post_req,
+    [RPC_METHOD_POST_CMT]           = &post_cmt_req_2,
+    [RPC_METHOD_EDIT_CMT]           = &edit_cmt_req_2,
+    [RPC_METHOD_DEL_CMT]            = &del_cmt_req,
+    [RPC_METHOD_BLOCK_CMT]          = &block_cmt_req,
+    [RPC_METHOD_UNBLOCK_CMT]        = &unblock_cmt_req,
+    [RPC_METHOD_POST_LIKE]          = &post_like_req_2,
+    [RPC_METHOD_POST_UNLIKE]        = &post_unlike_req,
+    [RPC_METHOD_GET_MY_CHANS]       = &get_my_chans_req,
+    [RPC_METHOD_GET_MY_CHANS_META]  = &get_my_chans_meta_req,
+    [RPC_METHOD_GET_CHANS]          = &get_chans_req,
+    [RPC_METHOD_GET_CHAN_DTL]       = &get_chan_dtl_req,
+    [RPC_METHOD_GET_SUB_CHANS]      = &get_sub_chans_req,
+    [RPC_METHOD_GET_POSTS]          = &get_posts_req,
+    [RPC_METHOD_GET_POSTS_LAC]      = &get_posts_lac_req,
+    [RPC_METHOD_GET_LIKED_POSTS]    = &get_liked_posts_req,
+    [RPC_METHOD_GET_LIKED_DATA]     = &get_liked_data_req,
+    [RPC_METHOD_GET_CMTS]           = &get_cmts_req,
+    [RPC_METHOD_GET_CMTS_LIKES]     = &get_cmts_likes_req,
+    [RPC_METHOD_SYNC_CHANGES]       = &sync_changes_req,
+    [RPC_METHOD_GET_TIMELINE]       = &get_timeline_req,
+    [RPC_METHOD_GET_CMT_THREAD]     = &get_cmt_thread_req,
+    [RPC_METHOD_GET_STATS]          = &get_stats_req,
+    [RPC_METHOD_SUB_CHAN]           = &sub_chan_req_2,
+    [RPC_METHOD_UNSUB_CHAN]         = &unsub_chan_req,
+    [RPC_METHOD_ENBL_NOTIF]         = &enbl_notif_req,
+    [RPC_METHOD_SET_BINARY]         = &set_binary_req,
+    [RPC_METHOD_GET_BINARY]         = &get_binary_req,
+    [RPC_METHOD_GET_SRV_VER]        = &get_srv_ver_req,
+    [RPC_METHOD_REPORT_ILLEGAL_CMT] = &report_illegal_cmt_req,
+    [RPC_METHOD_GET_REPORTED_CMTS]  = &get_reported_cmts_req,
+};
 
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            vc = map_val_str("credential");
-        });
-    });
+// placeholders the 1.0 requests carry for the fields added in 2.0.
+static char    def_str[] = "NA";
+static uint8_t def_thumbnails[] = { 0xA0 };
 
-    if (!vc || !vc->str_sz) {
-        vlogE(TAG_RPC "Invalid issue_credential request.");
-        return -1;
-    }
+static pthread_once_t schemas_once = PTHREAD_ONCE_INIT;
 
-    tmp = rc_zalloc(sizeof(IssVCReq) + str_reserve_spc(method) +
-                    str_reserve_spc(vc), NULL);
-    if (!tmp)
-        return -1;
+static inline
+uint32_t key_hash(const char *key, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    size_t i;
 
-    buf = (char *)(tmp + 1);
-    tmp->method    = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id    = tsx_id->u64_val;
-    tmp->params.vc = strncpy(buf, vc->str_val, vc->str_sz);
+    for (i = 0; i < len; i++)
+        hash = (hash ^ (uint8_t)key[i]) * 16777619u;
 
-    *req_unmarshal = (Req *)tmp;
-    return 0;
+    return hash;
 }
 
 static
-int unmarshal_update_vc_req(const msgpack_object *req, Req **req_unmarshal)
+void schema_hash_keys(MsgSchema *schema)
 {
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *vc;
-    const msgpack_object *tk;
-    UpdateVCReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk = map_val_str("access_token");
-            vc = map_val_str("credential");
-        });
-    });
+    size_t i;
 
-    if (!tk || !tk->str_sz || !vc || !vc->str_sz) {
-        vlogE(TAG_RPC "Invalid update_credential request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(UpdateVCReq) + str_reserve_spc(method) +
-                    str_reserve_spc(tk) + str_reserve_spc(vc), NULL);
-    if (!tmp)
-        return -1;
+    assert(schema->nflds <= 64);
 
-    buf = (char *)(tmp + 1);
-    tmp->method    = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id    = tsx_id->u64_val;
-    tmp->params.tk = strncpy(buf, tk->str_val, tk->str_sz);
-    buf += str_reserve_spc(tk);
-    tmp->params.vc = strncpy(buf, vc->str_val, vc->str_sz);
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
+    for (i = 0; i < schema->nflds; i++)
+        schema->flds[i].hash = key_hash(schema->flds[i].key, schema->flds[i].key_sz);
 }
 
 static
-int unmarshal_signin_req_chal_req(const msgpack_object *req, Req **req_unmarshal)
+void schemas_init(void)
 {
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *iss;
-    const msgpack_object *vc_req;
-    SigninReqChalReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            iss    = map_val_str("iss");
-            vc_req = map_val_bool("credential_required");
-        });
-    });
+    int i;
 
-    if (!iss || !iss->str_sz || !vc_req) {
-        vlogE(TAG_RPC "Invalid signin_request_challenge request.");
-        return -1;
+    schema_hash_keys(&req_envelope);
+    for (i = 0; i < RPC_METHOD_COUNT; i++) {
+        if (req_schemas_1_0[i])
+            schema_hash_keys(req_schemas_1_0[i]);
+        if (req_schemas_2_0[i])
+            schema_hash_keys(req_schemas_2_0[i]);
     }
-
-    tmp = rc_zalloc(sizeof(SigninReqChalReq) + str_reserve_spc(method) +
-                    str_reserve_spc(iss), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method        = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id        = tsx_id->u64_val;
-    tmp->params.iss    = strncpy(buf, iss->str_val, iss->str_sz);
-    tmp->params.vc_req = vc_req->bool_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
 }
 
-static
-int unmarshal_signin_conf_chal_req(const msgpack_object *req, Req **req_unmarshal)
+static inline
+const MsgField *schema_field(const MsgSchema *schema, const msgpack_object *key)
 {
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *jws;
-    const msgpack_object *vc;
-    SigninConfChalReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            jws = map_val_str("jws");
-            vc  = map_val_str("credential");
-        });
-    });
+    uint32_t hash;
+    size_t i;
 
-    if (!jws || !jws->str_sz || (vc && !vc->str_sz))
-        return -1;
+    if (key->type != MSGPACK_OBJECT_STR)
+        return NULL;
 
-    tmp = rc_zalloc(sizeof(SigninConfChalReq) + str_reserve_spc(method) +
-                    str_reserve_spc(jws) + str_reserve_spc(vc), NULL);
-    if (!tmp)
-        return -1;
+    hash = key_hash(key->str_val, key->str_sz);
+    for (i = 0; i < schema->nflds; i++) {
+        const MsgField *fld = &schema->flds[i];
 
-    buf = (char *)(tmp + 1);
-    tmp->method     = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id     = tsx_id->u64_val;
-    tmp->params.jws = strncpy(buf, jws->str_val, jws->str_sz);
-
-    if (vc) {
-        buf += str_reserve_spc(jws);
-        tmp->params.vc = strncpy(buf, vc->str_val, vc->str_sz);
+        if (fld->hash == hash && fld->key_sz == key->str_sz &&
+            !memcmp(fld->key, key->str_val, key->str_sz))
+            return fld;
     }
 
-    *req_unmarshal = (Req *)tmp;
-    return 0;
+    return NULL;
 }
 
 static
-int unmarshal_create_chan_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *name;
-    const msgpack_object *intro;
-    const msgpack_object *avatar;
-    CreateChanReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk     = map_val_str("access_token");
-            name   = map_val_str("name");
-            intro  = map_val_str("introduction");
-            avatar = map_val_bin("avatar");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !name || !name->str_sz ||
-        !intro || !intro->str_sz || !avatar || !avatar->bin_sz) {
-        vlogE(TAG_RPC "Invalid create_channel request.");
-        return -1;
+bool field_decode(const MsgField *fld, const msgpack_object *val, char *base)
+{
+    void *dst = base + fld->off;
+
+    switch (fld->kind) {
+    case FLD_STR:
+        if (val->type != MSGPACK_OBJECT_STR)
+            return false;
+        *(char **)dst = str_borrow(val);
+        return true;
+
+    case FLD_BIN:
+        if (val->type != MSGPACK_OBJECT_BIN)
+            return false;
+        *(void **)dst = (void *)val->bin_val;
+        *(size_t *)(base + fld->len_off) = val->bin_sz;
+        return true;
+
+    case FLD_U64:
+        if (val->type != MSGPACK_OBJECT_POSITIVE_INTEGER)
+            return false;
+        *(uint64_t *)dst = val->u64_val;
+        return true;
+
+    case FLD_I64:
+        if (val->type != MSGPACK_OBJECT_NEGATIVE_INTEGER &&
+            (val->type != MSGPACK_OBJECT_POSITIVE_INTEGER || val->u64_val > INT64_MAX))
+            return false;
+        *(int64_t *)dst = val->i64_val;
+        return true;
+
+    case FLD_BOOL:
+        if (val->type != MSGPACK_OBJECT_BOOLEAN)
+            return false;
+        *(bool *)dst = val->bool_val;
+        return true;
+
+    case FLD_MAP:
+        if (val->type != MSGPACK_OBJECT_MAP)
+            return false;
+        *(const msgpack_object **)dst = val;
+        return true;
+
+    default:
+        return false;
     }
-
-    tmp = rc_zalloc(sizeof(CreateChanReq) + str_reserve_spc(method) +
-                    str_reserve_spc(tk) + str_reserve_spc(name) +
-                    str_reserve_spc(intro) + 6, NULL);  //2 space for empty v2.0 item
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method        = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id        = tsx_id->u64_val;
-    tmp->params.tk     = strncpy(buf, tk->str_val, tk->str_sz);
-    buf += str_reserve_spc(tk);
-    tmp->params.name   = strncpy(buf, name->str_val, name->str_sz);
-    buf += str_reserve_spc(name);
-    tmp->params.intro  = strncpy(buf, intro->str_val, intro->str_sz);
-    tmp->params.avatar = (void *)avatar->bin_val;
-    tmp->params.sz     = avatar->bin_sz;
-    buf += str_reserve_spc(intro);
-    tmp->params.tipm   = strcpy(buf, "NA");   //empty for v2.0
-    buf += 3;
-    tmp->params.proof  = strcpy(buf, "NA");   //empty for v2.0
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
 }
 
 static
-int unmarshal_create_chan_req_2(const msgpack_object *req, Req **req_unmarshal)
+bool field_filled(const MsgField *fld, const char *base)
 {
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *name;
-    const msgpack_object *intro;
-    const msgpack_object *avatar;
-    const msgpack_object *tipm;  //v2.0
-    const msgpack_object *proof;  //v2.0
-    CreateChanReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk     = map_val_str("access_token");
-            name   = map_val_str("name");
-            intro  = map_val_str("introduction");
-            avatar = map_val_bin("avatar");
-            tipm   = map_val_str("tip_methods");  //v2.0
-            proof  = map_val_str("proof");  //v2.0
-        });
-    });
+    const void *src = base + fld->off;
 
-    if (!tk || !tk->str_sz || !name || !name->str_sz ||
-        !intro || !intro->str_sz || !avatar || !avatar->bin_sz ||
-        !tipm || !tipm->str_sz || !proof || !proof->str_sz) {
-        vlogE(TAG_RPC "Invalid create_channel request.");
-        return -1;
+    switch (fld->kind) {
+    case FLD_STR:
+        return **(char * const *)src != '\0';
+    case FLD_BIN:
+        return *(const size_t *)(base + fld->len_off) > 0;
+    default:
+        return true;
     }
+}
 
-    tmp = rc_zalloc(sizeof(CreateChanReq) + str_reserve_spc(method) +
-                    str_reserve_spc(tk) + str_reserve_spc(name) +
-                    str_reserve_spc(intro) + str_reserve_spc(tipm) + 
-                    str_reserve_spc(proof), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method        = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id        = tsx_id->u64_val;
-    tmp->params.tk     = strncpy(buf, tk->str_val, tk->str_sz);
-    buf += str_reserve_spc(tk);
-    tmp->params.name   = strncpy(buf, name->str_val, name->str_sz);
-    buf += str_reserve_spc(name);
-    tmp->params.intro  = strncpy(buf, intro->str_val, intro->str_sz);
-    tmp->params.avatar = (void *)avatar->bin_val;
-    tmp->params.sz     = avatar->bin_sz;
-    buf += str_reserve_spc(intro);
-    tmp->params.tipm   = strncpy(buf, tipm->str_val, tipm->str_sz);  //v2.0
-    buf += str_reserve_spc(tipm);
-    tmp->params.proof  = strncpy(buf, proof->str_val, proof->str_sz);  //v2.0
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
+static
+bool field_check(const MsgField *fld, char *base, bool present)
+{
+    uint64_t u64 = fld->kind == FLD_U64 ? *(uint64_t *)(base + fld->off) : 0;
+
+    if (fld->rule == RULE_DEF) {
+        if (present && field_filled(fld, base))
+            return true;
+
+        if (fld->kind == FLD_BIN) {
+            *(void **)(base + fld->off) = def_thumbnails;
+            *(size_t *)(base + fld->len_off) = sizeof(def_thumbnails);
+        } else
+            *(char **)(base + fld->off) = def_str;
+        return true;
+    }
+
+    if (!present)
+        return fld->rule == RULE_OPT || fld->rule == RULE_OPT_FILLED ||
+               fld->rule == RULE_CURSOR || fld->rule == RULE_TAGS ||
+               fld->rule == RULE_PROJ;
+
+    switch (fld->rule) {
+    case RULE_FILLED:
+    case RULE_OPT_FILLED:
+        return field_filled(fld, base);
+    case RULE_CHAN_ID:
+        return chan_id_is_valid(u64);
+    case RULE_POST_ID:
+        return post_id_is_valid(u64);
+    case RULE_CMT_ID:
+        return cmt_id_is_valid(u64);
+    case RULE_QRY_FLD:
+        return qry_fld_is_valid(u64);
+    case RULE_CURSOR:
+        return *(size_t *)(base + fld->len_off) == QRY_CURSOR_LEN;
+    case RULE_TAGS:
+        return *(size_t *)(base + fld->len_off) % KNOWN_TAG_LEN == 0;
+    case RULE_PROJ:
+        *(uint64_t *)(base + fld->off) = u64 & ~PROJ_NOT_MODIFIED;
+        return true;
+    default:
+        return true;
+    }
 }
 
+/*
+ * One pass over the map: every key is hashed once and looked up in the
+ * schema, values of the wrong type are taken as absent. The rules are
+ * checked once all the fields are in.
+ */
 static
-int unmarshal_upd_user_info_req(const msgpack_object *req, Req **req_unmarshal)  //2.0
+int schema_decode(const MsgSchema *schema, const msgpack_object *map, void *obj)
 {
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *name;
-    const msgpack_object *email;
-    const msgpack_object *display_name;
-    const msgpack_object *avatar;
-    //TODO subscriptions needs
-    UpdUserInfoReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            name    = map_val_str("name");
-            email   = map_val_str("email");
-            display_name  = map_val_str("display_name");
-            avatar  = map_val_bin("avatar");
-        });
-    });
+    uint64_t present = 0;
+    const MsgField *fld;
+    size_t i;
 
-    if (!tk || !tk->str_sz || !name || !name->str_sz || !email || 
-            !email->str_sz || !display_name || !display_name->str_sz ||
-            !avatar || !avatar->bin_sz) {
-        vlogE(TAG_RPC "Invalid update_user_info request.");
-        return -1;
+    for (i = 0; map && i < map->map_sz; i++) {
+        fld = schema_field(schema, &map->map_key(i));
+        if (fld && field_decode(fld, &map->map_val(i), obj))
+            present |= 1ULL << (fld - schema->flds);
     }
 
-    tmp = rc_zalloc(sizeof(UpdUserInfoReq) + str_reserve_spc(method) +
-            str_reserve_spc(tk) + str_reserve_spc(name) +
-            str_reserve_spc(email) + str_reserve_spc(display_name), NULL);
-    if (!tmp)
-        return -1;
+    for (i = 0; i < schema->nflds; i++) {
+        if (!field_check(&schema->flds[i], obj, present & (1ULL << i)))
+            return -1;
+    }
 
-    buf = (char *)(tmp + 1);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    buf += str_reserve_spc(tk);
-    tmp->params.uinfo.name = strncpy(buf, name->str_val, name->str_sz);
-    buf += str_reserve_spc(name);
-    tmp->params.uinfo.email = strncpy(buf, email->str_val, email->str_sz);
-    buf += str_reserve_spc(email);
-    tmp->params.uinfo.display_name = strncpy(buf, display_name->str_val, display_name->str_sz);
-    tmp->params.uinfo.avatar = (void *)avatar->bin_val;
-    tmp->params.uinfo.len  = avatar->bin_sz;
-
-    *req_unmarshal = (Req *)tmp;
     return 0;
 }
 
 static
-int unmarshal_upd_chan_req(const msgpack_object *req, Req **req_unmarshal)
+int unmarshal_req(const MsgSchema *schema, const ReqEnvelope *env, Req **req_unmarshal)
 {
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *name;
-    const msgpack_object *intro;
-    const msgpack_object *avatar;
-    UpdChanReq *tmp;
-    char *buf;
+    Req *tmp;
 
-    assert(req->type == MSGPACK_OBJECT_MAP);
+    tmp = rc_zalloc(schema->sz, NULL);
+    if (!tmp)
+        return -1;
 
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("id");
-            name    = map_val_str("name");
-            intro   = map_val_str("introduction");
-            avatar  = map_val_bin("avatar");
-        });
-    });
+    tmp->method = env->method;
+    tmp->tsx_id = env->tsx_id;
 
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !name || !name->str_sz || !intro || !intro->str_sz || !avatar || !avatar->bin_sz) {
-        vlogE(TAG_RPC "Invalid update_feedinfo request.");
+    if (schema_decode(schema, env->params, tmp) < 0) {
+        vlogE(TAG_RPC "Invalid %s request.", env->method);
+        deref(tmp);
         return -1;
     }
 
-    tmp = rc_zalloc(sizeof(UpdChanReq) + str_reserve_spc(method) +
-                    str_reserve_spc(tk) + str_reserve_spc(name) +
-                    str_reserve_spc(intro) + 6, NULL);  //2 space for empty v2.0 item
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    buf += str_reserve_spc(tk);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.name    = strncpy(buf, name->str_val, name->str_sz);
-    buf += str_reserve_spc(name);
-    tmp->params.intro   = strncpy(buf, intro->str_val, intro->str_sz);
-    tmp->params.avatar  = (void *)avatar->bin_val;
-    tmp->params.sz      = avatar->bin_sz;
-    buf += str_reserve_spc(intro);
-    tmp->params.tipm   = strcpy(buf, "NA");   //empty for v2.0
-    buf += 3;
-    tmp->params.proof  = strcpy(buf, "NA");   //empty for v2.0
-
-    *req_unmarshal = (Req *)tmp;
+    *req_unmarshal = tmp;
     return 0;
 }
 
-static
-int unmarshal_upd_chan_req_2(const msgpack_object *req, Req **req_unmarshal)
+int rpc_unmarshal_req(void *rpc, size_t len, Req **req)
 {
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *name;
-    const msgpack_object *intro;
-    const msgpack_object *avatar;
-    const msgpack_object *tipm;  //v2.0
-    const msgpack_object *proof;  //v2.0
-    UpdChanReq *tmp;
-    char *buf;
+    msgpack_unpacked msgpack;
+    ReqEnvelope env = {0};
+    MsgSchema **req_schemas;
+    MsgSchema *schema;
+    int rc;
 
-    assert(req->type == MSGPACK_OBJECT_MAP);
+    pthread_once(&schemas_once, schemas_init);
 
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("id");
-            name    = map_val_str("name");
-            intro   = map_val_str("introduction");
-            avatar  = map_val_bin("avatar");
-            tipm    = map_val_str("tip_methods");  //v2.0
-            proof   = map_val_str("proof");  //v2.0
-        });
-    });
+    msgpack_unpacked_init(&msgpack);
+    if (msgpack_unpack_next(&msgpack, rpc, len, NULL) != MSGPACK_UNPACK_SUCCESS) {
+        vlogE(TAG_RPC "Decoding msgpack failed.");
+        return -1;
+    }
 
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !name || !name->str_sz || !intro || !intro->str_sz || !avatar || 
-        !avatar->bin_sz || !tipm || !tipm->str_sz || !proof || !proof->str_sz) {
-        vlogE(TAG_RPC "Invalid update_feedinfo request.");
+    if (msgpack.data.type != MSGPACK_OBJECT_MAP) {
+        vlogE(TAG_RPC "Not a msgpack map.");
+        msgpack_unpacked_destroy(&msgpack);
         return -1;
     }
 
-    tmp = rc_zalloc(sizeof(UpdChanReq) + str_reserve_spc(method) +
-                    str_reserve_spc(tk) + str_reserve_spc(name) +
-                    str_reserve_spc(intro) + str_reserve_spc(tipm) +
-                    str_reserve_spc(proof), NULL);  //2.0
-    if (!tmp)
+    if (schema_decode(&req_envelope, &msgpack.data, &env) < 0) {
+        vlogE(TAG_RPC "No version/method/id field.");
+        msgpack_unpacked_destroy(&msgpack);
         return -1;
+    }
 
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    buf += str_reserve_spc(tk);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.name    = strncpy(buf, name->str_val, name->str_sz);
-    buf += str_reserve_spc(name);
-    tmp->params.intro   = strncpy(buf, intro->str_val, intro->str_sz);
-    tmp->params.avatar  = (void *)avatar->bin_val;
-    tmp->params.sz      = avatar->bin_sz;
-    buf += str_reserve_spc(intro);
-    tmp->params.tipm   = strncpy(buf, tipm->str_val, tipm->str_sz);  //v2.0
-    buf += str_reserve_spc(tipm);
-    tmp->params.proof  = strncpy(buf, proof->str_val, proof->str_sz);  //v2.0
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
+    if (!strcmp(env.version, "1.0")) {
+        rpc_version = 1;
+        req_schemas = req_schemas_1_0;
+    } else if (!strcmp(env.version, "2.0")) {
+        rpc_version = 2;
+        req_schemas = req_schemas_2_0;
+    } else {
+        vlogE(TAG_RPC "Unsupported version field.");
+        rc = unmarshal_req(&unknown_req, &env, req);
+        msgpack_unpacked_destroy(&msgpack);
+        return -3;
+    }
+
+    schema = req_schemas[rpc_method_id(env.method, strlen(env.method))];
+    if (schema) {
+        rc = unmarshal_req(schema, &env, req);
+        msgpack_unpacked_destroy(&msgpack);
+        return rc;
+    }
+
+    vlogE(TAG_RPC "Not a valid method.");
+    rc = unmarshal_req(&unknown_req, &env, req);
+    msgpack_unpacked_destroy(&msgpack);
+    return rc < 0 ? -1 : -2;
 }
 
 
+typedef struct {
+    NewPostNotif notif;
+    PostInfo pi;
+} NewPostNotifWithPInfo;
+
 static
-int unmarshal_pub_post_req(const msgpack_object *req, Req **req_unmarshal)
+int unmarshal_new_post_notif(const msgpack_object *notif, Notif **notif_unmarshal)
 {
     const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
     const msgpack_object *chan_id;
+    const msgpack_object *post_id;
     const msgpack_object *content;
-    PubPostReq *tmp;
-    char *buf;
+    const msgpack_object *created_at;
+    NewPostNotifWithPInfo *tmp;
+    void *buf;
 
-    assert(req->type == MSGPACK_OBJECT_MAP);
+    assert(notif->type == MSGPACK_OBJECT_MAP);
 
-    map_iter_kvs(req, {
+    map_iter_kvs(notif, {
         (void)map_val_str("version");
         method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
         map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
             chan_id = map_val_u64("channel_id");
+            post_id = map_val_u64("id");
             content = map_val_bin("content");
+            created_at = map_val_u64("created_at");
         });
     });
 
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !content || !content->bin_sz) {
-        vlogE(TAG_RPC "Invalid publish_post request.");
+    if (!chan_id || !chan_id_is_valid(chan_id->u64_val) ||
+        !post_id || !post_id_is_valid(post_id->u64_val) ||
+        !content || !content->bin_sz || !created_at) {
+        vlogE(TAG_RPC "Invalid new_post notification.");
         return -1;
     }
 
-    tmp = rc_zalloc(sizeof(PubPostReq) + str_reserve_spc(method)
-            + str_reserve_spc(tk) + 10, NULL);  //4 space for empty v2.0 item
+    tmp = rc_zalloc(sizeof(NewPostNotifWithPInfo) + str_reserve_spc(method) +
+                    content->bin_sz, NULL);
     if (!tmp)
         return -1;
 
     buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.content = (void *)content->bin_val;
-    tmp->params.con_sz  = content->bin_sz;
-    buf += str_reserve_spc(tk);  //2.0
-    tmp->params.hash_id = strcpy(buf, "NA");   //empty for v2.0
-    buf += 3;
-    tmp->params.proof   = strcpy(buf, "NA");   //empty for v2.0
-    buf += 3;
-    tmp->params.origin_post_url = strcpy(buf, "NA");   //empty for v2.0
-    buf += 3;
-    char n = 0xA0;
-    tmp->params.thumbnails = memcpy(buf, &n, 1);   //empty for v2.0
-    tmp->params.thu_sz = 1;
-
-    *req_unmarshal = (Req *)tmp;
+    tmp->notif.method                   = strncpy(buf, method->str_val, method->str_sz);
+    buf = (char*)buf + str_reserve_spc(method);
+    tmp->notif.params.pinfo             = &tmp->pi;
+    tmp->notif.params.pinfo->chan_id    = chan_id->u64_val;
+    tmp->notif.params.pinfo->post_id    = post_id->u64_val;
+    tmp->notif.params.pinfo->content    = memcpy(buf, content->bin_val, content->bin_sz);
+    tmp->notif.params.pinfo->con_len    = content->bin_sz;
+    tmp->notif.params.pinfo->created_at = created_at->u64_val;
+
+    *notif_unmarshal = (Notif *)&tmp->notif;
     return 0;
 }
 
+typedef struct {
+    NewCmtNotif notif;
+    CmtInfo ci;
+} NewCmtNotifWithCInfo;
+
 static
-int unmarshal_pub_post_req_2(const msgpack_object *req, Req **req_unmarshal)
+int unmarshal_new_cmt_notif(const msgpack_object *notif, Notif **notif_unmarshal)
 {
     const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
     const msgpack_object *chan_id;
+    const msgpack_object *post_id;
+    const msgpack_object *id;
+    const msgpack_object *cmt_id;
+    const msgpack_object *user_name;
     const msgpack_object *content;
-    const msgpack_object *hash_id;  //2.0
-    const msgpack_object *proof;  //2.0
-    const msgpack_object *origin_post_url;  //2.0
-    const msgpack_object *thumbnails;  //2.0
-    PubPostReq *tmp;
-    char *buf;
+    const msgpack_object *created_at;
+    NewCmtNotifWithCInfo *tmp;
+    void *buf;
 
-    assert(req->type == MSGPACK_OBJECT_MAP);
+    assert(notif->type == MSGPACK_OBJECT_MAP);
 
-    map_iter_kvs(req, {
+    map_iter_kvs(notif, {
         (void)map_val_str("version");
         method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
         map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            content = map_val_bin("content");
-            thumbnails = map_val_bin("thumbnails");  //v2.0
-            hash_id = map_val_str("hash_id");  //v2.0
-            proof   = map_val_str("proof");  //v2.0
-            origin_post_url = map_val_str("origin_post_url");  //v2.0
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !content || !content->bin_sz || !hash_id || !hash_id->str_sz || !proof ||
-        !proof->str_sz || !origin_post_url || !origin_post_url->str_sz ||
-        !thumbnails || !thumbnails->bin_sz) {
-        vlogE(TAG_RPC "Invalid publish_post request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(PubPostReq) + str_reserve_spc(method) +
-            str_reserve_spc(tk) + str_reserve_spc(hash_id) +
-            str_reserve_spc(proof) + str_reserve_spc(origin_post_url), NULL);  //2.0
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.content = (void *)content->bin_val;
-    tmp->params.con_sz  = content->bin_sz;
-    buf += str_reserve_spc(tk);  //2.0
-    tmp->params.hash_id = strncpy(buf, hash_id->str_val, hash_id->str_sz);  //2.0
-    buf += str_reserve_spc(hash_id);
-    tmp->params.proof   = strncpy(buf, proof->str_val, proof->str_sz);  //2.0
-    buf += str_reserve_spc(proof);
-    tmp->params.origin_post_url = strncpy(buf, origin_post_url->str_val,
-            origin_post_url->str_sz);  //2.0
-    tmp->params.thumbnails = (void *)thumbnails->bin_val;  //2.0
-    tmp->params.thu_sz     = thumbnails->bin_sz;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_declare_post_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *content;
-    const msgpack_object *with_notify;
-    DeclarePostReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            content = map_val_bin("content");
-            with_notify = map_val_bool("with_notify");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !content || !content->bin_sz) {
-        vlogE(TAG_RPC "Invalid declare_post request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(DeclarePostReq) + str_reserve_spc(method)
-            + str_reserve_spc(tk) + 10, NULL);  //4 space for empty v2.0 item
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.content = (void *)content->bin_val;
-    tmp->params.con_sz      = content->bin_sz;
-    tmp->params.with_notify = with_notify->bool_val;
-    buf += str_reserve_spc(tk);  //2.0
-    tmp->params.hash_id = strcpy(buf, "NA");   //empty for v2.0
-    buf += 3;
-    tmp->params.proof   = strcpy(buf, "NA");   //empty for v2.0
-    buf += 3;
-    tmp->params.origin_post_url = strcpy(buf, "NA");   //empty for v2.0
-    buf += 3;
-    char n = 0xA0;
-    tmp->params.thumbnails = memcpy(buf, &n, 1);   //empty for v2.0
-    tmp->params.thu_sz = 1;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_declare_post_req_2(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *content;
-    const msgpack_object *with_notify;
-    const msgpack_object *hash_id;  //2.0
-    const msgpack_object *proof;  //2.0
-    const msgpack_object *origin_post_url;  //2.0
-    const msgpack_object *thumbnails;  //2.0
-    DeclarePostReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            content = map_val_bin("content");
-            with_notify = map_val_bool("with_notify");
-            thumbnails = map_val_bin("thumbnails");  //v2.0
-            hash_id = map_val_str("hash_id");  //v2.0
-            proof   = map_val_str("proof");  //v2.0
-            origin_post_url = map_val_str("origin_post_url");  //v2.0
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !content || !content->bin_sz || !hash_id || !hash_id->str_sz || !proof ||
-        !proof->str_sz || !origin_post_url || !origin_post_url->str_sz 
-        || !thumbnails || !thumbnails->bin_sz) {
-        vlogE(TAG_RPC "Invalid declare_post 2.0 request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(DeclarePostReq) + str_reserve_spc(method) +
-            str_reserve_spc(tk) + str_reserve_spc(hash_id) +
-            str_reserve_spc(proof) + str_reserve_spc(origin_post_url), NULL);  //2.0
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.content = (void *)content->bin_val;
-    tmp->params.con_sz      = content->bin_sz;
-    tmp->params.with_notify = with_notify->bool_val;
-    buf += str_reserve_spc(tk);  //2.0
-    tmp->params.hash_id = strncpy(buf, hash_id->str_val, hash_id->str_sz);  //2.0
-    buf += str_reserve_spc(hash_id);
-    tmp->params.proof   = strncpy(buf, proof->str_val, proof->str_sz);  //2.0
-    buf += str_reserve_spc(proof);
-    tmp->params.origin_post_url = strncpy(buf, origin_post_url->str_val,
-            origin_post_url->str_sz);  //2.0
-    tmp->params.thumbnails = (void *)thumbnails->bin_val;  //2.0
-    tmp->params.thu_sz     = thumbnails->bin_sz;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_notify_post_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    NotifyPostReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("post_id");
-        });
-    });
-
-    if (!tk || !tk->str_sz
-    || !chan_id || !chan_id_is_valid(chan_id->u64_val)
-    || !post_id || !post_id_is_valid(post_id->u64_val)) {
-        vlogE(TAG_RPC "Invalid notify_post request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(NotifyPostReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.post_id = post_id->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_edit_post_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    const msgpack_object *content;
-    EditPostReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("id");
-            content = map_val_bin("content");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !post_id || !post_id_is_valid(post_id->u64_val) || !content || !content->bin_sz) {
-        vlogE(TAG_RPC "Invalid edit_post request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(EditPostReq) + str_reserve_spc(method)
-            + str_reserve_spc(tk) + 10, NULL);  //4 space for empty v2.0 item
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.post_id = post_id->u64_val;
-    tmp->params.content = (void *)content->bin_val;
-    tmp->params.con_sz  = content->bin_sz;
-    buf += str_reserve_spc(tk);  //2.0
-    tmp->params.hash_id = strcpy(buf, "NA");   //empty for v2.0
-    buf += 3;
-    tmp->params.proof   = strcpy(buf, "NA");   //empty for v2.0
-    buf += 3;
-    tmp->params.origin_post_url = strcpy(buf, "NA");   //empty for v2.0
-    buf += 3;
-    char n = 0xA0;
-    tmp->params.thumbnails = memcpy(buf, &n, 1);   //empty for v2.0
-    tmp->params.thu_sz = 1;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_edit_post_req_2(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    const msgpack_object *content;
-    const msgpack_object *hash_id;  //2.0
-    const msgpack_object *proof;  //2.0
-    const msgpack_object *origin_post_url;  //2.0
-    const msgpack_object *thumbnails;  //2.0
-    EditPostReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("id");
-            content = map_val_bin("content");
-            thumbnails = map_val_bin("thumbnails");  //v2.0
-            hash_id = map_val_str("hash_id");  //v2.0
-            proof   = map_val_str("proof");  //v2.0
-            origin_post_url = map_val_str("origin_post_url");  //v2.0
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !post_id || !post_id_is_valid(post_id->u64_val) || !content ||
-        !content->bin_sz || !hash_id || !hash_id->str_sz || !proof ||
-        !proof->str_sz || !origin_post_url || !origin_post_url->str_sz ||
-        !thumbnails || !thumbnails->bin_sz) {
-        vlogE(TAG_RPC "Invalid publish_post request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(EditPostReq) + str_reserve_spc(method) +
-            str_reserve_spc(tk) + str_reserve_spc(hash_id) +
-            str_reserve_spc(proof) + str_reserve_spc(origin_post_url), NULL);  //2.0
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.post_id = post_id->u64_val;
-    tmp->params.content = (void *)content->bin_val;
-    tmp->params.con_sz  = content->bin_sz;
-    buf += str_reserve_spc(tk);  //2.0
-    tmp->params.hash_id = strncpy(buf, hash_id->str_val, hash_id->str_sz);  //2.0
-    buf += str_reserve_spc(hash_id);
-    tmp->params.proof   = strncpy(buf, proof->str_val, proof->str_sz);  //2.0
-    buf += str_reserve_spc(proof);
-    tmp->params.origin_post_url = strncpy(buf, origin_post_url->str_val,
-            origin_post_url->str_sz);  //2.0
-    tmp->params.thumbnails = (void *)thumbnails->bin_val;  //2.0
-    tmp->params.thu_sz     = thumbnails->bin_sz;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-
-static
-int unmarshal_del_post_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    DelPostReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("id");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !post_id || !post_id_is_valid(post_id->u64_val)) {
-        vlogE(TAG_RPC "Invalid delete_post request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(DelPostReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.post_id = post_id->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_post_cmt_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    const msgpack_object *cmt_id;
-    const msgpack_object *content;
-    PostCmtReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("post_id");
-            cmt_id  = map_val_u64("comment_id");
-            content = map_val_bin("content");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !post_id || !post_id_is_valid(post_id->u64_val) ||
-        !cmt_id || !content || !content->bin_sz) {
-        vlogE(TAG_RPC "Invalid post_comment request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(PostCmtReq) + str_reserve_spc(method)
-            + str_reserve_spc(tk) + 7, NULL);  //3 space for empty v2.0 item
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.post_id = post_id->u64_val;
-    tmp->params.cmt_id  = cmt_id->u64_val;
-    tmp->params.content = (void *)content->bin_val;
-    tmp->params.con_sz      = content->bin_sz;
-    buf += str_reserve_spc(tk);  //2.0
-    tmp->params.hash_id = strcpy(buf, "NA");   //empty for v2.0
-    buf += 3;
-    tmp->params.proof   = strcpy(buf, "NA");   //empty for v2.0
-    buf += 3;
-    char n = 0xA0;
-    tmp->params.thumbnails = memcpy(buf, &n, 1);   //empty for v2.0
-    tmp->params.thu_sz = 1;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_post_cmt_req_2(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    const msgpack_object *cmt_id;
-    const msgpack_object *content;
-    const msgpack_object *hash_id;  //2.0
-    const msgpack_object *proof;  //2.0
-    const msgpack_object *thumbnails;  //2.0
-    PostCmtReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("post_id");
-            cmt_id  = map_val_u64("comment_id");
-            content = map_val_bin("content");
-            thumbnails = map_val_bin("thumbnails");  //v2.0
-            hash_id = map_val_str("hash_id");  //v2.0
-            proof   = map_val_str("proof");  //v2.0
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !post_id || !post_id_is_valid(post_id->u64_val) || !cmt_id ||
-        !content || !content->bin_sz || !hash_id || !hash_id->str_sz ||
-        !proof || !proof->str_sz || !thumbnails || !thumbnails->bin_sz) {
-        vlogE(TAG_RPC "Invalid post_comment 2.0 request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(PostCmtReq) + str_reserve_spc(method)
-            + str_reserve_spc(tk) + str_reserve_spc(hash_id)
-            + str_reserve_spc(proof), NULL);  //2.0
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.post_id = post_id->u64_val;
-    tmp->params.cmt_id  = cmt_id->u64_val;
-    tmp->params.content = (void *)content->bin_val;
-    tmp->params.con_sz  = content->bin_sz;
-    buf += str_reserve_spc(tk);  //2.0
-    tmp->params.hash_id = strncpy(buf, hash_id->str_val, hash_id->str_sz);  //2.0
-    buf += str_reserve_spc(hash_id);
-    tmp->params.proof   = strncpy(buf, proof->str_val, proof->str_sz);  //2.0
-    tmp->params.thumbnails = (void *)thumbnails->bin_val;  //2.0
-    tmp->params.thu_sz     = thumbnails->bin_sz;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_edit_cmt_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    const msgpack_object *id;
-    const msgpack_object *cmt_id;
-    const msgpack_object *content;
-    EditCmtReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("post_id");
-            id      = map_val_u64("id");
-            cmt_id  = map_val_u64("comment_id");
-            content = map_val_bin("content");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !post_id || !post_id_is_valid(post_id->u64_val) ||
-        !id || !cmt_id_is_valid(id->u64_val) ||
-        !cmt_id || !content || !content->bin_sz) {
-        vlogE(TAG_RPC "Invalid edit_comment request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(EditCmtReq) + str_reserve_spc(method)
-            + str_reserve_spc(tk) + 7, NULL);  //3 space for empty v2.0 item
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.post_id = post_id->u64_val;
-    tmp->params.id      = id->u64_val;
-    tmp->params.cmt_id  = cmt_id->u64_val;
-    tmp->params.content = (void *)content->bin_val;
-    tmp->params.con_sz      = content->bin_sz;
-    buf += str_reserve_spc(tk);  //2.0
-    tmp->params.hash_id = strcpy(buf, "NA");   //empty for v2.0
-    buf += 3;
-    tmp->params.proof   = strcpy(buf, "NA");   //empty for v2.0
-    buf += 3;
-    char n = 0xA0;
-    tmp->params.thumbnails = memcpy(buf, &n, 1);   //empty for v2.0
-    tmp->params.thu_sz = 1;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_edit_cmt_req_2(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    const msgpack_object *id;
-    const msgpack_object *cmt_id;
-    const msgpack_object *content;
-    const msgpack_object *hash_id;  //2.0
-    const msgpack_object *proof;  //2.0
-    const msgpack_object *thumbnails;  //2.0
-    EditCmtReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("post_id");
-            id      = map_val_u64("id");
-            cmt_id  = map_val_u64("comment_id");
-            content = map_val_bin("content");
-            thumbnails = map_val_bin("thumbnails");  //v2.0
-            hash_id = map_val_str("hash_id");  //v2.0
-            proof   = map_val_str("proof");  //v2.0
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !post_id || !post_id_is_valid(post_id->u64_val) || !id ||
-        !cmt_id_is_valid(id->u64_val) || !cmt_id || !content ||
-        !content->bin_sz || !hash_id || !hash_id->str_sz || !proof ||
-        !proof->str_sz || !thumbnails || !thumbnails->bin_sz) {
-        vlogE(TAG_RPC "Invalid edit_comment request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(EditCmtReq) + str_reserve_spc(method)
-            + str_reserve_spc(tk) + str_reserve_spc(hash_id)
-            + str_reserve_spc(proof), NULL);  //2.0
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.post_id = post_id->u64_val;
-    tmp->params.id      = id->u64_val;
-    tmp->params.cmt_id  = cmt_id->u64_val;
-    tmp->params.content = (void *)content->bin_val;
-    tmp->params.con_sz  = content->bin_sz;
-    buf += str_reserve_spc(tk);  //2.0
-    tmp->params.hash_id = strncpy(buf, hash_id->str_val, hash_id->str_sz);  //2.0
-    buf += str_reserve_spc(hash_id);
-    tmp->params.proof   = strncpy(buf, proof->str_val, proof->str_sz);  //2.0
-    tmp->params.thumbnails = (void *)thumbnails->bin_val;  //2.0
-    tmp->params.thu_sz     = thumbnails->bin_sz;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_del_cmt_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    const msgpack_object *id;
-    DelCmtReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("post_id");
-            id      = map_val_u64("id");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !post_id || !post_id_is_valid(post_id->u64_val) || !id || !cmt_id_is_valid(id->u64_val)) {
-        vlogE(TAG_RPC "Invalid delete_comment request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(DelCmtReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.post_id = post_id->u64_val;
-    tmp->params.id      = id->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_block_cmt_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    const msgpack_object *cmt_id;
-    BlockCmtReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("post_id");
-            cmt_id  = map_val_u64("comment_id");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !post_id || !post_id_is_valid(post_id->u64_val) || !cmt_id || !cmt_id_is_valid(cmt_id->u64_val)) {
-        vlogE(TAG_RPC "Invalid block_comment request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(BlockCmtReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf +=  str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.post_id = post_id->u64_val;
-    tmp->params.cmt_id  = cmt_id->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_unblock_cmt_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    const msgpack_object *cmt_id;
-    UnblockCmtReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("post_id");
-            cmt_id  = map_val_u64("comment_id");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !post_id || !post_id_is_valid(post_id->u64_val) || !cmt_id || !cmt_id_is_valid(cmt_id->u64_val)) {
-        vlogE(TAG_RPC "Invalid block_comment request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(UnblockCmtReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.post_id = post_id->u64_val;
-    tmp->params.cmt_id  = cmt_id->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_post_like_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    const msgpack_object *cmt_id;
-    PostLikeReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("post_id");
-            cmt_id  = map_val_u64("comment_id");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !post_id || !post_id_is_valid(post_id->u64_val) || !cmt_id) {
-        vlogE(TAG_RPC "Invalid post_like request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(PostLikeReq) + str_reserve_spc(method) +
-            str_reserve_spc(tk) + 3, NULL);  //1 space for empty v2.0 item
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.post_id = post_id->u64_val;
-    tmp->params.cmt_id  = cmt_id->u64_val;
-    buf += str_reserve_spc(tk);
-    tmp->params.proof  = strcpy(buf, "NA");   //empty for v2.0
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_post_like_req_2(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    const msgpack_object *cmt_id;
-    const msgpack_object *proof;  //v2.0
-    PostLikeReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("post_id");
-            cmt_id  = map_val_u64("comment_id");
-            proof   = map_val_str("proof");  //v2.0
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !post_id || !post_id_is_valid(post_id->u64_val) || !cmt_id || !proof ||
-        !proof->str_sz) {
-        vlogE(TAG_RPC "Invalid post_like request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(PostLikeReq) + str_reserve_spc(method) +
-            str_reserve_spc(tk) + str_reserve_spc(proof), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.post_id = post_id->u64_val;
-    tmp->params.cmt_id  = cmt_id->u64_val;
-    buf += str_reserve_spc(tk);
-    tmp->params.proof   = strncpy(buf, proof->str_val, proof->str_sz);  //v2.0
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_post_unlike_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    const msgpack_object *cmt_id;
-    PostLikeReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("post_id");
-            cmt_id  = map_val_u64("comment_id");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !post_id || !post_id_is_valid(post_id->u64_val) || !cmt_id) {
-        vlogE(TAG_RPC "Invalid post_like request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(PostUnlikeReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.post_id = post_id->u64_val;
-    tmp->params.cmt_id  = cmt_id->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_get_my_chans_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *by;
-    const msgpack_object *upper;
-    const msgpack_object *lower;
-    const msgpack_object *maxcnt;
-    GetMyChansReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk     = map_val_str("access_token");
-            by     = map_val_u64("by");
-            upper  = map_val_u64("upper_bound");
-            lower  = map_val_u64("lower_bound");
-            maxcnt = map_val_u64("max_count");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !by || !qry_fld_is_valid(by->u64_val) || !upper || !lower || !maxcnt) {
-        vlogE(TAG_RPC "Invalid get_my_channels request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(GetMyChansReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method           = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id           = tsx_id->u64_val;
-    tmp->params.tk        = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.qc.by     = by->u64_val;
-    tmp->params.qc.upper  = upper->u64_val;
-    tmp->params.qc.lower  = lower->u64_val;
-    tmp->params.qc.maxcnt = maxcnt->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_get_my_chans_meta_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *by;
-    const msgpack_object *upper;
-    const msgpack_object *lower;
-    const msgpack_object *maxcnt;
-    GetMyChansMetaReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk     = map_val_str("access_token");
-            by     = map_val_u64("by");
-            upper  = map_val_u64("upper_bound");
-            lower  = map_val_u64("lower_bound");
-            maxcnt = map_val_u64("max_count");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !by || !qry_fld_is_valid(by->u64_val) || !upper || !lower || !maxcnt) {
-        vlogE(TAG_RPC "Invalid get_my_channels_metadata request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(GetMyChansMetaReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method           = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id           = tsx_id->u64_val;
-    tmp->params.tk        = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.qc.by     = by->u64_val;
-    tmp->params.qc.upper  = upper->u64_val;
-    tmp->params.qc.lower  = lower->u64_val;
-    tmp->params.qc.maxcnt = maxcnt->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_get_chans_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *by;
-    const msgpack_object *upper;
-    const msgpack_object *lower;
-    const msgpack_object *maxcnt;
-    GetChansReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk     = map_val_str("access_token");
-            by     = map_val_u64("by");
-            upper  = map_val_u64("upper_bound");
-            lower  = map_val_u64("lower_bound");
-            maxcnt = map_val_u64("max_count");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !by || !qry_fld_is_valid(by->u64_val) || !upper || !lower || !maxcnt) {
-        vlogE(TAG_RPC "Invalid get_channels request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(GetChansReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method           = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id           = tsx_id->u64_val;
-    tmp->params.tk        = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.qc.by     = by->u64_val;
-    tmp->params.qc.upper  = upper->u64_val;
-    tmp->params.qc.lower  = lower->u64_val;
-    tmp->params.qc.maxcnt = maxcnt->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_get_chan_dtl_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *id;
-    GetChanDtlReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk = map_val_str("access_token");
-            id = map_val_u64("id");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !id || !chan_id_is_valid(id->u64_val)) {
-        vlogE(TAG_RPC "Invalid get_channel_detail request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(GetChanDtlReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method    = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id    = tsx_id->u64_val;
-    tmp->params.tk = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.id = id->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_get_sub_chans_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *by;
-    const msgpack_object *upper;
-    const msgpack_object *lower;
-    const msgpack_object *maxcnt;
-    GetSubChansReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk     = map_val_str("access_token");
-            by     = map_val_u64("by");
-            upper  = map_val_u64("upper_bound");
-            lower  = map_val_u64("lower_bound");
-            maxcnt = map_val_u64("max_count");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !by || !qry_fld_is_valid(by->u64_val) || !upper || !lower || !maxcnt) {
-        vlogE(TAG_RPC "Invalid get_subscribed_channels request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(GetSubChansReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method           = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id           = tsx_id->u64_val;
-    tmp->params.tk        = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.qc.by     = by->u64_val;
-    tmp->params.qc.upper  = upper->u64_val;
-    tmp->params.qc.lower  = lower->u64_val;
-    tmp->params.qc.maxcnt = maxcnt->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_get_posts_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *by;
-    const msgpack_object *upper;
-    const msgpack_object *lower;
-    const msgpack_object *maxcnt;
-    GetPostsReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            by      = map_val_u64("by");
-            upper   = map_val_u64("upper_bound");
-            lower   = map_val_u64("lower_bound");
-            maxcnt  = map_val_u64("max_count");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !by || !qry_fld_is_valid(by->u64_val) || !upper || !lower || !maxcnt) {
-        vlogE(TAG_RPC "Invalid get_posts request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(GetPostsReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method           = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id           = tsx_id->u64_val;
-    tmp->params.tk        = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id   = chan_id->u64_val;
-    tmp->params.qc.by     = by->u64_val;
-    tmp->params.qc.upper  = upper->u64_val;
-    tmp->params.qc.lower  = lower->u64_val;
-    tmp->params.qc.maxcnt = maxcnt->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_get_posts_lac_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *by;
-    const msgpack_object *upper;
-    const msgpack_object *lower;
-    const msgpack_object *maxcnt;
-    GetPostsLACReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            by      = map_val_u64("by");
-            upper   = map_val_u64("upper_bound");
-            lower   = map_val_u64("lower_bound");
-            maxcnt  = map_val_u64("max_count");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !by || !qry_fld_is_valid(by->u64_val) || !upper || !lower || !maxcnt) {
-        vlogE(TAG_RPC "Invalid get_posts_likes_and_comments request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(GetPostsLACReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method           = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id           = tsx_id->u64_val;
-    tmp->params.tk        = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id   = chan_id->u64_val;
-    tmp->params.qc.by     = by->u64_val;
-    tmp->params.qc.upper  = upper->u64_val;
-    tmp->params.qc.lower  = lower->u64_val;
-    tmp->params.qc.maxcnt = maxcnt->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_get_liked_posts_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *by;
-    const msgpack_object *upper;
-    const msgpack_object *lower;
-    const msgpack_object *maxcnt;
-    GetLikedPostsReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            by      = map_val_u64("by");
-            upper   = map_val_u64("upper_bound");
-            lower   = map_val_u64("lower_bound");
-            maxcnt  = map_val_u64("max_count");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !by || !qry_fld_is_valid(by->u64_val) ||
-        !upper || !lower || !maxcnt) {
-        vlogE(TAG_RPC "Invalid get_liked_posts request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(GetLikedPostsReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method           = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id           = tsx_id->u64_val;
-    tmp->params.tk        = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.qc.by     = by->u64_val;
-    tmp->params.qc.upper  = upper->u64_val;
-    tmp->params.qc.lower  = lower->u64_val;
-    tmp->params.qc.maxcnt = maxcnt->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_get_liked_data_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *by;
-    const msgpack_object *upper;
-    const msgpack_object *lower;
-    const msgpack_object *maxcnt;
-    GetLikedDataReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            by      = map_val_u64("by");
-            upper   = map_val_u64("upper_bound");
-            lower   = map_val_u64("lower_bound");
-            maxcnt  = map_val_u64("max_count");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !by || !qry_fld_is_valid(by->u64_val) ||
-        !upper || !lower || !maxcnt) {
-        vlogE(TAG_RPC "Invalid get_liked_data request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(GetLikedDataReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method           = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id           = tsx_id->u64_val;
-    tmp->params.tk        = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.qc.by     = by->u64_val;
-    tmp->params.qc.upper  = upper->u64_val;
-    tmp->params.qc.lower  = lower->u64_val;
-    tmp->params.qc.maxcnt = maxcnt->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_get_cmts_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    const msgpack_object *by;
-    const msgpack_object *upper;
-    const msgpack_object *lower;
-    const msgpack_object *maxcnt;
-    GetCmtsReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("post_id");
-            by      = map_val_u64("by");
-            upper   = map_val_u64("upper_bound");
-            lower   = map_val_u64("lower_bound");
-            maxcnt  = map_val_u64("max_count");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !post_id || !post_id_is_valid(post_id->u64_val) ||
-        !by || !qry_fld_is_valid(by->u64_val) || !upper || !lower || !maxcnt) {
-        vlogE(TAG_RPC "Invalid get_comments request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(GetCmtsReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method           = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id           = tsx_id->u64_val;
-    tmp->params.tk        = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id   = chan_id->u64_val;
-    tmp->params.post_id   = post_id->u64_val;
-    tmp->params.qc.by     = by->u64_val;
-    tmp->params.qc.upper  = upper->u64_val;
-    tmp->params.qc.lower  = lower->u64_val;
-    tmp->params.qc.maxcnt = maxcnt->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_get_cmts_likes_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    const msgpack_object *by;
-    const msgpack_object *upper;
-    const msgpack_object *lower;
-    const msgpack_object *maxcnt;
-    GetCmtsLikesReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("post_id");
-            by      = map_val_u64("by");
-            upper   = map_val_u64("upper_bound");
-            lower   = map_val_u64("lower_bound");
-            maxcnt  = map_val_u64("max_count");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !post_id || !post_id_is_valid(post_id->u64_val) ||
-        !by || !qry_fld_is_valid(by->u64_val) || !upper || !lower || !maxcnt) {
-        vlogE(TAG_RPC "Invalid get_comments_likes request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(GetCmtsLikesReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method           = strncpy(buf, method->str_val, method->str_sz);
-    buf +=  str_reserve_spc(method);
-    tmp->tsx_id           = tsx_id->u64_val;
-    tmp->params.tk        = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.chan_id   = chan_id->u64_val;
-    tmp->params.post_id   = post_id->u64_val;
-    tmp->params.qc.by     = by->u64_val;
-    tmp->params.qc.upper  = upper->u64_val;
-    tmp->params.qc.lower  = lower->u64_val;
-    tmp->params.qc.maxcnt = maxcnt->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_get_stats_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    GetStatsReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk = map_val_str("access_token");
-        });
-    });
-
-    if (!tk || !tk->str_sz) {
-        vlogE(TAG_RPC "Invalid get_statistics request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(GetStatsReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method    = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id    = tsx_id->u64_val;
-    tmp->params.tk = strncpy(buf, tk->str_val, tk->str_sz);
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_sub_chan_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *id;
-    SubChanReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk = map_val_str("access_token");
-            id = map_val_u64("id");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !id || !chan_id_is_valid(id->u64_val)) {
-        vlogE(TAG_RPC "Invalid subscribe_channel request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(SubChanReq) + str_reserve_spc(method) + 
-            str_reserve_spc(tk) + 3, NULL);  //1 space for empty v2.0 item
-    if (!tmp)
-        return -1;
-
-    buf = (char*)(tmp + 1);
-    tmp->method    = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id    = tsx_id->u64_val;
-    tmp->params.tk = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.id = id->u64_val;
-    buf += str_reserve_spc(tk);
-    tmp->params.proof  = strcpy(buf, "NA");   //empty for v2.0
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_sub_chan_req_2(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *id;
-    const msgpack_object *proof;  //v2.0
-    SubChanReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk = map_val_str("access_token");
-            id = map_val_u64("id");
-            proof = map_val_str("proof");  //v2.0
-        });
-    });
-
-    if (!tk || !tk->str_sz || !id || !chan_id_is_valid(id->u64_val) || 
-        !proof || !proof->str_sz) {
-        vlogE(TAG_RPC "Invalid subscribe_channel request 2.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(SubChanReq) + str_reserve_spc(method) +
-            str_reserve_spc(tk) + str_reserve_spc(proof), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char*)(tmp + 1);
-    tmp->method    = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id    = tsx_id->u64_val;
-    tmp->params.tk = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.id = id->u64_val;
-    buf += str_reserve_spc(tk);
-    tmp->params.proof = strncpy(buf, proof->str_val, proof->str_sz);  //v2.0
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_unsub_chan_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *id;
-    UnsubChanReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk = map_val_str("access_token");
-            id = map_val_u64("id");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !id || !chan_id_is_valid(id->u64_val)) {
-        vlogE(TAG_RPC "Invalid unsubscribe_channel request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(UnsubChanReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char*)(tmp + 1);
-    tmp->method    = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id    = tsx_id->u64_val;
-    tmp->params.tk = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.id = id->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_enbl_notif_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    EnblNotifReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk = map_val_str("access_token");
-        });
-    });
-
-    if (!tk || !tk->str_sz) {
-        vlogE(TAG_RPC "Invalid enable_notification request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(EnblNotifReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method    = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id    = tsx_id->u64_val;
-    tmp->params.tk = strncpy(buf, tk->str_val, tk->str_sz);
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_set_binary_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *key;
-    const msgpack_object *algo;
-    const msgpack_object *checksum;
-    const msgpack_object *content;
-    SetBinaryReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk       = map_val_str("access_token");
-            key      = map_val_str("key");
-            algo     = map_val_str("algo");
-            checksum = map_val_str("checksum");
-            content  = map_val_bin("content");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !key || !key->str_sz) {
-        vlogE(TAG_RPC "Invalid set_binary request.");
-        return -1;
-    }
-
-    size_t str_size = str_reserve_spc(method)
-                 + str_reserve_spc(tk) + str_reserve_spc(key)
-                 + str_reserve_spc(algo) + str_reserve_spc(checksum);
-    tmp = rc_zalloc(sizeof(*tmp) + str_size, NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method          = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id          = tsx_id->u64_val;
-    tmp->params.tk       = strncpy(buf, tk->str_val, tk->str_sz);
-    buf += str_reserve_spc(tk);
-    tmp->params.key      = strncpy(buf, key->str_val, key->str_sz);
-    buf += str_reserve_spc(key);
-    tmp->params.algo     = strncpy(buf, algo->str_val, algo->str_sz);
-    buf += str_reserve_spc(algo);
-    tmp->params.checksum = strncpy(buf, checksum->str_val, checksum->str_sz);
-    buf += str_reserve_spc(checksum);
-    if(content) {
-        tmp->params.content = (void *)content->bin_val;
-        tmp->params.content_sz      = content->bin_sz;
-    }
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_get_binary_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *key;
-    GetBinaryReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk       = map_val_str("access_token");
-            key      = map_val_str("key");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !key || !key->str_sz) {
-        vlogE(TAG_RPC "Invalid get_binary request.");
-        return -1;
-    }
-
-    int str_size = str_reserve_spc(method)
-                 + str_reserve_spc(tk) + str_reserve_spc(key);
-    tmp = rc_zalloc(sizeof(*tmp) + str_size, NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method          = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id          = tsx_id->u64_val;
-    tmp->params.tk       = strncpy(buf, tk->str_val, tk->str_sz);
-    buf += str_reserve_spc(tk);
-    tmp->params.key      = strncpy(buf, key->str_val, key->str_sz);
-    buf += str_reserve_spc(key);
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_get_srv_ver_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    GetSrvVerReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            map_val_str("access_token");
-        });
-    });
-
-    int str_size = str_reserve_spc(method);
-    tmp = rc_zalloc(sizeof(*tmp) + str_size, NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method          = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id          = tsx_id->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_report_illegal_cmt_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    const msgpack_object *cmt_id;
-    const msgpack_object *reasons;
-    ReportIllegalCmtReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("post_id");
-            cmt_id  = map_val_u64("comment_id");
-            reasons = map_val_str("reasons");
-        });
-    });
-
-    if (!tk || !tk->str_sz || !chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !post_id || !post_id_is_valid(post_id->u64_val) || !cmt_id ||
-        !reasons || !reasons->str_sz) {
-        vlogE(TAG_RPC "Invalid report_illegal_cmt request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(ReportIllegalCmtReq) + str_reserve_spc(method) + str_reserve_spc(tk) + str_reserve_spc(reasons), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method         = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id         = tsx_id->u64_val;
-    tmp->params.tk      = strncpy(buf, tk->str_val, tk->str_sz);
-    buf += str_reserve_spc(tk);
-    tmp->params.chan_id = chan_id->u64_val;
-    tmp->params.post_id = post_id->u64_val;
-    tmp->params.cmt_id  = cmt_id->u64_val;
-    tmp->params.reasons      = strncpy(buf, reasons->str_val, reasons->str_sz);
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_get_reported_cmts_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    const msgpack_object *tk;
-    const msgpack_object *by;
-    const msgpack_object *upper;
-    const msgpack_object *lower;
-    const msgpack_object *maxcnt;
-    GetReportedCmtsReq *tmp;
-    char *buf;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-        map_iter_kvs(map_val_map("params"), {
-            tk      = map_val_str("access_token");
-            by      = map_val_u64("by");
-            upper   = map_val_u64("upper_bound");
-            lower   = map_val_u64("lower_bound");
-            maxcnt  = map_val_u64("max_count");
-        });
-    });
-
-    if (!tk || !tk->str_sz ||
-        !by || !qry_fld_is_valid(by->u64_val) || !upper || !lower || !maxcnt) {
-        vlogE(TAG_RPC "Invalid get_reported_comments request.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(GetReportedCmtsReq) + str_reserve_spc(method) + str_reserve_spc(tk), NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method           = strncpy(buf, method->str_val, method->str_sz);
-    buf += str_reserve_spc(method);
-    tmp->tsx_id           = tsx_id->u64_val;
-    tmp->params.tk        = strncpy(buf, tk->str_val, tk->str_sz);
-    tmp->params.qc.by     = by->u64_val;
-    tmp->params.qc.upper  = upper->u64_val;
-    tmp->params.qc.lower  = lower->u64_val;
-    tmp->params.qc.maxcnt = maxcnt->u64_val;
-
-    *req_unmarshal = (Req *)tmp;
-    return 0;
-}
-
-static
-int unmarshal_unknown_req(const msgpack_object *req, Req **req_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    char *buf;
-    Req *tmp;
-
-    assert(req->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(req, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-    });
-
-    tmp = rc_zalloc(sizeof(Req) + str_reserve_spc(method), NULL);
-    if(!tmp)
-     return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->method = strncpy(buf, method->str_val, method->str_sz);
-    tmp->tsx_id = tsx_id->u64_val;
-
-    *req_unmarshal = tmp;
-    return 0;
-}
-
-typedef int ReqHdlr(const msgpack_object *req_map, Req **req_unmarshal);
-struct ReqParser {
-    char *method;
-    ReqHdlr *parser;
-};
-
-static struct ReqParser req_parsers_1_0[] = {
-    {"declare_owner"               , unmarshal_decl_owner_req         },
-    {"import_did"                  , unmarshal_imp_did_req            },
-    {"issue_credential"            , unmarshal_iss_vc_req             },
-    {"update_credential"           , unmarshal_update_vc_req          },
-    {"signin_request_challenge"    , unmarshal_signin_req_chal_req    },
-    {"signin_confirm_challenge"    , unmarshal_signin_conf_chal_req   },
-    {"create_channel"              , unmarshal_create_chan_req        },
-    {"update_feedinfo"             , unmarshal_upd_chan_req           },
-    {"update_user_info"            , unmarshal_upd_user_info_req      },  //2.0
-    {"publish_post"                , unmarshal_pub_post_req           },
-    {"declare_post"                , unmarshal_declare_post_req       },
-    {"notify_post"                 , unmarshal_notify_post_req        },
-    {"edit_post"                   , unmarshal_edit_post_req          },
-    {"delete_post"                 , unmarshal_del_post_req           },
-    {"post_comment"                , unmarshal_post_cmt_req           },
-    {"edit_comment"                , unmarshal_edit_cmt_req           },
-    {"delete_comment"              , unmarshal_del_cmt_req            },
-    {"block_comment"               , unmarshal_block_cmt_req          },
-    {"unblock_comment"             , unmarshal_unblock_cmt_req        },
-    {"post_like"                   , unmarshal_post_like_req          },
-    {"post_unlike"                 , unmarshal_post_unlike_req        },
-    {"get_my_channels"             , unmarshal_get_my_chans_req       },
-    {"get_my_channels_metadata"    , unmarshal_get_my_chans_meta_req  },
-    {"get_channels"                , unmarshal_get_chans_req          },
-    {"get_channel_detail"          , unmarshal_get_chan_dtl_req       },
-    {"get_subscribed_channels"     , unmarshal_get_sub_chans_req      },
-    {"get_posts"                   , unmarshal_get_posts_req          },
-    {"get_posts_likes_and_comments", unmarshal_get_posts_lac_req      },
-    {"get_liked_posts"             , unmarshal_get_liked_posts_req    },
-    {"get_liked_data"              , unmarshal_get_liked_data_req     },
-    {"get_comments"                , unmarshal_get_cmts_req           },
-    {"get_comments_likes"          , unmarshal_get_cmts_likes_req     },
-    {"get_statistics"              , unmarshal_get_stats_req          },
-    {"subscribe_channel"           , unmarshal_sub_chan_req           },
-    {"unsubscribe_channel"         , unmarshal_unsub_chan_req         },
-    {"enable_notification"         , unmarshal_enbl_notif_req         },
-    {"set_binary"                  , unmarshal_set_binary_req         },
-    {"get_binary"                  , unmarshal_get_binary_req         },
-    {"get_service_version"         , unmarshal_get_srv_ver_req        },
-    {"report_illegal_comment"      , unmarshal_report_illegal_cmt_req },
-    {"get_reported_comments"       , unmarshal_get_reported_cmts_req  },
-};
-
-static struct ReqParser req_parsers_2_0[] = {
-    {"declare_owner"               , unmarshal_decl_owner_req         },
-    {"import_did"                  , unmarshal_imp_did_req            },
-    {"issue_credential"            , unmarshal_iss_vc_req             },
-    {"update_credential"           , unmarshal_update_vc_req          },
-    {"signin_request_challenge"    , unmarshal_signin_req_chal_req    },
-    {"signin_confirm_challenge"    , unmarshal_signin_conf_chal_req   },
-    {"create_channel"              , unmarshal_create_chan_req_2      },
-    {"update_feedinfo"             , unmarshal_upd_chan_req_2         },
-    {"update_user_info"            , unmarshal_upd_user_info_req      },  //2.0
-    {"publish_post"                , unmarshal_pub_post_req_2         },
-    {"declare_post"                , unmarshal_declare_post_req_2     },
-    {"notify_post"                 , unmarshal_notify_post_req        },
-    {"edit_post"                   , unmarshal_edit_post_req_2        },
-    {"delete_post"                 , unmarshal_del_post_req           },
-    {"post_comment"                , unmarshal_post_cmt_req_2         },
-    {"edit_comment"                , unmarshal_edit_cmt_req_2         },
-    {"delete_comment"              , unmarshal_del_cmt_req            },
-    {"block_comment"               , unmarshal_block_cmt_req          },
-    {"unblock_comment"             , unmarshal_unblock_cmt_req        },
-    {"post_like"                   , unmarshal_post_like_req_2        },
-    {"post_unlike"                 , unmarshal_post_unlike_req        },
-    {"get_my_channels"             , unmarshal_get_my_chans_req       },
-    {"get_my_channels_metadata"    , unmarshal_get_my_chans_meta_req  },
-    {"get_channels"                , unmarshal_get_chans_req          },
-    {"get_channel_detail"          , unmarshal_get_chan_dtl_req       },
-    {"get_subscribed_channels"     , unmarshal_get_sub_chans_req      },
-    {"get_posts"                   , unmarshal_get_posts_req          },
-    {"get_posts_likes_and_comments", unmarshal_get_posts_lac_req      },
-    {"get_liked_posts"             , unmarshal_get_liked_posts_req    },
-    {"get_liked_data"              , unmarshal_get_liked_data_req     },
-    {"get_comments"                , unmarshal_get_cmts_req           },
-    {"get_comments_likes"          , unmarshal_get_cmts_likes_req     },
-    {"get_statistics"              , unmarshal_get_stats_req          },
-    {"subscribe_channel"           , unmarshal_sub_chan_req_2         },
-    {"unsubscribe_channel"         , unmarshal_unsub_chan_req         },
-    {"enable_notification"         , unmarshal_enbl_notif_req         },
-    {"set_binary"                  , unmarshal_set_binary_req         },
-    {"get_binary"                  , unmarshal_get_binary_req         },
-    {"get_service_version"         , unmarshal_get_srv_ver_req        },
-    {"report_illegal_comment"      , unmarshal_report_illegal_cmt_req },
-    {"get_reported_comments"       , unmarshal_get_reported_cmts_req  },
-};
-
-int rpc_unmarshal_req(const void *rpc, size_t len, Req **req)
-{
-    const msgpack_object *version;
-    const msgpack_object *method;
-    const msgpack_object *tsx_id;
-    char method_str[1024];
-    msgpack_object obj;
-    struct ReqParser *req_parsers;
-    int req_parsers_size;
-    int rc;
-    int i;
-
-    msgpack_unpacked_init(&msgpack);
-    if (msgpack_unpack_next(&msgpack, rpc, len, NULL) != MSGPACK_UNPACK_SUCCESS) {
-        vlogE(TAG_RPC "Decoding msgpack failed.");
-        return -1;
-    }
-
-    obj = msgpack.data;
-    if (obj.type != MSGPACK_OBJECT_MAP) {
-        vlogE(TAG_RPC "Not a msgpack map.");
-        msgpack_unpacked_destroy(&msgpack);
-        return -1;
-    }
-
-    map_iter_kvs(&obj, {
-        version = map_val_str("version");
-        method  = map_val_str("method");
-        tsx_id  = map_val_u64("id");
-    });
-
-    if (!version || !version->str_sz ||
-        !method || !method->str_sz ||
-        !tsx_id) {
-        vlogE(TAG_RPC "No version/method/id field.");
-        msgpack_unpacked_destroy(&msgpack);
-        return -1;
-    }
-
-    memset(method_str, 0, sizeof(method_str));
-    strncpy(method_str, method->str_val, method->str_sz);
-
-    if(memcmp(version->str_val, "1.0", version->str_sz) == 0) {
-        rpc_version = 1;
-        req_parsers = req_parsers_1_0;
-        req_parsers_size = sizeof(req_parsers_1_0) / sizeof(*req_parsers_1_0);
-    } else if (memcmp(version->str_val, "2.0", version->str_sz) == 0) {
-        rpc_version = 2;
-        req_parsers = req_parsers_2_0;
-        req_parsers_size = sizeof(req_parsers_2_0) / sizeof(*req_parsers_2_0);
-    } else {
-        vlogE(TAG_RPC "Unsupported version field.");
-        rc = unmarshal_unknown_req(&obj, req);
-        msgpack_unpacked_destroy(&msgpack);
-        return -3;
-    }
-
-    for (i = 0; i < req_parsers_size; ++i) {
-        if (!strcmp(method_str, req_parsers[i].method)) {
-            int rc = req_parsers[i].parser(&obj, req);
-            msgpack_unpacked_destroy(&msgpack);
-            return rc;
-        }
-    }
-
-    vlogE(TAG_RPC "Not a valid method.");
-    rc = unmarshal_unknown_req(&obj, req);
-    msgpack_unpacked_destroy(&msgpack);
-    return rc < 0 ? -1 : -2;
-}
-
-
-typedef struct {
-    NewPostNotif notif;
-    PostInfo pi;
-} NewPostNotifWithPInfo;
-
-static
-int unmarshal_new_post_notif(const msgpack_object *notif, Notif **notif_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    const msgpack_object *content;
-    const msgpack_object *created_at;
-    NewPostNotifWithPInfo *tmp;
-    void *buf;
-
-    assert(notif->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(notif, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        map_iter_kvs(map_val_map("params"), {
-            chan_id = map_val_u64("channel_id");
-            post_id = map_val_u64("id");
-            content = map_val_bin("content");
-            created_at = map_val_u64("created_at");
-        });
-    });
-
-    if (!chan_id || !chan_id_is_valid(chan_id->u64_val) ||
-        !post_id || !post_id_is_valid(post_id->u64_val) ||
-        !content || !content->bin_sz || !created_at) {
-        vlogE(TAG_RPC "Invalid new_post notification.");
-        return -1;
-    }
-
-    tmp = rc_zalloc(sizeof(NewPostNotifWithPInfo) + str_reserve_spc(method) +
-                    content->bin_sz, NULL);
-    if (!tmp)
-        return -1;
-
-    buf = (char *)(tmp + 1);
-    tmp->notif.method                   = strncpy(buf, method->str_val, method->str_sz);
-    buf = (char*)buf + str_reserve_spc(method);
-    tmp->notif.params.pinfo             = &tmp->pi;
-    tmp->notif.params.pinfo->chan_id    = chan_id->u64_val;
-    tmp->notif.params.pinfo->post_id    = post_id->u64_val;
-    tmp->notif.params.pinfo->content    = memcpy(buf, content->bin_val, content->bin_sz);
-    tmp->notif.params.pinfo->con_len    = content->bin_sz;
-    tmp->notif.params.pinfo->created_at = created_at->u64_val;
-
-    *notif_unmarshal = (Notif *)&tmp->notif;
-    return 0;
-}
-
-typedef struct {
-    NewCmtNotif notif;
-    CmtInfo ci;
-} NewCmtNotifWithCInfo;
-
-static
-int unmarshal_new_cmt_notif(const msgpack_object *notif, Notif **notif_unmarshal)
-{
-    const msgpack_object *method;
-    const msgpack_object *chan_id;
-    const msgpack_object *post_id;
-    const msgpack_object *id;
-    const msgpack_object *cmt_id;
-    const msgpack_object *user_name;
-    const msgpack_object *content;
-    const msgpack_object *created_at;
-    NewCmtNotifWithCInfo *tmp;
-    void *buf;
-
-    assert(notif->type == MSGPACK_OBJECT_MAP);
-
-    map_iter_kvs(notif, {
-        (void)map_val_str("version");
-        method  = map_val_str("method");
-        map_iter_kvs(map_val_map("params"), {
-            chan_id    = map_val_u64("channel_id");
-            post_id    = map_val_u64("post_id");
-            id         = map_val_u64("id");
-            cmt_id     = map_val_u64("comment_id");
-            user_name  = map_val_str("user_name");
-            content    = map_val_bin("content");
-            created_at = map_val_u64("created_at");
+            chan_id    = map_val_u64("channel_id");
+            post_id    = map_val_u64("post_id");
+            id         = map_val_u64("id");
+            cmt_id     = map_val_u64("comment_id");
+            user_name  = map_val_str("user_name");
+            content    = map_val_bin("content");
+            created_at = map_val_u64("created_at");
         });
     });
 
@@ -3441,74 +1339,296 @@ void pack_kv_bin(msgpack_packer* pk, const char *k, const void *bin, size_t sz)
     assert(pk);
     assert(k);
 
-    if (bin && sz) {
-        pack_str(pk, k);
-        msgpack_pack_bin(pk, sz);
-        msgpack_pack_bin_body(pk, bin, sz);
+    if (bin && sz) {
+        pack_str(pk, k);
+        msgpack_pack_bin(pk, sz);
+        msgpack_pack_bin_body(pk, bin, sz);
+    }
+}
+
+static inline
+void pack_kv_bin_withzero(msgpack_packer* pk, const char *k, const void *bin, size_t sz)
+{
+    assert(pk);
+    assert(k);
+
+    if(bin == NULL)
+        sz = 0;
+
+    pack_str(pk, k);
+    msgpack_pack_bin(pk, sz);
+    msgpack_pack_bin_body(pk, bin, sz);
+}
+
+static inline
+void pack_kv_cursor(msgpack_packer* pk, const QryCursor *cur)
+{
+    uint8_t buf[QRY_CURSOR_LEN];
+
+    qry_cursor_pack(cur, buf);
+    pack_kv_bin(pk, "cursor", buf, sizeof(buf));
+}
+
+#define pack_map(pk, kvs, set_kvs)     \
+    do {                               \
+        if (kvs) {                     \
+            msgpack_pack_map(pk, kvs); \
+            set_kvs                    \
+        }                              \
+    } while (0)
+
+#define pack_arr(pk, elems, set_elems) \
+    do {                               \
+        msgpack_pack_array(pk, elems); \
+        set_elems                      \
+    } while (0)
+
+#define pack_kv_map(pk, k, map_kvs, set_kvs) \
+    do {                                     \
+        if (map_kvs) {                       \
+            pack_str(pk, k);                 \
+            pack_map(pk, map_kvs, set_kvs);  \
+        }                                    \
+    } while (0)
+
+#define pack_kv_arr(pk, k, elems, set_elems) \
+    do {                                     \
+        pack_str(pk, k);                     \
+        pack_arr(pk, elems, set_elems);      \
+    } while (0)
+
+/*
+ * Marshalled buffers come from a per-thread pool of power-of-two size
+ * classes, so the sbuffer is presized from the blobs it will carry and
+ * its memory is reused instead of being reallocated for every response.
+ * A released buffer goes back to the pool of the thread that created it.
+ */
+#define SBUF_MIN_CLASS_SZ     1024
+#define SBUF_CLASSES          14   // 1KB .. 8MB
+#define SBUF_CACHED_PER_CLASS 4
+#define SBUF_POOL_MAX_BYTES   (32 * 1024 * 1024)
+#define MINTL_ITEM_OVERHEAD   256
+
+typedef struct {
+    pthread_mutex_t lock;
+    char *bufs[SBUF_CLASSES][SBUF_CACHED_PER_CLASS];
+    int nbufs[SBUF_CLASSES];
+    size_t bytes;
+} SbufPool;
+
+typedef struct {
+    Marshalled m;
+    msgpack_sbuffer buf;
+    msgpack_packer pk;
+    SbufPool *pool;
+} MarshalledIntl;
+
+static pthread_key_t sbuf_pool_key;
+static pthread_once_t sbuf_pool_once = PTHREAD_ONCE_INIT;
+
+static inline
+size_t sbuf_class_sz(int cls)
+{
+    return (size_t)SBUF_MIN_CLASS_SZ << cls;
+}
+
+static
+int sbuf_class(size_t sz)
+{
+    int cls;
+
+    for (cls = 0; cls < SBUF_CLASSES; ++cls) {
+        if (sz <= sbuf_class_sz(cls))
+            return cls;
+    }
+
+    return -1;
+}
+
+static
+void sbuf_pool_dtor(void *obj)
+{
+    SbufPool *pool = obj;
+    int cls;
+    int i;
+
+    for (cls = 0; cls < SBUF_CLASSES; ++cls) {
+        for (i = 0; i < pool->nbufs[cls]; ++i)
+            free(pool->bufs[cls][i]);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+}
+
+static
+void sbuf_pool_release(void *pool)
+{
+    deref(pool);
+}
+
+static
+void sbuf_pool_key_create(void)
+{
+    pthread_key_create(&sbuf_pool_key, sbuf_pool_release);
+}
+
+static
+SbufPool *sbuf_pool_get(void)
+{
+    SbufPool *pool;
+
+    pthread_once(&sbuf_pool_once, sbuf_pool_key_create);
+
+    pool = pthread_getspecific(sbuf_pool_key);
+    if (pool)
+        return pool;
+
+    pool = rc_zalloc(sizeof(SbufPool), sbuf_pool_dtor);
+    if (!pool)
+        return NULL;
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_setspecific(sbuf_pool_key, pool);
+
+    return pool;
+}
+
+static
+char *sbuf_pool_take(SbufPool *pool, int cls)
+{
+    char *data = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->nbufs[cls]) {
+        data = pool->bufs[cls][--pool->nbufs[cls]];
+        pool->bytes -= sbuf_class_sz(cls);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return data;
+}
+
+static
+bool sbuf_pool_put(SbufPool *pool, char *data, size_t alloc)
+{
+    int cls = sbuf_class(alloc);
+    bool cached = false;
+
+    if (cls < 0 || sbuf_class_sz(cls) != alloc)
+        return false;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->nbufs[cls] < SBUF_CACHED_PER_CLASS &&
+        pool->bytes + alloc <= SBUF_POOL_MAX_BYTES) {
+        pool->bufs[cls][pool->nbufs[cls]++] = data;
+        pool->bytes += alloc;
+        cached = true;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return cached;
+}
+
+static
+void mintl_dtor(void *obj)
+{
+    MarshalledIntl *m = obj;
+
+    if (m->buf.data && !(m->pool && sbuf_pool_put(m->pool, m->buf.data, m->buf.alloc)))
+        free(m->buf.data);
+
+    deref(m->pool);
+}
+
+static
+MarshalledIntl *mintl_create(size_t hint)
+{
+    MarshalledIntl *m;
+    int cls;
+
+    m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    if (!m)
+        return NULL;
+
+    m->pool = ref(sbuf_pool_get());
+
+    cls = sbuf_class(hint);
+    if (cls >= 0) {
+        m->buf.alloc = sbuf_class_sz(cls);
+        m->buf.data  = m->pool ? sbuf_pool_take(m->pool, cls) : NULL;
+    } else
+        m->buf.alloc = hint;
+
+    if (!m->buf.data)
+        m->buf.data = malloc(m->buf.alloc);
+
+    if (!m->buf.data) {
+        deref(m);
+        return NULL;
     }
+
+    msgpack_packer_init(&m->pk, &m->buf, msgpack_sbuffer_write);
+
+    return m;
 }
 
 static inline
-void pack_kv_bin_withzero(msgpack_packer* pk, const char *k, const void *bin, size_t sz)
+Marshalled *mintl_finish(MarshalledIntl *m)
 {
-    assert(pk);
-    assert(k);
-
-    if(bin == NULL)
-        sz = 0;
+    m->m.data = m->buf.data;
+    m->m.sz   = m->buf.size;
 
-    pack_str(pk, k);
-    msgpack_pack_bin(pk, sz);
-    msgpack_pack_bin_body(pk, bin, sz);
+    return &m->m;
 }
 
-#define pack_map(pk, kvs, set_kvs)     \
-    do {                               \
-        if (kvs) {                     \
-            msgpack_pack_map(pk, kvs); \
-            set_kvs                    \
-        }                              \
-    } while (0)
+static
+int count_write(void *data, const char *buf, size_t len)
+{
+    (void)buf;
 
-#define pack_arr(pk, elems, set_elems) \
-    do {                               \
-        msgpack_pack_array(pk, elems); \
-        set_elems                      \
-    } while (0)
+    *(size_t *)data += len;
+    return 0;
+}
 
-#define pack_kv_map(pk, k, map_kvs, set_kvs) \
-    do {                                     \
-        if (map_kvs) {                       \
-            pack_str(pk, k);                 \
-            pack_map(pk, map_kvs, set_kvs);  \
-        }                                    \
-    } while (0)
+// sizes an item by running its packer over a writer that only counts bytes.
+#define define_item_sizer(sizer, pack_item, type)   \
+    size_t sizer(const void *item)                  \
+    {                                               \
+        msgpack_packer pk;                          \
+        size_t sz = 0;                              \
+                                                    \
+        msgpack_packer_init(&pk, &sz, count_write); \
+        pack_item(&pk, (const type *)item);         \
+        return sz;                                  \
+    }
 
-#define pack_kv_arr(pk, k, elems, set_elems) \
-    do {                                     \
-        pack_str(pk, k);                     \
-        pack_arr(pk, elems, set_elems);      \
-    } while (0)
+void rpc_chunker_init(RespChunker *ck, RespItemSizer item_sz, size_t limit)
+{
+    assert(limit > RPC_RESP_ENVELOPE_LEN);
 
-typedef struct {
-    Marshalled m;
-    msgpack_sbuffer *buf;
-} MarshalledIntl;
+    ck->item_sz = item_sz;
+    ck->limit   = limit - RPC_RESP_ENVELOPE_LEN;
+    ck->used    = 0;
+}
 
-static
-void mintl_dtor(void *obj)
+bool rpc_chunker_fits(RespChunker *ck, const void *item)
 {
-    MarshalledIntl *m = obj;
+    size_t sz = ck->item_sz(item);
+
+    if (ck->used && ck->used + sz > ck->limit) {
+        ck->used = sz;
+        return false;
+    }
 
-    if (m->buf)
-        msgpack_sbuffer_free(m->buf);
+    ck->used += sz;
+    return true;
 }
 
 Marshalled *rpc_marshal_new_post_notif(const NewPostNotif *notif)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(notif->params.pinfo->con_len + notif->params.pinfo->thu_len +
+                                     MINTL_ITEM_OVERHEAD);
+    msgpack_packer *pk = &m->pk;
 
 /*    vlogE(TAG_RPC "channel_id = %lu", notif->params.pinfo->chan_id);
     vlogE(TAG_RPC "id = %lu", notif->params.pinfo->post_id);
@@ -3541,20 +1661,14 @@ Marshalled *rpc_marshal_new_post_notif(const NewPostNotif *notif)
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
 Marshalled *rpc_marshal_post_upd_notif(const PostUpdNotif *notif)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(notif->params.pinfo->con_len + notif->params.pinfo->thu_len +
+                                     MINTL_ITEM_OVERHEAD);
+    msgpack_packer *pk = &m->pk;
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
         pack_kv_str(pk, "method", "post_update");
@@ -3580,20 +1694,14 @@ Marshalled *rpc_marshal_post_upd_notif(const PostUpdNotif *notif)
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
 Marshalled *rpc_marshal_new_cmt_notif(const NewCmtNotif *notif)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(notif->params.cinfo->con_len + notif->params.cinfo->thu_len +
+                                     MINTL_ITEM_OVERHEAD);
+    msgpack_packer *pk = &m->pk;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
@@ -3616,20 +1724,14 @@ Marshalled *rpc_marshal_new_cmt_notif(const NewCmtNotif *notif)
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
 Marshalled *rpc_marshal_cmt_upd_notif(const CmtUpdNotif *notif)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(notif->params.cinfo->con_len + notif->params.cinfo->thu_len +
+                                     MINTL_ITEM_OVERHEAD);
+    msgpack_packer *pk = &m->pk;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
@@ -3658,20 +1760,13 @@ Marshalled *rpc_marshal_cmt_upd_notif(const CmtUpdNotif *notif)
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
 Marshalled *rpc_marshal_new_like_notif(const NewLikeNotif *notif)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(0);
+    msgpack_packer *pk = &m->pk;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
@@ -3687,709 +1782,602 @@ Marshalled *rpc_marshal_new_like_notif(const NewLikeNotif *notif)
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
-}
-
-Marshalled *rpc_marshal_new_sub_notif(const NewSubNotif *notif)
-{
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_str(pk, "method", "new_subscription");
-        pack_kv_map(pk, "params", 3, {
-            pack_kv_u64(pk, "channel_id", notif->params.chan_id);
-            pack_kv_str(pk, "user_name", notif->params.uinfo->name);
-            pack_kv_str(pk, "user_did", notif->params.uinfo->did);
-        });
-    });
-
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
-}
-
-Marshalled *rpc_marshal_chan_upd_notif(const ChanUpdNotif *notif)
-{
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_str(pk, "method", "feedinfo_update");
-        pack_kv_map(pk, "params", 11, {
-            pack_kv_u64(pk, "id", notif->params.cinfo->chan_id);
-            pack_kv_str(pk, "name", notif->params.cinfo->name);
-            pack_kv_str(pk, "introduction", notif->params.cinfo->intro);
-            pack_kv_str(pk, "owner_name", notif->params.cinfo->owner->name);
-            pack_kv_str(pk, "owner_did", notif->params.cinfo->owner->did);
-            pack_kv_u64(pk, "subscribers", notif->params.cinfo->subs);
-            pack_kv_u64(pk, "last_update", notif->params.cinfo->upd_at);
-            pack_kv_bin(pk, "avatar", notif->params.cinfo->avatar, notif->params.cinfo->len);
-            pack_kv_str(pk, "tip_methods", notif->params.cinfo->tip_methods);  //2.0
-            pack_kv_str(pk, "proof", notif->params.cinfo->proof);  //2.0
-            pack_kv_u64(pk, "status", notif->params.cinfo->status);  //2.0
-        });
-    });
-
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
-}
-
-Marshalled *rpc_marshal_stats_changed_notif(const StatsChangedNotif *notif)
-{
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_str(pk, "method", "statistics_changed");
-        pack_kv_map(pk, "params", 1, {
-            pack_kv_u64(pk, "total_clients", notif->params.total_cs);
-        });
-    });
-
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
-}
-
-Marshalled *rpc_marshal_report_cmt_notif(const ReportCmtNotif *notif)
-{
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_str(pk, "method", "report_illegal_comment");
-        pack_kv_map(pk, "params", 6, {
-            pack_kv_u64(pk, "channel_id", notif->params.li->chan_id);
-            pack_kv_u64(pk, "post_id", notif->params.li->post_id);
-            pack_kv_u64(pk, "comment_id", notif->params.li->cmt_id);
-            pack_kv_str(pk, "reporter_name", notif->params.li->reporter.name);
-            pack_kv_str(pk, "reporter_did", notif->params.li->reporter.did);
-            pack_kv_str(pk, "reasons", notif->params.li->reasons);
-            pack_kv_u64(pk, "created_at", notif->params.li->created_at);
-        });
-    });
-
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
-}
-
-
-Marshalled *rpc_marshal_decl_owner_resp(const DeclOwnerResp *resp)
-{
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_map(pk, "result", resp->result.did ? 3 : 1, {
-            pack_kv_str(pk, "phase", resp->result.phase);
-            pack_kv_str(pk, "did", resp->result.did);
-            pack_kv_str(pk, "transaction_payload", resp->result.tsx_payload);
-        });
-    });
-
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
-}
-
-Marshalled *rpc_marshal_imp_did_resp(const ImpDIDResp *resp)
-{
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_map(pk, "result", 2, {
-            pack_kv_str(pk, "did", resp->result.did);
-            pack_kv_str(pk, "transaction_payload", resp->result.tsx_payload);
-        });
-    });
-
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
-}
-
-Marshalled *rpc_marshal_iss_vc_resp(const IssVCResp *resp)
-{
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_nil(pk, "result");
-    });
-
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
-}
-
-Marshalled *rpc_marshal_update_vc_resp(const UpdateVCResp *resp)
-{
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_nil(pk, "result");
-    });
-
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
-}
-
-Marshalled *rpc_marshal_signin_req_chal_resp(const SigninReqChalResp *resp)
-{
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_map(pk, "result", resp->result.vc ? 3 : 2, {
-            pack_kv_bool(pk, "credential_required", resp->result.vc_req);
-            pack_kv_str(pk, "jws", resp->result.jws);
-            pack_kv_str(pk, "credential", resp->result.vc);
-        });
-    });
-
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
-}
-
-Marshalled *rpc_marshal_signin_conf_chal_resp(const SigninConfChalResp *resp)
-{
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_map(pk, "result", 2, {
-            pack_kv_str(pk, "access_token", resp->result.tk);
-            pack_kv_u64(pk, "exp", resp->result.exp);
-        });
-    });
-
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
-}
-
-Marshalled *rpc_marshal_err_resp(const ErrResp *resp)
-{
-    return rpc_marshal_err(resp->tsx_id, resp->ec, err_strerror(resp->ec));
-}
-
-Marshalled *rpc_marshal_create_chan_resp(const CreateChanResp *resp)
-{
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_map(pk, "result", 1, {
-            pack_kv_u64(pk, "id", resp->result.id);
-        });
-    });
-
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
-Marshalled *rpc_marshal_upd_chan_resp(const UpdChanResp *resp)
+Marshalled *rpc_marshal_new_sub_notif(const NewSubNotif *notif)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(0);
+    msgpack_packer *pk = &m->pk;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_nil(pk, "result");
+        pack_kv_str(pk, "method", "new_subscription");
+        pack_kv_map(pk, "params", 3, {
+            pack_kv_u64(pk, "channel_id", notif->params.chan_id);
+            pack_kv_str(pk, "user_name", notif->params.uinfo->name);
+            pack_kv_str(pk, "user_did", notif->params.uinfo->did);
+        });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
-Marshalled *rpc_marshal_upd_user_info_resp(const UpdUserInfoResp *resp)
+Marshalled *rpc_marshal_chan_upd_notif(const ChanUpdNotif *notif)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(notif->params.cinfo->len + MINTL_ITEM_OVERHEAD);
+    msgpack_packer *pk = &m->pk;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_nil(pk, "result");
+        pack_kv_str(pk, "method", "feedinfo_update");
+        pack_kv_map(pk, "params", 11, {
+            pack_kv_u64(pk, "id", notif->params.cinfo->chan_id);
+            pack_kv_str(pk, "name", notif->params.cinfo->name);
+            pack_kv_str(pk, "introduction", notif->params.cinfo->intro);
+            pack_kv_str(pk, "owner_name", notif->params.cinfo->owner->name);
+            pack_kv_str(pk, "owner_did", notif->params.cinfo->owner->did);
+            pack_kv_u64(pk, "subscribers", notif->params.cinfo->subs);
+            pack_kv_u64(pk, "last_update", notif->params.cinfo->upd_at);
+            pack_kv_bin(pk, "avatar", notif->params.cinfo->avatar, notif->params.cinfo->len);
+            pack_kv_str(pk, "tip_methods", notif->params.cinfo->tip_methods);  //2.0
+            pack_kv_str(pk, "proof", notif->params.cinfo->proof);  //2.0
+            pack_kv_u64(pk, "status", notif->params.cinfo->status);  //2.0
+        });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
-Marshalled *rpc_marshal_pub_post_resp(const PubPostResp *resp)
+Marshalled *rpc_marshal_stats_changed_notif(const StatsChangedNotif *notif)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(0);
+    msgpack_packer *pk = &m->pk;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_map(pk, "result", 1, {
-            pack_kv_u64(pk, "id", resp->result.id);
+        pack_kv_str(pk, "method", "statistics_changed");
+        pack_kv_map(pk, "params", 1, {
+            pack_kv_u64(pk, "total_clients", notif->params.total_cs);
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
-Marshalled *rpc_marshal_declare_post_resp(const DeclarePostResp *resp)
+Marshalled *rpc_marshal_report_cmt_notif(const ReportCmtNotif *notif)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(0);
+    msgpack_packer *pk = &m->pk;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_map(pk, "result", 1, {
-            pack_kv_u64(pk, "id", resp->result.id);
+        pack_kv_str(pk, "method", "report_illegal_comment");
+        pack_kv_map(pk, "params", 6, {
+            pack_kv_u64(pk, "channel_id", notif->params.li->chan_id);
+            pack_kv_u64(pk, "post_id", notif->params.li->post_id);
+            pack_kv_u64(pk, "comment_id", notif->params.li->cmt_id);
+            pack_kv_str(pk, "reporter_name", notif->params.li->reporter.name);
+            pack_kv_str(pk, "reporter_did", notif->params.li->reporter.did);
+            pack_kv_str(pk, "reasons", notif->params.li->reasons);
+            pack_kv_u64(pk, "created_at", notif->params.li->created_at);
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
+    return mintl_finish(m);
+}
 
-    msgpack_packer_free(pk);
 
-    return &m->m;
-}
+/*
+ * Flat results are packed from the same field schemas as the requests. The
+ * response is sized up front from the msgpack header sizes, so its sbuffer
+ * is taken from the pool once and never grows. A NULL string or an empty
+ * binary is left out of the result map, as pack_kv_str() and pack_kv_bin()
+ * do; a response without a result schema carries a nil result.
+ */
+#define ID_RESULT(T, X)                                                 \
+    X(T, U64,  "id", result.id, _, REQ)
+
+#define DECL_OWNER_RESULT(T, X)                                         \
+    X(T, STR,  "phase",               result.phase,       _, REQ)       \
+    X(T, STR,  "did",                 result.did,         _, OPT)       \
+    X(T, STR,  "transaction_payload", result.tsx_payload, _, OPT)
+
+#define IMP_DID_RESULT(T, X)                                            \
+    X(T, STR,  "did",                 result.did,         _, REQ)       \
+    X(T, STR,  "transaction_payload", result.tsx_payload, _, REQ)
+
+#define SIGNIN_REQ_CHAL_RESULT(T, X)                                    \
+    X(T, BOOL, "credential_required", result.vc_req, _, REQ)            \
+    X(T, STR,  "jws",                 result.jws,    _, REQ)            \
+    X(T, STR,  "credential",          result.vc,     _, OPT)
+
+#define SIGNIN_CONF_CHAL_RESULT(T, X)                                   \
+    X(T, STR,  "access_token", result.tk,  _, REQ)                      \
+    X(T, U64,  "exp",          result.exp, _, REQ)
+
+#define GET_STATS_RESULT(T, X)                                          \
+    X(T, STR,  "did",                result.did,      _, REQ)           \
+    X(T, U64,  "connecting_clients", result.conn_cs,  _, REQ)           \
+    X(T, U64,  "total_clients",      result.total_cs, _, REQ)
+
+#define GET_SRV_VER_RESULT(T, X)                                        \
+    X(T, STR,  "version",      result.version,      _, REQ)             \
+    X(T, I64,  "version_code", result.version_code, _, REQ)             \
+    X(T, STR,  "compression",  result.compression,  _, OPT)
+
+#define SET_BINARY_RESULT(T, X)                                         \
+    X(T, STR,  "key", result.key, _, REQ)
+
+DEFINE_SCHEMA(decl_owner_result,       DeclOwnerResp,      DECL_OWNER_RESULT);
+DEFINE_SCHEMA(imp_did_result,          ImpDIDResp,         IMP_DID_RESULT);
+DEFINE_SCHEMA(signin_req_chal_result,  SigninReqChalResp,  SIGNIN_REQ_CHAL_RESULT);
+DEFINE_SCHEMA(signin_conf_chal_result, SigninConfChalResp, SIGNIN_CONF_CHAL_RESULT);
+DEFINE_SCHEMA(create_chan_result,      CreateChanResp,     ID_RESULT);
+DEFINE_SCHEMA(pub_post_result,         PubPostResp,        ID_RESULT);
+DEFINE_SCHEMA(declare_post_result,     DeclarePostResp,    ID_RESULT);
+DEFINE_SCHEMA(post_cmt_result,         PostCmtResp,        ID_RESULT);
+DEFINE_SCHEMA(get_stats_result,        GetStatsResp,       GET_STATS_RESULT);
+DEFINE_SCHEMA(get_srv_ver_result,      GetSrvVerResp,      GET_SRV_VER_RESULT);
+DEFINE_SCHEMA(set_binary_result,       SetBinaryResp,      SET_BINARY_RESULT);
 
-Marshalled *rpc_marshal_notify_post_resp(const NotifyPostResp *resp)
+static inline
+size_t str_pack_sz(size_t len)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    return len + (len < 32 ? 1 : len < 256 ? 2 : len < 65536 ? 3 : 5);
+}
 
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_nil(pk, "result");
-    });
+static inline
+size_t bin_pack_sz(size_t len)
+{
+    return len + (len < 256 ? 2 : len < 65536 ? 3 : 5);
+}
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
+static inline
+size_t u64_pack_sz(uint64_t v)
+{
+    return v < 128 ? 1 : v < 256 ? 2 : v < 65536 ? 3 : v < 4294967296ULL ? 5 : 9;
+}
 
-    msgpack_packer_free(pk);
+static inline
+size_t i64_pack_sz(int64_t v)
+{
+    if (v >= 0)
+        return u64_pack_sz(v);
 
-    return &m->m;
+    return v >= -32 ? 1 : v >= -128 ? 2 : v >= -32768 ? 3 : v >= INT32_MIN ? 5 : 9;
 }
 
-Marshalled *rpc_marshal_edit_post_resp(const EditPostResp *resp)
+static inline
+size_t map_pack_sz(size_t kvs)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_nil(pk, "result");
-    });
+    return kvs < 16 ? 1 : kvs < 65536 ? 3 : 5;
+}
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
+// packed size of the value of a field, 0 if the field is left out.
+static
+size_t field_pack_sz(const MsgField *fld, const char *base)
+{
+    const void *src = base + fld->off;
 
-    msgpack_packer_free(pk);
+    switch (fld->kind) {
+    case FLD_STR:
+        return *(char * const *)src ? str_pack_sz(strlen(*(char * const *)src)) : 0;
+    case FLD_BIN: {
+        size_t sz = *(const size_t *)(base + fld->len_off);
+        return *(void * const *)src && sz ? bin_pack_sz(sz) : 0;
+    }
+    case FLD_U64:
+        return u64_pack_sz(*(const uint64_t *)src);
+    case FLD_I64:
+        return i64_pack_sz(*(const int64_t *)src);
+    case FLD_BOOL:
+        return 1;
+    default:
+        return 0;
+    }
+}
 
-    return &m->m;
+static
+void field_pack(msgpack_packer *pk, const MsgField *fld, const char *base)
+{
+    const void *src = base + fld->off;
+
+    switch (fld->kind) {
+    case FLD_STR:
+        pack_kv_str(pk, fld->key, *(char * const *)src);
+        break;
+    case FLD_BIN:
+        pack_kv_bin(pk, fld->key, *(void * const *)src, *(const size_t *)(base + fld->len_off));
+        break;
+    case FLD_U64:
+        pack_kv_u64(pk, fld->key, *(const uint64_t *)src);
+        break;
+    case FLD_I64:
+        pack_kv_i64(pk, fld->key, *(const int64_t *)src);
+        break;
+    case FLD_BOOL:
+        pack_kv_bool(pk, fld->key, *(const bool *)src);
+        break;
+    default:
+        break;
+    }
 }
 
-Marshalled *rpc_marshal_del_post_resp(const DelPostResp *resp)
+static
+Marshalled *marshal_result(uint64_t tsx_id, const MsgSchema *schema, const void *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m;
+    msgpack_packer *pk;
+    size_t kvs = 0;
+    size_t sz;
+    size_t i;
 
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
+    sz = map_pack_sz(3) + str_pack_sz(strlen("version")) + str_pack_sz(strlen("1.0")) +
+         str_pack_sz(strlen("id")) + u64_pack_sz(tsx_id) + str_pack_sz(strlen("result"));
+
+    if (schema) {
+        for (i = 0; i < schema->nflds; i++) {
+            size_t val_sz = field_pack_sz(&schema->flds[i], resp);
+
+            if (val_sz) {
+                sz += str_pack_sz(schema->flds[i].key_sz) + val_sz;
+                kvs++;
+            }
+        }
+        sz += map_pack_sz(kvs);
+    } else
+        sz += 1;
+
+    m = mintl_create(sz);
+    if (!m)
+        return NULL;
+
+    pk = &m->pk;
+    msgpack_pack_map(pk, 3);
+    pack_kv_str(pk, "version", "1.0");
+    pack_kv_u64(pk, "id", tsx_id);
+    if (schema) {
+        pack_str(pk, "result");
+        msgpack_pack_map(pk, kvs);
+        for (i = 0; i < schema->nflds; i++)
+            field_pack(pk, &schema->flds[i], resp);
+    } else
         pack_kv_nil(pk, "result");
-    });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
+    assert(m->buf.size == sz);
 
-    msgpack_packer_free(pk);
+    return mintl_finish(m);
+}
 
-    return &m->m;
+Marshalled *rpc_marshal_decl_owner_resp(const DeclOwnerResp *resp)
+{
+    return marshal_result(resp->tsx_id, &decl_owner_result, resp);
 }
 
-Marshalled *rpc_marshal_post_cmt_resp(const PostCmtResp *resp)
+Marshalled *rpc_marshal_imp_did_resp(const ImpDIDResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    return marshal_result(resp->tsx_id, &imp_did_result, resp);
+}
 
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_map(pk, "result", 1, {
-            pack_kv_u64(pk, "id", resp->result.id);
-        });
-    });
+Marshalled *rpc_marshal_iss_vc_resp(const IssVCResp *resp)
+{
+    return marshal_result(resp->tsx_id, NULL, resp);
+}
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
+Marshalled *rpc_marshal_update_vc_resp(const UpdateVCResp *resp)
+{
+    return marshal_result(resp->tsx_id, NULL, resp);
+}
 
-    msgpack_packer_free(pk);
+Marshalled *rpc_marshal_signin_req_chal_resp(const SigninReqChalResp *resp)
+{
+    return marshal_result(resp->tsx_id, &signin_req_chal_result, resp);
+}
 
-    return &m->m;
+Marshalled *rpc_marshal_signin_conf_chal_resp(const SigninConfChalResp *resp)
+{
+    return marshal_result(resp->tsx_id, &signin_conf_chal_result, resp);
 }
 
-Marshalled *rpc_marshal_edit_cmt_resp(const EditCmtResp *resp)
+Marshalled *rpc_marshal_err_resp(const ErrResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    return rpc_marshal_err(resp->tsx_id, resp->ec, err_strerror(resp->ec));
+}
 
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_nil(pk, "result");
-    });
+Marshalled *rpc_marshal_create_chan_resp(const CreateChanResp *resp)
+{
+    return marshal_result(resp->tsx_id, &create_chan_result, resp);
+}
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
+Marshalled *rpc_marshal_upd_chan_resp(const UpdChanResp *resp)
+{
+    return marshal_result(resp->tsx_id, NULL, resp);
+}
 
-    msgpack_packer_free(pk);
+Marshalled *rpc_marshal_upd_user_info_resp(const UpdUserInfoResp *resp)
+{
+    return marshal_result(resp->tsx_id, NULL, resp);
+}
 
-    return &m->m;
+Marshalled *rpc_marshal_pub_post_resp(const PubPostResp *resp)
+{
+    return marshal_result(resp->tsx_id, &pub_post_result, resp);
 }
 
-Marshalled *rpc_marshal_del_cmt_resp(const DelCmtResp *resp)
+Marshalled *rpc_marshal_declare_post_resp(const DeclarePostResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    return marshal_result(resp->tsx_id, &declare_post_result, resp);
+}
 
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_nil(pk, "result");
-    });
+Marshalled *rpc_marshal_notify_post_resp(const NotifyPostResp *resp)
+{
+    return marshal_result(resp->tsx_id, NULL, resp);
+}
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
+Marshalled *rpc_marshal_edit_post_resp(const EditPostResp *resp)
+{
+    return marshal_result(resp->tsx_id, NULL, resp);
+}
 
-    msgpack_packer_free(pk);
+Marshalled *rpc_marshal_del_post_resp(const DelPostResp *resp)
+{
+    return marshal_result(resp->tsx_id, NULL, resp);
+}
 
-    return &m->m;
+Marshalled *rpc_marshal_post_cmt_resp(const PostCmtResp *resp)
+{
+    return marshal_result(resp->tsx_id, &post_cmt_result, resp);
 }
 
-Marshalled *rpc_marshal_block_cmt_resp(const BlockCmtResp *resp)
+Marshalled *rpc_marshal_edit_cmt_resp(const EditCmtResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    return marshal_result(resp->tsx_id, NULL, resp);
+}
 
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_nil(pk, "result");
-    });
+Marshalled *rpc_marshal_del_cmt_resp(const DelCmtResp *resp)
+{
+    return marshal_result(resp->tsx_id, NULL, resp);
+}
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
+Marshalled *rpc_marshal_block_cmt_resp(const BlockCmtResp *resp)
+{
+    return marshal_result(resp->tsx_id, NULL, resp);
+}
 
-    msgpack_packer_free(pk);
+Marshalled *rpc_marshal_unblock_cmt_resp(const UnblockCmtResp *resp)
+{
+    return marshal_result(resp->tsx_id, NULL, resp);
+}
 
-    return &m->m;
+Marshalled *rpc_marshal_post_like_resp(const PostLikeResp *resp)
+{
+    return marshal_result(resp->tsx_id, NULL, resp);
 }
 
-Marshalled *rpc_marshal_unblock_cmt_resp(const UnblockCmtResp *resp)
+Marshalled *rpc_marshal_post_unlike_resp(const PostUnlikeResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    return marshal_result(resp->tsx_id, NULL, resp);
+}
 
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_nil(pk, "result");
+static
+void pack_my_chan(msgpack_packer *pk, const ChanInfo *cinfo)
+{
+    pack_map(pk, 5, {
+        pack_kv_u64(pk, "id", cinfo->chan_id);
+        pack_kv_str(pk, "name", cinfo->name);
+        pack_kv_str(pk, "introduction", cinfo->intro);
+        pack_kv_u64(pk, "subscribers", cinfo->subs);
+        pack_kv_bin(pk, "avatar", cinfo->avatar, cinfo->len);
     });
+}
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
+define_item_sizer(rpc_get_my_chans_item_sz, pack_my_chan, ChanInfo)
 
-    msgpack_packer_free(pk);
+Marshalled *rpc_marshal_get_my_chans_resp(const GetMyChansResp *resp)
+{
+    ChanInfo **cinfo;
+    MarshalledIntl *m;
+    msgpack_packer *pk;
+    size_t hint = 0;
 
-    return &m->m;
-}
+    cvector_foreach(resp->result.cinfos, cinfo)
+        hint += (*cinfo)->len + MINTL_ITEM_OVERHEAD;
 
-Marshalled *rpc_marshal_post_like_resp(const PostLikeResp *resp)
-{
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    m = mintl_create(hint);
+    pk = &m->pk;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
         pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_nil(pk, "result");
+        pack_kv_map(pk, "result", 2, {
+            pack_kv_bool(pk, "is_last", resp->result.is_last);
+            pack_kv_arr(pk, "channels", cvector_size(resp->result.cinfos), {
+                cvector_foreach(resp->result.cinfos, cinfo) {
+                    pack_my_chan(pk, *cinfo);
+                }
+            });
+        });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
-Marshalled *rpc_marshal_post_unlike_resp(const PostUnlikeResp *resp)
+Marshalled *rpc_marshal_get_my_chans_meta_resp(const GetMyChansMetaResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(0);
+    msgpack_packer *pk = &m->pk;
+    ChanInfo **cinfo;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
         pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_nil(pk, "result");
+        pack_kv_arr(pk, "result", cvector_size(resp->result.cinfos), {
+            cvector_foreach(resp->result.cinfos, cinfo) {
+                pack_map(pk, 2, {
+                    pack_kv_u64(pk, "id", (*cinfo)->chan_id);
+                    pack_kv_u64(pk, "subscribers", (*cinfo)->subs);
+                });
+            }
+        });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
-Marshalled *rpc_marshal_get_my_chans_resp(const GetMyChansResp *resp)
+/*
+ * Number of the optional fields in proj an item loaded with the given
+ * projection carries.
+ */
+static inline
+size_t proj_cnt(uint64_t fields, uint64_t proj)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-    ChanInfo **cinfo;
+    return __builtin_popcountll(fields ? fields & proj : proj);
+}
 
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_map(pk, "result", 2, {
-            pack_kv_bool(pk, "is_last", resp->result.is_last);
-            pack_kv_arr(pk, "channels", cvector_size(resp->result.cinfos), {
-                cvector_foreach(resp->result.cinfos, cinfo) {
-                    pack_map(pk, 5, {
-                        pack_kv_u64(pk, "id", (*cinfo)->chan_id);
-                        pack_kv_str(pk, "name", (*cinfo)->name);
-                        pack_kv_str(pk, "introduction", (*cinfo)->intro);
-                        pack_kv_u64(pk, "subscribers", (*cinfo)->subs);
-                        pack_kv_bin(pk, "avatar", (*cinfo)->avatar, (*cinfo)->len);
-                    });
-                }
-            });
+static
+void pack_chan(msgpack_packer *pk, const ChanInfo *cinfo)
+{
+    uint64_t f = cinfo->fields;
+
+    if (f & PROJ_NOT_MODIFIED) {
+        pack_map(pk, 5, {
+            pack_kv_u64(pk, "id", cinfo->chan_id);
+            pack_kv_u64(pk, "subscribers", cinfo->subs);
+            pack_kv_u64(pk, "last_update", cinfo->upd_at);
+            pack_kv_u64(pk, "status", cinfo->status);
+            pack_kv_bool(pk, "not_modified", true);
         });
-    });
+        return;
+    }
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
+    pack_map(pk, 7 + chan_has_tag(cinfo) +
+                 proj_cnt(f, PROJ_INTRO | PROJ_AVATAR | PROJ_TIP_METHODS | PROJ_PROOF), {
+        pack_kv_u64(pk, "id", cinfo->chan_id);
+        pack_kv_str(pk, "name", cinfo->name);
+        if (proj_has(f, PROJ_INTRO))
+            pack_kv_str(pk, "introduction", cinfo->intro);
+        pack_kv_str(pk, "owner_name", cinfo->owner->name);
+        pack_kv_str(pk, "owner_did", cinfo->owner->did);
+        pack_kv_u64(pk, "subscribers", cinfo->subs);
+        pack_kv_u64(pk, "last_update", cinfo->upd_at);
+        if (proj_has(f, PROJ_AVATAR))
+            pack_kv_bin(pk, "avatar", cinfo->avatar, cinfo->len);
+        if (proj_has(f, PROJ_TIP_METHODS))
+            pack_kv_str(pk, "tip_methods", cinfo->tip_methods);  //2.0
+        if (proj_has(f, PROJ_PROOF))
+            pack_kv_str(pk, "proof", cinfo->proof);  //2.0
+        pack_kv_u64(pk, "status", cinfo->status);  //2.0
+        if (chan_has_tag(cinfo))
+            pack_kv_u64(pk, "tag", chan_tag(cinfo));
+    });
+}
 
-    msgpack_packer_free(pk);
+define_item_sizer(rpc_get_chans_item_sz, pack_chan, ChanInfo)
 
-    return &m->m;
+size_t rpc_packed_item_sz(const void *item)
+{
+    return ((const Marshalled *)item)->sz;
 }
 
-Marshalled *rpc_marshal_get_my_chans_meta_resp(const GetMyChansMetaResp *resp)
+static
+Marshalled *pack_item(void (*pack)(msgpack_packer *, const void *), const void *obj)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-    ChanInfo **cinfo;
+    Marshalled *item;
+    msgpack_sbuffer buf;
+    msgpack_packer pk;
 
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_arr(pk, "result", cvector_size(resp->result.cinfos), {
-            cvector_foreach(resp->result.cinfos, cinfo) {
-                pack_map(pk, 2, {
-                    pack_kv_u64(pk, "id", (*cinfo)->chan_id);
-                    pack_kv_u64(pk, "subscribers", (*cinfo)->subs);
-                });
-            }
-        });
-    });
+    msgpack_sbuffer_init(&buf);
+    msgpack_packer_init(&pk, &buf, msgpack_sbuffer_write);
+    pack(&pk, obj);
+
+    item = rc_zalloc(sizeof(Marshalled) + buf.size, NULL);
+    if (item) {
+        item->data = item + 1;
+        item->sz   = buf.size;
+        memcpy(item->data, buf.data, buf.size);
+    }
+    msgpack_sbuffer_destroy(&buf);
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
+    return item;
+}
 
-    msgpack_packer_free(pk);
+static inline
+void pack_raw(msgpack_packer *pk, const Marshalled *item)
+{
+    pk->callback(pk->data, item->data, item->sz);
+}
 
-    return &m->m;
+Marshalled *rpc_pack_chan(const ChanInfo *cinfo)
+{
+    return pack_item((void (*)(msgpack_packer *, const void *))pack_chan, cinfo);
 }
 
 Marshalled *rpc_marshal_get_chans_resp(const GetChansResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    Marshalled **item;
     ChanInfo **cinfo;
+    MarshalledIntl *m;
+    msgpack_packer *pk;
+    size_t hint = 0;
+
+    cvector_foreach(resp->result.items, item)
+        hint += (*item)->sz;
+    cvector_foreach(resp->result.cinfos, cinfo)
+        hint += (*cinfo)->len + MINTL_ITEM_OVERHEAD;
+
+    m = mintl_create(hint + MINTL_ITEM_OVERHEAD);
+    pk = &m->pk;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
         pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_map(pk, "result", 2, {
+        pack_kv_map(pk, "result", 2 + !!resp->result.cursor.by, {
             pack_kv_bool(pk, "is_last", resp->result.is_last);
-            pack_kv_arr(pk, "channels", cvector_size(resp->result.cinfos), {
-                cvector_foreach(resp->result.cinfos, cinfo) {
-                    pack_map(pk, 11, {
-                        pack_kv_u64(pk, "id", (*cinfo)->chan_id);
-                        pack_kv_str(pk, "name", (*cinfo)->name);
-                        pack_kv_str(pk, "introduction", (*cinfo)->intro);
-                        pack_kv_str(pk, "owner_name", (*cinfo)->owner->name);
-                        pack_kv_str(pk, "owner_did", (*cinfo)->owner->did);
-                        pack_kv_u64(pk, "subscribers", (*cinfo)->subs);
-                        pack_kv_u64(pk, "last_update", (*cinfo)->upd_at);
-                        pack_kv_bin(pk, "avatar", (*cinfo)->avatar, (*cinfo)->len);
-                        pack_kv_str(pk, "tip_methods", (*cinfo)->tip_methods);  //2.0
-                        pack_kv_str(pk, "proof", (*cinfo)->proof);  //2.0
-                        pack_kv_u64(pk, "status", (*cinfo)->status);  //2.0
-                    });
-                }
-            });
+            if (resp->result.cursor.by)
+                pack_kv_cursor(pk, &resp->result.cursor);
+            if (resp->result.items) {
+                pack_kv_arr(pk, "channels", cvector_size(resp->result.items), {
+                    cvector_foreach(resp->result.items, item) {
+                        pack_raw(pk, *item);
+                    }
+                });
+            } else {
+                pack_kv_arr(pk, "channels", cvector_size(resp->result.cinfos), {
+                    cvector_foreach(resp->result.cinfos, cinfo) {
+                        pack_chan(pk, *cinfo);
+                    }
+                });
+            }
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
 Marshalled *rpc_marshal_get_chan_dtl_resp(const GetChanDtlResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(resp->result.cinfo->len + MINTL_ITEM_OVERHEAD);
+    msgpack_packer *pk = &m->pk;
+
+    if (resp->result.not_modified) {
+        pack_map(pk, 3, {
+            pack_kv_str(pk, "version", "1.0");
+            pack_kv_u64(pk, "id", resp->tsx_id);
+            pack_kv_map(pk, "result", 4, {
+                pack_kv_u64(pk, "id", resp->result.cinfo->chan_id);
+                pack_kv_u64(pk, "subscribers", resp->result.cinfo->subs);
+                pack_kv_u64(pk, "last_update", resp->result.cinfo->upd_at);
+                pack_kv_bool(pk, "not_modified", true);
+            });
+        });
+        return mintl_finish(m);
+    }
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
         pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_map(pk, "result", 8, {
+        pack_kv_map(pk, "result", 9, {
             pack_kv_u64(pk, "id", resp->result.cinfo->chan_id);
             pack_kv_str(pk, "name", resp->result.cinfo->name);
             pack_kv_str(pk, "introduction", resp->result.cinfo->intro);
@@ -4398,24 +2386,44 @@ Marshalled *rpc_marshal_get_chan_dtl_resp(const GetChanDtlResp *resp)
             pack_kv_u64(pk, "subscribers", resp->result.cinfo->subs);
             pack_kv_u64(pk, "last_update", resp->result.cinfo->upd_at);
             pack_kv_bin(pk, "avatar", resp->result.cinfo->avatar, resp->result.cinfo->len);
+            pack_kv_u64(pk, "tag", chan_tag(resp->result.cinfo));
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
+    return mintl_finish(m);
+}
 
-    return &m->m;
+static
+void pack_sub_chan(msgpack_packer *pk, const ChanInfo *cinfo)
+{
+    pack_map(pk, 10, {
+        pack_kv_u64(pk, "id", cinfo->chan_id);
+        pack_kv_str(pk, "name", cinfo->name);
+        pack_kv_str(pk, "introduction", cinfo->intro);
+        pack_kv_str(pk, "owner_name", cinfo->owner->name);
+        pack_kv_str(pk, "owner_did", cinfo->owner->did);
+        pack_kv_u64(pk, "subscribers", cinfo->subs);
+        pack_kv_u64(pk, "last_update", cinfo->upd_at);
+        pack_kv_bin(pk, "avatar", cinfo->avatar, cinfo->len);
+        pack_kv_str(pk, "proof", cinfo->proof);
+        pack_kv_u64(pk, "created_at", cinfo->created_at);
+    });
 }
 
+define_item_sizer(rpc_get_sub_chans_item_sz, pack_sub_chan, ChanInfo)
+
 Marshalled *rpc_marshal_get_sub_chans_resp(const GetSubChansResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
     ChanInfo **cinfo;
+    MarshalledIntl *m;
+    msgpack_packer *pk;
+    size_t hint = 0;
+
+    cvector_foreach(resp->result.cinfos, cinfo)
+        hint += (*cinfo)->len + MINTL_ITEM_OVERHEAD;
+
+    m = mintl_create(hint);
+    pk = &m->pk;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
@@ -4424,81 +2432,133 @@ Marshalled *rpc_marshal_get_sub_chans_resp(const GetSubChansResp *resp)
             pack_kv_bool(pk, "is_last", resp->result.is_last);
             pack_kv_arr(pk, "channels", cvector_size(resp->result.cinfos), {
                 cvector_foreach(resp->result.cinfos, cinfo) {
-                    pack_map(pk, 10, {
-                        pack_kv_u64(pk, "id", (*cinfo)->chan_id);
-                        pack_kv_str(pk, "name", (*cinfo)->name);
-                        pack_kv_str(pk, "introduction", (*cinfo)->intro);
-                        pack_kv_str(pk, "owner_name", (*cinfo)->owner->name);
-                        pack_kv_str(pk, "owner_did", (*cinfo)->owner->did);
-                        pack_kv_u64(pk, "subscribers", (*cinfo)->subs);
-                        pack_kv_u64(pk, "last_update", (*cinfo)->upd_at);
-                        pack_kv_bin(pk, "avatar", (*cinfo)->avatar, (*cinfo)->len);
-                        pack_kv_str(pk, "proof", (*cinfo)->proof);
-                        pack_kv_u64(pk, "created_at", (*cinfo)->created_at);
-                    });
+                    pack_sub_chan(pk, *cinfo);
                 }
             });
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
+    return mintl_finish(m);
+}
 
-    msgpack_packer_free(pk);
+static
+void pack_post(msgpack_packer *pk, const PostInfo *pinfo)
+{
+    uint64_t f = pinfo->fields;
+
+    if (f & PROJ_NOT_MODIFIED) {
+        pack_map(pk, 8, {
+            pack_kv_u64(pk, "channel_id", pinfo->chan_id);
+            pack_kv_u64(pk, "id", pinfo->post_id);
+            pack_kv_u64(pk, "status", pinfo->stat);
+            pack_kv_u64(pk, "comments", pinfo->cmts);
+            pack_kv_u64(pk, "likes", pinfo->likes);
+            pack_kv_u64(pk, "created_at", pinfo->created_at);
+            pack_kv_u64(pk, "updated_at", pinfo->upd_at);
+            pack_kv_bool(pk, "not_modified", true);
+        });
+        return;
+    }
+
+    pack_map(pk, 7 + post_has_tag(pinfo) +
+                 proj_cnt(f, PROJ_CONTENT | PROJ_THUMBNAILS | PROJ_HASH_ID |
+                             PROJ_PROOF | PROJ_ORIGIN_URL), {
+        pack_kv_u64(pk, "channel_id", pinfo->chan_id);
+        pack_kv_u64(pk, "id", pinfo->post_id);
+        pack_kv_u64(pk, "status", pinfo->stat);
+        if (proj_has(f, PROJ_CONTENT))
+            pinfo->stat == POST_DELETED ? pack_kv_nil(pk, "content") :
+                pack_kv_bin(pk, "content", pinfo->content, pinfo->con_len);
+        pack_kv_u64(pk, "comments", pinfo->cmts);
+        pack_kv_u64(pk, "likes", pinfo->likes);
+        pack_kv_u64(pk, "created_at", pinfo->created_at);
+        pack_kv_u64(pk, "updated_at", pinfo->upd_at);
+        if (proj_has(f, PROJ_THUMBNAILS))
+            pinfo->stat == POST_DELETED ? pack_kv_nil(pk, "thumbnails") :  //2.0
+                pack_kv_bin(pk, "thumbnails", pinfo->thumbnails, pinfo->thu_len);
+        if (proj_has(f, PROJ_HASH_ID))
+            pack_kv_str(pk, "hash_id", pinfo->hash_id);  //2.0
+        if (proj_has(f, PROJ_PROOF))
+            pack_kv_str(pk, "proof", pinfo->proof);  //2.0
+        if (proj_has(f, PROJ_ORIGIN_URL))
+            pack_kv_str(pk, "origin_post_url", pinfo->origin_post_url);  //2.0
+        if (post_has_tag(pinfo))
+            pack_kv_u64(pk, "tag", post_tag(pinfo));
+    });
+}
 
-    return &m->m;
+/*
+ * Posts of get_posts and get_timeline are packed once and spliced from
+ * postcache afterwards, the chunker sizing a post fills the cache for the
+ * marshaller that follows.
+ */
+static
+Marshalled *post_item(const PostInfo *pinfo)
+{
+    Marshalled *item;
+
+    item = postcache_get(pinfo);
+    if (item)
+        return item;
+
+    item = pack_item((void (*)(msgpack_packer *, const void *))pack_post, pinfo);
+    if (item)
+        postcache_put(pinfo, item);
+
+    return item;
+}
+
+static
+void pack_cached_post(msgpack_packer *pk, const PostInfo *pinfo)
+{
+    Marshalled *item = post_item(pinfo);
+
+    if (!item) {
+        pack_post(pk, pinfo);
+        return;
+    }
+
+    pack_raw(pk, item);
+    deref(item);
 }
 
+define_item_sizer(rpc_get_posts_item_sz, pack_cached_post, PostInfo)
+
 Marshalled *rpc_marshal_get_posts_resp(const GetPostsResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
     PostInfo **pinfo;
+    MarshalledIntl *m;
+    msgpack_packer *pk;
+    size_t hint = 0;
+
+    cvector_foreach(resp->result.pinfos, pinfo)
+        hint += (*pinfo)->con_len + (*pinfo)->thu_len + MINTL_ITEM_OVERHEAD;
+
+    m = mintl_create(hint);
+    pk = &m->pk;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
         pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_map(pk, "result", 2, {
+        pack_kv_map(pk, "result", 2 + !!resp->result.cursor.by, {
             pack_kv_bool(pk, "is_last", resp->result.is_last);
+            if (resp->result.cursor.by)
+                pack_kv_cursor(pk, &resp->result.cursor);
             pack_kv_arr(pk, "posts", cvector_size(resp->result.pinfos), {
                 cvector_foreach(resp->result.pinfos, pinfo) {
-                    pack_map(pk, 12, {
-                        pack_kv_u64(pk, "channel_id", (*pinfo)->chan_id);
-                        pack_kv_u64(pk, "id", (*pinfo)->post_id);
-                        pack_kv_u64(pk, "status", (*pinfo)->stat);
-                        (*pinfo)->stat == POST_DELETED ? pack_kv_nil(pk, "content") :
-                            pack_kv_bin(pk, "content", (*pinfo)->content, (*pinfo)->con_len);
-                        pack_kv_u64(pk, "comments", (*pinfo)->cmts);
-                        pack_kv_u64(pk, "likes", (*pinfo)->likes);
-                        pack_kv_u64(pk, "created_at", (*pinfo)->created_at);
-                        pack_kv_u64(pk, "updated_at", (*pinfo)->upd_at);
-                        (*pinfo)->stat == POST_DELETED ? pack_kv_nil(pk, "thumbnails") :  //2.0
-                            pack_kv_bin(pk, "thumbnails", (*pinfo)->thumbnails, (*pinfo)->thu_len);
-                        pack_kv_str(pk, "hash_id", (*pinfo)->hash_id);  //2.0
-                        pack_kv_str(pk, "proof", (*pinfo)->proof);  //2.0
-                        pack_kv_str(pk, "origin_post_url", (*pinfo)->origin_post_url);  //2.0
-                    });
+                    pack_cached_post(pk, *pinfo);
                 }
             });
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
 Marshalled *rpc_marshal_get_posts_lac_resp(const GetPostsLACResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(0);
+    msgpack_packer *pk = &m->pk;
     PostInfo **pinfo;
 
     pack_map(pk, 3, {
@@ -4518,56 +2578,75 @@ Marshalled *rpc_marshal_get_posts_lac_resp(const GetPostsLACResp *resp)
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
+    return mintl_finish(m);
+}
 
-    return &m->m;
+static
+void pack_liked_post(msgpack_packer *pk, const PostInfo *pinfo)
+{
+    pack_map(pk, 6, {
+        pack_kv_u64(pk, "channel_id", pinfo->chan_id);
+        pack_kv_u64(pk, "id", pinfo->post_id);
+        pack_kv_bin(pk, "content", pinfo->content, pinfo->con_len);
+        pack_kv_u64(pk, "comments", pinfo->cmts);
+        pack_kv_u64(pk, "likes", pinfo->likes);
+        pack_kv_u64(pk, "created_at", pinfo->created_at);
+    });
 }
 
+define_item_sizer(rpc_get_liked_posts_item_sz, pack_liked_post, PostInfo)
+
 Marshalled *rpc_marshal_get_liked_posts_resp(const GetLikedPostsResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
     PostInfo **pinfo;
+    MarshalledIntl *m;
+    msgpack_packer *pk;
+    size_t hint = 0;
+
+    cvector_foreach(resp->result.pinfos, pinfo)
+        hint += (*pinfo)->con_len + MINTL_ITEM_OVERHEAD;
+
+    m = mintl_create(hint);
+    pk = &m->pk;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
         pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_map(pk, "result", 2, {
+        pack_kv_map(pk, "result", 2 + !!resp->result.cursor.by, {
             pack_kv_bool(pk, "is_last", resp->result.is_last);
+            if (resp->result.cursor.by)
+                pack_kv_cursor(pk, &resp->result.cursor);
             pack_kv_arr(pk, "posts", cvector_size(resp->result.pinfos), {
                 cvector_foreach(resp->result.pinfos, pinfo) {
-                    pack_map(pk, 6, {
-                        pack_kv_u64(pk, "channel_id", (*pinfo)->chan_id);
-                        pack_kv_u64(pk, "id", (*pinfo)->post_id);
-                        pack_kv_bin(pk, "content", (*pinfo)->content, (*pinfo)->con_len);
-                        pack_kv_u64(pk, "comments", (*pinfo)->cmts);
-                        pack_kv_u64(pk, "likes", (*pinfo)->likes);
-                        pack_kv_u64(pk, "created_at", (*pinfo)->created_at);
-                    });
+                    pack_liked_post(pk, *pinfo);
                 }
             });
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
+    return mintl_finish(m);
+}
 
-    return &m->m;
+static
+void pack_like(msgpack_packer *pk, const LikeInfo *linfo)
+{
+    pack_map(pk, 7, {
+        pack_kv_u64(pk, "channel_id", linfo->chan_id);
+        pack_kv_u64(pk, "post_id", linfo->post_id);
+        pack_kv_u64(pk, "comment_id", linfo->cmt_id);
+        pack_kv_str(pk, "user_did", linfo->user.did);
+        pack_kv_str(pk, "user_name", linfo->user.name);
+        pack_kv_u64(pk, "created_at", linfo->created_at);
+        pack_kv_str(pk, "proof", linfo->proof);
+    });
 }
 
+define_item_sizer(rpc_get_liked_data_item_sz, pack_like, LikeInfo)
+
 Marshalled *rpc_marshal_get_liked_data_resp(const GetLikedDataResp *resp)  //2.0
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(0);
+    msgpack_packer *pk = &m->pk;
     LikeInfo **linfo;
 
     pack_map(pk, 3, {
@@ -4577,80 +2656,81 @@ Marshalled *rpc_marshal_get_liked_data_resp(const GetLikedDataResp *resp)  //2.0
             pack_kv_bool(pk, "is_last", resp->result.is_last);
             pack_kv_arr(pk, "liked", cvector_size(resp->result.linfos), {
                 cvector_foreach(resp->result.linfos, linfo) {
-                    pack_map(pk, 7, {
-                        pack_kv_u64(pk, "channel_id", (*linfo)->chan_id);
-                        pack_kv_u64(pk, "post_id", (*linfo)->post_id);
-                        pack_kv_u64(pk, "comment_id", (*linfo)->cmt_id);
-                        pack_kv_str(pk, "user_did", (*linfo)->user.did);
-                        pack_kv_str(pk, "user_name", (*linfo)->user.name);
-                        pack_kv_u64(pk, "created_at", (*linfo)->created_at);
-                        pack_kv_str(pk, "proof", (*linfo)->proof);
-                    });
+                    pack_like(pk, *linfo);
                 }
             });
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
+static
+void pack_cmt(msgpack_packer *pk, const CmtInfo *cinfo)
+{
+    uint64_t f = cinfo->fields;
+
+    pack_map(pk, 10 + proj_cnt(f, PROJ_CONTENT | PROJ_THUMBNAILS | PROJ_HASH_ID | PROJ_PROOF), {
+        pack_kv_u64(pk, "channel_id", cinfo->chan_id);
+        pack_kv_u64(pk, "post_id", cinfo->post_id);
+        pack_kv_u64(pk, "id", cinfo->cmt_id);
+        pack_kv_u64(pk, "status", cinfo->stat);
+        pack_kv_u64(pk, "comment_id", cinfo->reply_to_cmt);
+        pack_kv_str(pk, "user_did", cinfo->user.did);
+        pack_kv_str(pk, "user_name", cinfo->user.name);
+        if (proj_has(f, PROJ_CONTENT))
+            cinfo->stat == CMT_AVAILABLE ? pack_kv_bin(pk, "content", cinfo->content, cinfo->con_len) :
+                                              pack_kv_nil(pk, "content");
+        pack_kv_u64(pk, "likes", cinfo->likes);
+        pack_kv_u64(pk, "created_at", cinfo->created_at);
+        pack_kv_u64(pk, "updated_at", cinfo->upd_at);
+        if (proj_has(f, PROJ_THUMBNAILS))
+            cinfo->stat == CMT_AVAILABLE ? pack_kv_bin(pk, "thumbnails", cinfo->thumbnails, cinfo->thu_len) :
+                                              pack_kv_nil(pk, "thumbnails");  //2.0
+        if (proj_has(f, PROJ_HASH_ID))
+            pack_kv_str(pk, "hash_id", cinfo->hash_id);  //2.0
+        if (proj_has(f, PROJ_PROOF))
+            pack_kv_str(pk, "proof", cinfo->proof);  //2.0
+    });
+}
+
+define_item_sizer(rpc_get_cmts_item_sz, pack_cmt, CmtInfo)
+
 Marshalled *rpc_marshal_get_cmts_resp(const GetCmtsResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
     CmtInfo **cinfo;
+    MarshalledIntl *m;
+    msgpack_packer *pk;
+    size_t hint = 0;
+
+    cvector_foreach(resp->result.cinfos, cinfo)
+        hint += (*cinfo)->con_len + (*cinfo)->thu_len + MINTL_ITEM_OVERHEAD;
+
+    m = mintl_create(hint);
+    pk = &m->pk;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
         pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_map(pk, "result", 2, {
+        pack_kv_map(pk, "result", 2 + !!resp->result.cursor.by, {
             pack_kv_bool(pk, "is_last", resp->result.is_last);
+            if (resp->result.cursor.by)
+                pack_kv_cursor(pk, &resp->result.cursor);
             pack_kv_arr(pk, "comments", cvector_size(resp->result.cinfos), {
                 cvector_foreach(resp->result.cinfos, cinfo) {
-                    pack_map(pk, 14, {
-                        pack_kv_u64(pk, "channel_id", (*cinfo)->chan_id);
-                        pack_kv_u64(pk, "post_id", (*cinfo)->post_id);
-                        pack_kv_u64(pk, "id", (*cinfo)->cmt_id);
-                        pack_kv_u64(pk, "status", (*cinfo)->stat);
-                        pack_kv_u64(pk, "comment_id", (*cinfo)->reply_to_cmt);
-                        pack_kv_str(pk, "user_did", (*cinfo)->user.did);
-                        pack_kv_str(pk, "user_name", (*cinfo)->user.name);
-                        (*cinfo)->stat == CMT_AVAILABLE ? pack_kv_bin(pk, "content", (*cinfo)->content, (*cinfo)->con_len) :
-                                                          pack_kv_nil(pk, "content");
-                        pack_kv_u64(pk, "likes", (*cinfo)->likes);
-                        pack_kv_u64(pk, "created_at", (*cinfo)->created_at);
-                        pack_kv_u64(pk, "updated_at", (*cinfo)->upd_at);
-                        (*cinfo)->stat == CMT_AVAILABLE ? pack_kv_bin(pk, "thumbnails", (*cinfo)->thumbnails, (*cinfo)->thu_len) :
-                                                          pack_kv_nil(pk, "thumbnails");  //2.0
-                        pack_kv_str(pk, "hash_id", (*cinfo)->hash_id);  //2.0
-                        pack_kv_str(pk, "proof", (*cinfo)->proof);  //2.0
-                    });
+                    pack_cmt(pk, *cinfo);
                 }
             });
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
 Marshalled *rpc_marshal_get_cmts_likes_resp(const GetCmtsLikesResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(0);
+    msgpack_packer *pk = &m->pk;
     CmtInfo **cinfo;
 
     pack_map(pk, 3, {
@@ -4670,45 +2750,149 @@ Marshalled *rpc_marshal_get_cmts_likes_resp(const GetCmtsLikesResp *resp)
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
+    return mintl_finish(m);
+}
 
-    return &m->m;
+static
+void pack_change(msgpack_packer *pk, const ChangeInfo *chinfo)
+{
+    pack_map(pk, 2, {
+        pack_kv_u64(pk, "seq", chinfo->seq);
+        if (chinfo->pinfo) {
+            pack_str(pk, "post");
+            pack_post(pk, chinfo->pinfo);
+        } else {
+            pack_str(pk, "comment");
+            pack_cmt(pk, chinfo->cinfo);
+        }
+    });
 }
 
-Marshalled *rpc_marshal_get_stats_resp(const GetStatsResp *resp)
+define_item_sizer(rpc_sync_changes_item_sz, pack_change, ChangeInfo)
+
+Marshalled *rpc_marshal_sync_changes_resp(const SyncChangesResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    ChangeInfo **chinfo;
+    MarshalledIntl *m;
+    msgpack_packer *pk;
+    size_t hint = 0;
+
+    cvector_foreach(resp->result.chinfos, chinfo) {
+        hint += (*chinfo)->pinfo ? (*chinfo)->pinfo->con_len + (*chinfo)->pinfo->thu_len :
+                                   (*chinfo)->cinfo->con_len + (*chinfo)->cinfo->thu_len;
+        hint += MINTL_ITEM_OVERHEAD;
+    }
+
+    m = mintl_create(hint);
+    pk = &m->pk;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
         pack_kv_u64(pk, "id", resp->tsx_id);
         pack_kv_map(pk, "result", 3, {
-            pack_kv_str(pk, "did", resp->result.did);
-            pack_kv_u64(pk, "connecting_clients", resp->result.conn_cs);
-            pack_kv_u64(pk, "total_clients", resp->result.total_cs);
+            pack_kv_bool(pk, "is_last", resp->result.is_last);
+            pack_kv_u64(pk, "cursor", resp->result.cursor);
+            pack_kv_arr(pk, "changes", cvector_size(resp->result.chinfos), {
+                cvector_foreach(resp->result.chinfos, chinfo) {
+                    pack_change(pk, *chinfo);
+                }
+            });
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
+    return mintl_finish(m);
+}
+
+Marshalled *rpc_marshal_get_timeline_resp(const GetTimelineResp *resp)
+{
+    PostInfo **pinfo;
+    MarshalledIntl *m;
+    msgpack_packer *pk;
+    size_t hint = 0;
 
-    msgpack_packer_free(pk);
+    cvector_foreach(resp->result.pinfos, pinfo)
+        hint += (*pinfo)->con_len + (*pinfo)->thu_len + MINTL_ITEM_OVERHEAD;
 
-    return &m->m;
+    m = mintl_create(hint);
+    pk = &m->pk;
+
+    pack_map(pk, 3, {
+        pack_kv_str(pk, "version", "1.0");
+        pack_kv_u64(pk, "id", resp->tsx_id);
+        pack_kv_map(pk, "result", 2, {
+            pack_kv_bool(pk, "is_last", resp->result.is_last);
+            pack_kv_arr(pk, "posts", cvector_size(resp->result.pinfos), {
+                cvector_foreach(resp->result.pinfos, pinfo) {
+                    pack_cached_post(pk, *pinfo);
+                }
+            });
+        });
+    });
+
+    return mintl_finish(m);
+}
+
+static
+void pack_cmt_thread(msgpack_packer *pk, const CmtThreadInfo *tinfo)
+{
+    size_t i;
+
+    pack_map(pk, 3, {
+        pack_str(pk, "comment");
+        pack_cmt(pk, tinfo->cinfo);
+        pack_kv_u64(pk, "reply_count", tinfo->replies_cnt);
+        pack_kv_arr(pk, "replies", tinfo->nreplies, {
+            for (i = 0; i < tinfo->nreplies; i++)
+                pack_cmt(pk, tinfo->replies[i]);
+        });
+    });
+}
+
+define_item_sizer(rpc_get_cmt_thread_item_sz, pack_cmt_thread, CmtThreadInfo)
+
+Marshalled *rpc_marshal_get_cmt_thread_resp(const GetCmtThreadResp *resp)
+{
+    CmtThreadInfo **tinfo;
+    MarshalledIntl *m;
+    msgpack_packer *pk;
+    size_t hint = 0;
+    size_t i;
+
+    cvector_foreach(resp->result.tinfos, tinfo) {
+        hint += (*tinfo)->cinfo->con_len + (*tinfo)->cinfo->thu_len + MINTL_ITEM_OVERHEAD;
+        for (i = 0; i < (*tinfo)->nreplies; i++)
+            hint += (*tinfo)->replies[i]->con_len + (*tinfo)->replies[i]->thu_len +
+                    MINTL_ITEM_OVERHEAD;
+    }
+
+    m = mintl_create(hint);
+    pk = &m->pk;
+
+    pack_map(pk, 3, {
+        pack_kv_str(pk, "version", "1.0");
+        pack_kv_u64(pk, "id", resp->tsx_id);
+        pack_kv_map(pk, "result", 2, {
+            pack_kv_bool(pk, "is_last", resp->result.is_last);
+            pack_kv_arr(pk, "comments", cvector_size(resp->result.tinfos), {
+                cvector_foreach(resp->result.tinfos, tinfo) {
+                    pack_cmt_thread(pk, *tinfo);
+                }
+            });
+        });
+    });
+
+    return mintl_finish(m);
+}
+
+Marshalled *rpc_marshal_get_stats_resp(const GetStatsResp *resp)
+{
+    return marshal_result(resp->tsx_id, &get_stats_result, resp);
 }
 
 Marshalled *rpc_marshal_sub_chan_resp(const SubChanResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(resp->result.cinfo->len + MINTL_ITEM_OVERHEAD);
+    msgpack_packer *pk = &m->pk;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "2.0");
@@ -4730,107 +2914,49 @@ Marshalled *rpc_marshal_sub_chan_resp(const SubChanResp *resp)
 
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
 Marshalled *rpc_marshal_unsub_chan_resp(const UnsubChanResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_nil(pk, "result");
-    });
-
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return marshal_result(resp->tsx_id, NULL, resp);
 }
 
 Marshalled *rpc_marshal_enbl_notif_resp(const EnblNotifResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_nil(pk, "result");
-    });
-
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return marshal_result(resp->tsx_id, NULL, resp);
 }
 
 Marshalled *rpc_marshal_get_srv_ver_resp(const GetSrvVerResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_map(pk, "result", 2, {
-            pack_kv_str(pk, "version", resp->result.version);
-            pack_kv_i64(pk, "version_code", resp->result.version_code);
-        });
-    });
-
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return marshal_result(resp->tsx_id, &get_srv_ver_result, resp);
 }
 
 Marshalled *rpc_marshal_report_illegal_cmt_resp(const ReportIllegalCmtResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    return marshal_result(resp->tsx_id, NULL, resp);
+}
 
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", resp->tsx_id);
-        pack_kv_nil(pk, "result");
+static
+void pack_reported_cmt(msgpack_packer *pk, const ReportedCmtInfo *rcinfo)
+{
+    pack_map(pk, 7, {
+        pack_kv_u64(pk, "channel_id", rcinfo->chan_id);
+        pack_kv_u64(pk, "post_id", rcinfo->post_id);
+        pack_kv_u64(pk, "comment_id", rcinfo->cmt_id);
+        pack_kv_str(pk, "reporter_name", rcinfo->reporter.name);
+        pack_kv_str(pk, "reporter_did", rcinfo->reporter.did);
+        pack_kv_str(pk, "reasons", rcinfo->reasons);
+        pack_kv_u64(pk, "created_at", rcinfo->created_at);
     });
-
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
 }
 
+define_item_sizer(rpc_get_reported_cmts_item_sz, pack_reported_cmt, ReportedCmtInfo)
+
 Marshalled *rpc_marshal_get_reported_cmts_resp(const GetReportedCmtsResp *resp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(0);
+    msgpack_packer *pk = &m->pk;
     ReportedCmtInfo **rcinfo;
 
     pack_map(pk, 3, {
@@ -4840,61 +2966,26 @@ Marshalled *rpc_marshal_get_reported_cmts_resp(const GetReportedCmtsResp *resp)
             pack_kv_bool(pk, "is_last", resp->result.is_last);
             pack_kv_arr(pk, "comments", cvector_size(resp->result.rcinfos), {
                 cvector_foreach(resp->result.rcinfos, rcinfo) {
-                    pack_map(pk, 11, {
-                        pack_kv_u64(pk, "channel_id", (*rcinfo)->chan_id);
-                        pack_kv_u64(pk, "post_id", (*rcinfo)->post_id);
-                        pack_kv_u64(pk, "comment_id", (*rcinfo)->cmt_id);
-                        pack_kv_str(pk, "reporter_name", (*rcinfo)->reporter.name);
-                        pack_kv_str(pk, "reporter_did", (*rcinfo)->reporter.did);
-                        pack_kv_str(pk, "reasons", (*rcinfo)->reasons);
-                        pack_kv_u64(pk, "created_at", (*rcinfo)->created_at);
-                    });
+                    pack_reported_cmt(pk, *rcinfo);
                 }
             });
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
 Marshalled *rpc_marshal_set_binary_resp(const Resp *resp)
 {
-    SetBinaryResp *wrap_resp = (SetBinaryResp*)resp;
-
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
-
-    pack_map(pk, 3, {
-        pack_kv_str(pk, "version", "1.0");
-        pack_kv_u64(pk, "id", wrap_resp->tsx_id);
-        pack_kv_map(pk, "result", 1, {
-            pack_kv_str(pk, "key", wrap_resp->result.key);
-        });
-    });
-
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return marshal_result(resp->tsx_id, &set_binary_result, resp);
 }
 
 Marshalled *rpc_marshal_get_binary_resp(const Resp *resp)
 {
     GetBinaryResp *wrap_resp = (GetBinaryResp*)resp;
 
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(wrap_resp->result.content_sz + MINTL_ITEM_OVERHEAD);
+    msgpack_packer *pk = &m->pk;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
@@ -4908,13 +2999,7 @@ Marshalled *rpc_marshal_get_binary_resp(const Resp *resp)
     });
     deref(wrap_resp->result.content);
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
 typedef Marshalled *RespHdlr(const Resp *resp);
@@ -4948,9 +3033,8 @@ Marshalled *rpc_marshal_resp(const char* method, const Resp *resp)
 
 Marshalled *rpc_marshal_err(uint64_t tsx_id, int64_t errcode, const char *errdesp)
 {
-    msgpack_sbuffer *buf = msgpack_sbuffer_new();
-    msgpack_packer *pk = msgpack_packer_new(buf, msgpack_sbuffer_write);
-    MarshalledIntl *m = rc_zalloc(sizeof(MarshalledIntl), mintl_dtor);
+    MarshalledIntl *m = mintl_create(0);
+    msgpack_packer *pk = &m->pk;
 
     pack_map(pk, 3, {
         pack_kv_str(pk, "version", "1.0");
@@ -4961,13 +3045,7 @@ Marshalled *rpc_marshal_err(uint64_t tsx_id, int64_t errcode, const char *errdes
         });
     });
 
-    m->m.data = buf->data;
-    m->m.sz   = buf->size;
-    m->buf    = buf;
-
-    msgpack_packer_free(pk);
-
-    return &m->m;
+    return mintl_finish(m);
 }
 
 int get_rpc_version(void)
@@ -32,6 +32,11 @@
 
 typedef char *AccessToken;
 
+typedef struct {
+    void  *data;
+    size_t sz;
+} Marshalled;
+
 #ifdef _MSC_VER
 #pragma warning(disable: 4200)
 #endif
@@ -433,6 +438,8 @@ typedef struct {
     struct {
         bool is_last;
         cvector_vector_type(ChanInfo *) cinfos;
+        cvector_vector_type(Marshalled *) items;  // from rpc_pack_chan(), used instead of cinfos if set
+        QryCursor cursor;  // not packed if by is NONE
     } result;
 } GetChansResp;
 
@@ -442,6 +449,7 @@ typedef struct {
     struct {
         AccessToken tk;
         uint64_t    id;
+        uint64_t    known_tag;
     } params;
 } GetChanDtlReq;
 
@@ -449,6 +457,7 @@ typedef struct {
     uint64_t tsx_id;
     struct {
         ChanInfo *cinfo;
+        bool      not_modified;  // known_tag is current, the details are left out
     } result;
 } GetChanDtlResp;
 
@@ -484,6 +493,7 @@ typedef struct {
     struct {
         bool is_last;
         cvector_vector_type(PostInfo *) pinfos;
+        QryCursor cursor;  // not packed if by is NONE
     } result;
 } GetPostsResp;
 
@@ -518,6 +528,7 @@ typedef struct {
     struct {
         bool is_last;
         cvector_vector_type(PostInfo *) pinfos;
+        QryCursor cursor;  // not packed if by is NONE
     } result;
 } GetLikedPostsResp;
 
@@ -554,6 +565,7 @@ typedef struct {
     struct {
         bool is_last;
         cvector_vector_type(CmtInfo *) cinfos;
+        QryCursor cursor;  // not packed if by is NONE
     } result;
 } GetCmtsResp;
 
@@ -575,6 +587,68 @@ typedef struct {
     } result;
 } GetCmtsLikesResp;
 
+typedef struct {
+    char    *method;
+    uint64_t tsx_id;
+    struct {
+        AccessToken tk;
+        uint64_t    chan_id;
+        uint64_t    cursor;
+        uint64_t    maxcnt;
+    } params;
+} SyncChangesReq;
+
+typedef struct {
+    uint64_t tsx_id;
+    struct {
+        bool is_last;
+        uint64_t cursor;
+        cvector_vector_type(ChangeInfo *) chinfos;
+    } result;
+} SyncChangesResp;
+
+typedef struct {
+    char    *method;
+    uint64_t tsx_id;
+    struct {
+        AccessToken tk;
+        TimelineKey before;
+        uint64_t    maxcnt;
+        uint64_t    fields;
+    } params;
+} GetTimelineReq;
+
+typedef struct {
+    uint64_t tsx_id;
+    struct {
+        bool is_last;
+        cvector_vector_type(PostInfo *) pinfos;
+    } result;
+} GetTimelineResp;
+
+typedef struct {
+    char    *method;
+    uint64_t tsx_id;
+    struct {
+        AccessToken tk;
+        uint64_t    chan_id;
+        uint64_t    post_id;
+        uint64_t    cmt_id;  // whose replies to list, 0 for the top level
+        uint64_t    after;
+        uint64_t    maxcnt;
+        uint64_t    max_replies;
+        uint64_t    fields;
+    } params;
+} GetCmtThreadReq;
+
+typedef struct {
+    uint64_t tsx_id;
+    struct {
+        bool is_last;
+        cvector_vector_type(CmtThreadInfo *) tinfos;
+    } result;
+} GetCmtThreadResp;
+
 typedef struct {
     char    *method;
     uint64_t tsx_id;
@@ -640,6 +714,7 @@ typedef struct {
     uint64_t tsx_id;
     struct {
         AccessToken tk;
+        char       *compression;
     } params;
 } GetSrvVerReq;
 
@@ -648,6 +723,7 @@ typedef struct {
     struct {
         char* version;
         int64_t version_code;
+        char* compression;
     } result;
 } GetSrvVerResp;
 
@@ -836,12 +912,14 @@ typedef struct {
     } result;
 } GetBinaryResp;
 
-typedef struct {
-    void  *data;
-    size_t sz;
-} Marshalled;
+/*
+ * Strings and binaries of the unmarshalled Req are slices of rpc, which is
+ * written to for string terminators: it must have RPC_REQ_PAD_LEN writable
+ * bytes behind len and must outlive the Req.
+ */
+#define RPC_REQ_PAD_LEN 1
 
-int rpc_unmarshal_req(const void *rpc, size_t len, Req **req);
+int rpc_unmarshal_req(void *rpc, size_t len, Req **req);
 Marshalled *rpc_marshal_err(uint64_t tsx_id, int64_t errcode, const char *errdesp);
 
 Marshalled *rpc_marshal_new_post_notif(const NewPostNotif *notif);
@@ -888,6 +966,9 @@ Marshalled *rpc_marshal_get_liked_posts_resp(const GetLikedPostsResp *resp);
 Marshalled *rpc_marshal_get_liked_data_resp(const GetLikedDataResp *resp);
 Marshalled *rpc_marshal_get_cmts_resp(const GetCmtsResp *resp);
 Marshalled *rpc_marshal_get_cmts_likes_resp(const GetCmtsLikesResp *resp);
+Marshalled *rpc_marshal_sync_changes_resp(const SyncChangesResp *resp);
+Marshalled *rpc_marshal_get_timeline_resp(const GetTimelineResp *resp);
+Marshalled *rpc_marshal_get_cmt_thread_resp(const GetCmtThreadResp *resp);
 Marshalled *rpc_marshal_get_stats_resp(const GetStatsResp *resp);
 Marshalled *rpc_marshal_sub_chan_resp(const SubChanResp *resp);
 Marshalled *rpc_marshal_unsub_chan_resp(const UnsubChanResp *resp);
@@ -896,4 +977,39 @@ Marshalled *rpc_marshal_get_srv_ver_resp(const GetSrvVerResp *resp);
 Marshalled *rpc_marshal_report_illegal_cmt_resp(const ReportIllegalCmtResp *resp);
 Marshalled *rpc_marshal_get_reported_cmts_resp(const GetReportedCmtsResp *resp);
 int get_rpc_version(void);
+
+/*
+ * Response chunker for methods answering with a list split over several
+ * responses. Items are sized exactly as they will be packed, so each
+ * response is filled up to limit bytes, envelope included.
+ */
+#define RPC_RESP_ENVELOPE_LEN 128
+
+typedef size_t (*RespItemSizer)(const void *item);
+
+typedef struct {
+    RespItemSizer item_sz;
+    size_t limit;
+    size_t used;
+} RespChunker;
+
+void rpc_chunker_init(RespChunker *ck, RespItemSizer item_sz, size_t limit);
+// false if item does not fit the current response, it then starts the next one.
+bool rpc_chunker_fits(RespChunker *ck, const void *item);
+
+size_t rpc_get_my_chans_item_sz(const void *item);
+size_t rpc_get_chans_item_sz(const void *item);
+size_t rpc_get_sub_chans_item_sz(const void *item);
+size_t rpc_get_posts_item_sz(const void *item);
+size_t rpc_get_liked_posts_item_sz(const void *item);
+size_t rpc_get_liked_data_item_sz(const void *item);
+size_t rpc_get_cmts_item_sz(const void *item);
+size_t rpc_sync_changes_item_sz(const void *item);
+size_t rpc_get_cmt_thread_item_sz(const void *item);
+// size of an item packed in advance, a Marshalled.
+size_t rpc_packed_item_sz(const void *item);
+
+// packs a channel as an item of get_channels, to be kept and reused.
+Marshalled *rpc_pack_chan(const ChanInfo *cinfo);
+size_t rpc_get_reported_cmts_item_sz(const void *item);
 #endif //__RPC_H__
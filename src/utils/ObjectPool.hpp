@@ -0,0 +1,139 @@
+#ifndef _FEEDS_OBJECT_POOL_HPP_
+#define _FEEDS_OBJECT_POOL_HPP_
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace trinity {
+
+/*
+ * Freelist of T shared by all threads, with a small cache per thread in
+ * front of it so that most acquire and release calls take no lock.
+ * The shared freelist keeps at most GlobalMax objects, the ones released
+ * beyond it go back to the heap.
+ */
+template <typename T, size_t CacheMax = 64>
+class ObjectPool {
+public:
+    /*** type define ***/
+    struct Stats {
+        size_t live;   // acquired and not released yet
+        size_t pooled; // released and kept for reuse
+    };
+
+    /*** static function and variable ***/
+    template <typename... Args>
+    static T* Acquire(Args&&... args) {
+        auto& cache = GetCache().objs;
+        void* mem = nullptr;
+        if(cache.empty() == true) {
+            GetGlobal().take(cache, CacheMax / 2);
+        }
+        if(cache.empty() == false) {
+            mem = cache.back();
+            cache.pop_back();
+            Pooled--;
+        } else {
+            mem = ::operator new(sizeof(T), std::nothrow);
+            if(mem == nullptr) {
+                return nullptr;
+            }
+        }
+        Live++;
+
+        return new(mem) T(std::forward<Args>(args)...);
+    }
+
+    static void Release(T* obj) {
+        if(obj == nullptr) {
+            return;
+        }
+        obj->~T();
+        Live--;
+        Pooled++;
+
+        auto& cache = GetCache().objs;
+        cache.push_back(obj);
+        if(cache.size() >= CacheMax) {
+            Pooled -= GetGlobal().give(cache, CacheMax / 2);
+        }
+    }
+
+    static Stats GetStats() {
+        return {Live.load(), Pooled.load()};
+    }
+
+private:
+    /*** type define ***/
+    struct Global {
+        std::mutex mutex;
+        std::vector<void*> objs;
+
+        void take(std::vector<void*>& to, size_t cnt) {
+            std::lock_guard<std::mutex> lock(mutex);
+            while(cnt-- > 0 && objs.empty() == false) {
+                to.push_back(objs.back());
+                objs.pop_back();
+            }
+        }
+        // return the count of objects freed for the freelist being full.
+        size_t give(std::vector<void*>& from, size_t cnt) {
+            size_t freed = 0;
+            std::lock_guard<std::mutex> lock(mutex);
+            while(cnt-- > 0 && from.empty() == false) {
+                if(objs.size() < GlobalMax) {
+                    objs.push_back(from.back());
+                } else {
+                    ::operator delete(from.back());
+                    freed++;
+                }
+                from.pop_back();
+            }
+            return freed;
+        }
+        ~Global() {
+            for(auto mem: objs) {
+                ::operator delete(mem);
+            }
+        }
+    };
+
+    struct Cache {
+        std::vector<void*> objs;
+
+        // thread local objects are destroyed before the static ones.
+        ~Cache() {
+            Pooled -= GetGlobal().give(objs, objs.size());
+        }
+    };
+
+    /*** static function and variable ***/
+    static constexpr size_t GlobalMax = CacheMax * 4;
+
+    static Global& GetGlobal() {
+        static Global global;
+        return global;
+    }
+    static Cache& GetCache() {
+        static thread_local Cache cache;
+        return cache;
+    }
+
+    static inline std::atomic<size_t> Live {0};
+    static inline std::atomic<size_t> Pooled {0};
+};
+
+/***********************************************/
+/***** class template function implement *******/
+/***********************************************/
+
+/***********************************************/
+/***** macro definition ************************/
+/***********************************************/
+
+} // namespace trinity
+
+#endif /* _FEEDS_OBJECT_POOL_HPP_ */